@@ -0,0 +1,221 @@
+#ifndef ALIGNED_H
+#define ALIGNED_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Build with PIC_HUGE_PAGES set to 1 to ask for transparent huge pages for
+// the large aligned allocations, which cuts the TLB misses of streaming over
+// the particles and the grids
+#ifndef PIC_HUGE_PAGES
+#define PIC_HUGE_PAGES 0
+#endif
+
+// Size of a cache line in bytes
+const std::size_t cache_line = 64;
+
+// Size of a transparent huge page in bytes
+const std::size_t huge_page = std::size_t(2) << 20;
+
+/**
+ * @brief Allocator for standard containers whose storage starts on an
+ *        Alignment byte boundary, so that copies of a container keep the
+ *        same alignment as the original. With PIC_HUGE_PAGES, allocations of
+ *        at least a huge page are aligned to one and backed by huge pages.
+ *
+ *        Elements constructed without a value are left uninitialized, so that
+ *        resizing does not write to the new storage. Its pages are then
+ *        placed on the NUMA node of the thread that first writes them (see
+ *        first_touch).
+ *
+ * @tparam T Type of the elements
+ * @tparam Alignment Alignment of the storage in bytes, a power of 2 and a
+ *                   multiple of sizeof(std::size_t)
+ */
+template <typename T, std::size_t Alignment>
+struct Aligned_Allocator
+{
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef Aligned_Allocator<U, Alignment> other;
+    };
+
+    Aligned_Allocator() noexcept
+    {
+    }
+
+    template <typename U>
+    Aligned_Allocator(const Aligned_Allocator<U, Alignment>&) noexcept
+    {
+    }
+
+    T* allocate(const std::size_t n)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+
+        const std::size_t bytes = n * sizeof(T);
+#if PIC_HUGE_PAGES
+        if (bytes >= huge_page)
+        {
+            return static_cast<T*>(allocate_huge(bytes));
+        }
+#endif
+
+        // Over-allocate through the global operator new, so that the storage
+        // is counted by anything replacing it, and keep the offset to the
+        // start of the block just before the aligned storage
+        char* block = static_cast<char*>(::operator new(bytes + Alignment));
+        const std::size_t offset =
+            Alignment - reinterpret_cast<std::uintptr_t>(block) % Alignment;
+        char* p = block + offset;
+        reinterpret_cast<std::size_t*>(p)[-1] = offset;
+
+        return reinterpret_cast<T*>(p);
+    }
+
+    void deallocate(T* p, const std::size_t n)
+    {
+        if (p == nullptr)
+        {
+            return;
+        }
+
+#if PIC_HUGE_PAGES
+        if (n * sizeof(T) >= huge_page)
+        {
+            free(p);
+            return;
+        }
+#else
+        (void)n;
+#endif
+
+        char* c = reinterpret_cast<char*>(p);
+        ::operator delete(c - reinterpret_cast<std::size_t*>(c)[-1]);
+    }
+
+#if PIC_HUGE_PAGES
+    /**
+     * @brief Allocates whole huge pages, aligned to one, and asks for them to
+     *        be backed by transparent huge pages
+     *
+     * @param bytes Number of bytes to allocate
+     * @return void* The storage
+     */
+    static void* allocate_huge(std::size_t bytes)
+    {
+        bytes = (bytes + huge_page - 1) / huge_page * huge_page;
+
+        void* p = nullptr;
+        if (posix_memalign(&p, std::max(Alignment, huge_page), bytes) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+#ifdef MADV_HUGEPAGE
+        // Only advice, so the storage is still fine if it is not taken
+        madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+
+        return p;
+    }
+#endif
+
+    template <typename U>
+    void construct(U* p)
+    {
+        ::new(static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator==(const Aligned_Allocator<T, Alignment>&,
+                       const Aligned_Allocator<U, Alignment>&)
+{
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator!=(const Aligned_Allocator<T, Alignment>&,
+                       const Aligned_Allocator<U, Alignment>&)
+{
+    return false;
+}
+
+// Vector whose storage starts on a cache line
+template <typename T>
+using cache_aligned_vector = std::vector<T, Aligned_Allocator<T, cache_line> >;
+
+/**
+ * @brief Number of elements to store a row of a grid in, so that every row
+ *        starts on a cache line and is an odd number of cache lines long.
+ *        The rows of a column then fall in different cache sets, even when
+ *        the rows are a power of 2 long.
+ *
+ * @param n Number of elements in a row
+ * @param elem_size Size of an element in bytes, a divisor of cache_line
+ * @return std::size_t Number of elements from the start of a row to the next
+ */
+inline constexpr std::size_t padded_row(const std::size_t n,
+                                        const std::size_t elem_size)
+{
+    // Whole cache lines, and one more if that makes an even number of them
+    return (((n * elem_size + cache_line - 1) / cache_line) | 1) *
+           (cache_line / elem_size);
+}
+
+/**
+ * @brief Moves the elements of v to new storage that is first written by
+ *        nt threads, each taking the blocks of chunk elements a static
+ *        OpenMP schedule gives it. On a NUMA machine the pages of v are then
+ *        local to the threads that work on them in loops with the same
+ *        schedule. The capacity of v is kept.
+ *
+ * @param v Vector to place, with an allocator that does not initialize on
+ *          resizing
+ * @param chunk Number of elements in a block
+ * @param nt Number of threads
+ */
+template <typename T, typename A>
+void first_touch(std::vector<T, A>& v, const std::size_t chunk, const int nt)
+{
+    const std::size_t n = v.size();
+    const std::size_t n_chunks = (n + chunk - 1) / chunk;
+
+    std::vector<T, A> placed;
+    placed.reserve(v.capacity());
+    placed.resize(n);
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t c = 0; c < n_chunks; ++c)
+    {
+        const std::size_t end = std::min(n, (c + 1) * chunk);
+        std::copy(v.begin() + c * chunk, v.begin() + end,
+                  placed.begin() + c * chunk);
+    }
+
+    v.swap(placed);
+}
+
+#endif
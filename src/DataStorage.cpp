@@ -10,9 +10,9 @@ CLASS METHODS
  *        exception of type std::out_of_range is thrown.
  *
  * @param idx Position of the element to return.
- * @return double& Reference to the requested element.
+ * @return real_t& Reference to the requested element.
  */
-double& DataStorage::at(const size_t idx)
+real_t& DataStorage::at(const size_t idx)
 {
     return this->data.at(idx);
 }
@@ -23,9 +23,9 @@ double& DataStorage::at(const size_t idx)
  *        exception of type std::out_of_range is thrown.
  *
  * @param idx Position of the element to return.
- * @return double& Reference to the requested element.
+ * @return real_t& Reference to the requested element.
  */
-const double& DataStorage::at(const std::size_t idx) const
+const real_t& DataStorage::at(const std::size_t idx) const
 {
     return this->data.at(idx);
 }
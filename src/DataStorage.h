@@ -2,8 +2,19 @@
 #define DATA_STORAGE_H
 
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "Aligned.h"
+#include "Precision.h"
+
+// Build with PIC_DEBUG set to 1 to bounds check the grid accessors that are
+// otherwise unchecked
+#ifndef PIC_DEBUG
+#define PIC_DEBUG 0
+#endif
+
 /**
  * @brief DataStorage is the abstract interface for DataStorage objects used to
  *        store n-dimensional sets of data. A lot of the common functionalities
@@ -23,17 +34,20 @@ class DataStorage
         };
 
         std::size_t size;
-        std::vector<double> data;
+        cache_aligned_vector<real_t> data;
 
         const char same_size_err[45] = "Error: Data objects are not of the same size";
         const char no_dimension_err[45] = "Error: Data object dimension does not exist";
+        const char index_err[41] = "Error: Data object index is out of range";
 
     public:
+        typedef real_t value_type;
+
         /**********************************************************
         ITERATOR FUNCTIONS
         ***********************************************************/
-        using iterator = std::vector<double>::iterator;
-        using const_iterator = std::vector<double>::const_iterator;
+        using iterator = cache_aligned_vector<real_t>::iterator;
+        using const_iterator = cache_aligned_vector<real_t>::const_iterator;
 
         inline iterator begin() noexcept
         {
@@ -60,26 +74,34 @@ class DataStorage
         // Indexing operator
         /**
          * @brief Returns a reference to the element at specified location idx.
-         *        No bounds checking is performed.
+         *        Bounds are only checked in a debug build.
          *
          * @param idx Position of the element to return
-         * @return double& Reference to the requested element
+         * @return real_t& Reference to the requested element
          */
-        inline double& operator[](const std::size_t idx)
+        inline real_t& operator[](const std::size_t idx)
         {
+#if PIC_DEBUG
+            return this->data.at(idx);
+#else
             return this->data[idx];
+#endif
         }
 
         /**
          * @brief Returns a reference to the element at specified location idx.
-         *        No bounds checking is performed.
+         *        Bounds are only checked in a debug build.
          *
          * @param idx Position of the element to return
-         * @return const double& Reference to the requested element
+         * @return const real_t& Reference to the requested element
          */
-        inline const double& operator[](const std::size_t idx) const
+        inline const real_t& operator[](const std::size_t idx) const
         {
+#if PIC_DEBUG
+            return this->data.at(idx);
+#else
             return this->data[idx];
+#endif
         }
 
         // Printing Operator
@@ -93,8 +115,8 @@ class DataStorage
         /**********************************************************
         CLASS METHODS
         ***********************************************************/
-        double& at(const std::size_t idx);
-        const double& at(const std::size_t idx) const;
+        real_t& at(const std::size_t idx);
+        const real_t& at(const std::size_t idx) const;
 
         virtual void print() const = 0;
         virtual std::ostream& print(std::ostream& s) const = 0;
@@ -122,9 +144,19 @@ class DataStorage
         /**
          * @brief Get a pointer to the data stored in the object
          *
-         * @return const double* A pointer to the data
+         * @return const real_t* A pointer to the data
+         */
+        inline const real_t* get_data() const
+        {
+            return this->data.data();
+        }
+
+        /**
+         * @brief Get a pointer to the data stored in the object
+         *
+         * @return real_t* A pointer to the data
          */
-        inline const double* get_data() const
+        inline real_t* get_data()
         {
             return this->data.data();
         }
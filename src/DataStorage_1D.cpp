@@ -10,6 +10,8 @@ CONSTRUCTORS/DESTRUCTORS
  */
 DataStorage_1D::DataStorage_1D()
 {
+    this->Nx = 0;
+    this->size = 0;
 }
 
 /**
@@ -32,7 +34,7 @@ DataStorage_1D::DataStorage_1D(std::size_t Nx, double val)
     this->Nx = Nx;
     this->size = Nx;
 
-    this->data = std::vector<double>(this->size, val);
+    this->data.assign(this->size, val);
 }
 
 // /**
@@ -70,7 +72,7 @@ DataStorage_1D::DataStorage_1D(std::size_t Nx, std::vector<double> data) // a 'c
     this->Nx = Nx;
     this->size = Nx;
 
-    this->data = std::vector<double>(data);
+    this->data.assign(data.begin(), data.end());
 }
 
 /**
@@ -86,6 +88,22 @@ DataStorage_1D::DataStorage_1D(const DataStorage_1D& copy_obj)
     this->data = copy_obj.data;
 }
 
+/**
+ * @brief Constructor for DataStorage_1D object - takes over the data of another
+ *        DataStorage_1D without copying it, leaving the other one empty
+ *
+ * @param move_obj DataStorage_1D to move from
+ */
+DataStorage_1D::DataStorage_1D(DataStorage_1D&& move_obj) noexcept
+{
+    this->Nx = move_obj.Nx;
+    this->size = move_obj.size;
+    this->data = std::move(move_obj.data);
+
+    move_obj.Nx = 0;
+    move_obj.size = 0;
+}
+
 /**
  * @brief Destructor for DataStorage_1D object
  *
@@ -113,6 +131,23 @@ DataStorage_1D& DataStorage_1D::operator=(const DataStorage_1D &to_copy)
     data = to_copy.data;
     return *this;
 }
+
+/**
+ * @brief Overload move assignment operator
+ *
+ * @param to_move Object to take the values from, left empty
+ * @return DataStorage_1D& This object holding the moved values
+ */
+DataStorage_1D& DataStorage_1D::operator=(DataStorage_1D&& to_move) noexcept
+{
+    Nx = to_move.Nx;
+    size = to_move.size;
+    data = std::move(to_move.data);
+
+    to_move.Nx = 0;
+    to_move.size = 0;
+    return *this;
+}
 //-----------------------------------------
 
 
@@ -6,8 +6,9 @@
 #include <math.h>
 
 #include "DataStorage.h"
+#include "Expression.h"
 
-class DataStorage_1D : public DataStorage
+class DataStorage_1D : public DataStorage, public Expr::Expression<DataStorage_1D>
 {
     private:
         const std::size_t ndims = 1;
@@ -19,11 +20,33 @@ class DataStorage_1D : public DataStorage
         ***********************************************************/
         bool same_size(const DataStorage_1D& other_storage) const;
 
+        /**
+         * @brief Element-wise operation and assignment with an expression,
+         *        evaluated in one pass
+         *
+         * @tparam Op The element-wise operation
+         * @param expr Expression right of the operator
+         * @return DataStorage_1D& This object after operation
+         */
+        template <typename Op, typename E>
+        inline DataStorage_1D& compound_assign(const Expr::Expression<E>& expr)
+        {
+            static_assert(std::is_same<typename E::result_type, DataStorage_1D>::value,
+                          "Expression does not evaluate to a DataStorage_1D");
+
+            Expr::check_shape(*this, expr.self());
+            Expr::evaluate<Op>(this->data.data(), expr.self());
+
+            return *this;
+        }
+
         // void init_data_storage(std::function<void(DataStorage_1D&,
         //                                           std::size_t)> init_fcn);
         //-----------------------------------------
 
     public:
+        typedef DataStorage_1D result_type;
+
         /**********************************************************
         CONSTRUCTORS/DESTRUCTORS
         ***********************************************************/
@@ -36,152 +59,92 @@ class DataStorage_1D : public DataStorage
         DataStorage_1D(std::size_t Nx,
                        std::vector<double> data);       // a 'copy' constructor
         DataStorage_1D(const DataStorage_1D& copy_obj); // a copy constructor
+        DataStorage_1D(DataStorage_1D&& move_obj) noexcept; // a move constructor
         ~DataStorage_1D();
-        //-----------------------------------------
-
-
-        /**********************************************************
-        OPERATOR FUNCTIONS
-        ***********************************************************/
-        DataStorage_1D& operator=(const DataStorage_1D& to_copy);
-
-        // Indexing operator
-        /**
-         * @brief Returns a reference to the element at specified location x1.
-         *        No bounds checking is performed.
-         *
-         * @param x1 Position of the element to return
-         * @return double& Reference to the requested element
-         */
-        inline double& operator()(const std::size_t x1)
-        {
-            return this->data[x1];
-        }
 
         /**
-         * @brief Returns a reference to the element at specified location x1.
-         *        No bounds checking is performed.
+         * @brief Constructor for DataStorage_1D object - evaluates an
+         *        expression of DataStorage_1D objects in one pass
          *
-         * @param x1 Position of the element to return
-         * @return double& Reference to the requested element
+         * @param expr Expression to evaluate
          */
-        inline const double& operator()(const std::size_t x1) const
+        template <typename E>
+        DataStorage_1D(const Expr::Expression<E>& expr)
         {
-            return this->data[x1];
-        }
+            static_assert(std::is_same<typename E::result_type, DataStorage_1D>::value,
+                          "Expression does not evaluate to a DataStorage_1D");
 
+            const E& e = expr.self();
+            this->Nx = e.get_Ni_size(x1_accessor);
+            this->size = this->Nx;
+            this->data.resize(this->size);
 
-        // Addition with other DataStorage and with type double
-        /**
-         * @brief Element-wise add two DataStorage objects
-         *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_1D Resultant DataStorage
-         */
-        friend DataStorage_1D operator+(DataStorage_1D d1, const DataStorage_1D& d2)
-        {
-            d1 += d2;
-            return d1;
+            Expr::evaluate<Expr::Assign>(this->data.data(), e);
         }
+        //-----------------------------------------
 
-        /**
-         * @brief Element-wise addition with DataStorage and a scalar
-         *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_1D Resultant DataStorage
-         */
-        friend DataStorage_1D operator+(DataStorage_1D d, const double val)
-        {
-            d += val;
-            return d;
-        }
 
+        /**********************************************************
+        OPERATOR FUNCTIONS
+        ***********************************************************/
+        DataStorage_1D& operator=(const DataStorage_1D& to_copy);
+        DataStorage_1D& operator=(DataStorage_1D&& to_move) noexcept;
 
-        // Subtraction with other DataStorage and with type double
         /**
-         * @brief Element-wise subtraction two DataStorage objects
+         * @brief Evaluates an expression into this object in one pass,
+         *        reusing the storage when the shape is unchanged
          *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_1D Resultant DataStorage
+         * @param expr Expression to evaluate
+         * @return DataStorage_1D& This object holding the result
          */
-        friend DataStorage_1D operator-(DataStorage_1D d1, const DataStorage_1D& d2)
+        template <typename E>
+        inline DataStorage_1D& operator=(const Expr::Expression<E>& expr)
         {
-            d1 -= d2;
-            return d1;
-        }
+            static_assert(std::is_same<typename E::result_type, DataStorage_1D>::value,
+                          "Expression does not evaluate to a DataStorage_1D");
 
-        /**
-         * @brief Element-wise subtraction with DataStorage and a scalar
-         *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_1D Resultant DataStorage
-         */
-        friend DataStorage_1D operator-(DataStorage_1D d, const double val)
-        {
-            d -= val;
-            return d;
-        }
+            const E& e = expr.self();
+            if (this->Nx != e.get_Ni_size(x1_accessor))
+            {
+                this->Nx = e.get_Ni_size(x1_accessor);
+                this->size = this->Nx;
+                this->data.resize(this->size);
+            }
 
+            Expr::evaluate<Expr::Assign>(this->data.data(), e);
 
-        // Multiplication with other DataStorage and with type double
-        /**
-         * @brief Element-wise multiplication two DataStorage objects
-         *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_1D Resultant DataStorage
-         */
-        friend DataStorage_1D operator*(DataStorage_1D d1, const DataStorage_1D& d2)
-        {
-            d1 *= d2;
-            return d1;
+            return *this;
         }
 
+        // Indexing operator
         /**
-         * @brief Element-wise multiplication with DataStorage and a scalar
+         * @brief Returns a reference to the element at specified location x1.
+         *        No bounds checking is performed.
          *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_1D Resultant DataStorage
+         * @param x1 Position of the element to return
+         * @return real_t& Reference to the requested element
          */
-        friend DataStorage_1D operator*(DataStorage_1D d, const double val)
+        inline real_t& operator()(const std::size_t x1)
         {
-            d *= val;
-            return d;
+            return this->data[x1];
         }
 
-
-        // Division with other DataStorage and with type double
         /**
-         * @brief Element-wise division two DataStorage objects
+         * @brief Returns a reference to the element at specified location x1.
+         *        No bounds checking is performed.
          *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_1D Resultant DataStorage
+         * @param x1 Position of the element to return
+         * @return const real_t& Reference to the requested element
          */
-        friend DataStorage_1D operator/(DataStorage_1D d1, const DataStorage_1D& d2)
+        inline const real_t& operator()(const std::size_t x1) const
         {
-            d1 /= d2;
-            return d1;
+            return this->data[x1];
         }
 
-        /**
-         * @brief Element-wise division with DataStorage and a scalar
-         *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_1D Resultant DataStorage
-         */
-        friend DataStorage_1D operator/(DataStorage_1D d, const double val)
-        {
-            d /= val;
-            return d;
-        }
 
+        // Element-wise +, -, * and / between objects, and with a scalar on
+        // the right, build expressions (see Expression.h) that are evaluated
+        // when assigned
 
         // Addition/Assignment with other DataStorage and double
         /**
@@ -222,6 +185,19 @@ class DataStorage_1D : public DataStorage
             return *this;
         }
 
+        /**
+         * @brief Element-wise addition and assignment for an expression of
+         *        DataStorage_1D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_1D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_1D& operator+=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Add>(expr);
+        }
+
 
         // Subtraction/Assignment with other DataStorage and double
         /**
@@ -263,6 +239,19 @@ class DataStorage_1D : public DataStorage
             return *this;
         }
 
+        /**
+         * @brief Element-wise subtraction and assignment for an expression of
+         *        DataStorage_1D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_1D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_1D& operator-=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Subtract>(expr);
+        }
+
 
         // Multiplication/Assignment with other DataStorage and double
         /**
@@ -304,6 +293,19 @@ class DataStorage_1D : public DataStorage
             return *this;
         }
 
+        /**
+         * @brief Element-wise multiplication and assignment for an expression of
+         *        DataStorage_1D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_1D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_1D& operator*=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Multiply>(expr);
+        }
+
 
         // Division/Assignment with other DataStorage and double
         /**
@@ -343,6 +345,19 @@ class DataStorage_1D : public DataStorage
 
             return *this;
         }
+
+        /**
+         * @brief Element-wise division and assignment for an expression of
+         *        DataStorage_1D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_1D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_1D& operator/=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Divide>(expr);
+        }
         //-----------------------------------------
 
 
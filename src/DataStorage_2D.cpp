@@ -10,6 +10,9 @@ CONSTRUCTORS/DESTRUCTORS
  */
 DataStorage_2D::DataStorage_2D()
 {
+    this->Nx = 0;
+    this->Ny = 0;
+    this->size = 0;
 }
 
 /**
@@ -36,7 +39,7 @@ DataStorage_2D::DataStorage_2D(std::size_t Nx, std::size_t Ny, double val)
     this->Ny = Ny;
     this->size = Nx * Ny;
 
-    this->data = std::vector<double>(this->size, val);
+    this->data.assign(this->size, val);
 }
 
 // /**
@@ -79,7 +82,7 @@ DataStorage_2D::DataStorage_2D(std::size_t Nx, std::size_t Ny, std::vector<doubl
     this->Ny = Ny;
     this->size = Nx * Ny;
 
-    this->data = std::vector<double>(data); // TODO: copying this twice?
+    this->data.assign(data.begin(), data.end());
 }
 
 /**
@@ -96,6 +99,24 @@ DataStorage_2D::DataStorage_2D(const DataStorage_2D& copy_obj)
     this->data = copy_obj.data;
 }
 
+/**
+ * @brief Constructor for DataStorage_2D object - takes over the data of another
+ *        DataStorage_2D without copying it, leaving the other one empty
+ *
+ * @param move_obj DataStorage_2D to move from
+ */
+DataStorage_2D::DataStorage_2D(DataStorage_2D&& move_obj) noexcept
+{
+    this->Nx = move_obj.Nx;
+    this->Ny = move_obj.Ny;
+    this->size = move_obj.size;
+    this->data = std::move(move_obj.data);
+
+    move_obj.Nx = 0;
+    move_obj.Ny = 0;
+    move_obj.size = 0;
+}
+
 /**
  * @brief Destructor for DataStorage_2D object
  *
@@ -124,6 +145,25 @@ DataStorage_2D& DataStorage_2D::operator=(const DataStorage_2D& to_copy)
     data = to_copy.data;
     return *this;
 }
+
+/**
+ * @brief Overload move assignment operator
+ *
+ * @param to_move Object to take the values from, left empty
+ * @return DataStorage_2D& This object holding the moved values
+ */
+DataStorage_2D& DataStorage_2D::operator=(DataStorage_2D&& to_move) noexcept
+{
+    Nx = to_move.Nx;
+    Ny = to_move.Ny;
+    size = to_move.size;
+    data = std::move(to_move.data);
+
+    to_move.Nx = 0;
+    to_move.Ny = 0;
+    to_move.size = 0;
+    return *this;
+}
 //-----------------------------------------
 
 
@@ -138,9 +178,9 @@ CLASS METHODS
  *
  * @param x1 Index to first dimension to access
  * @param x2 Index to second dimension to access
- * @return double& Reference to the requested element.
+ * @return real_t& Reference to the requested element.
  */
-double& DataStorage_2D::at(const std::size_t x1, const std::size_t x2)
+real_t& DataStorage_2D::at(const std::size_t x1, const std::size_t x2)
 {
     return this->DataStorage::at(x1 * this->Ny + x2);
 }
@@ -152,9 +192,9 @@ double& DataStorage_2D::at(const std::size_t x1, const std::size_t x2)
  *
  * @param x1 Index to first dimension to access
  * @param x2 Index to second dimension to access
- * @return double& Reference to the requested element.
+ * @return real_t& Reference to the requested element.
  */
-const double& DataStorage_2D::at(const std::size_t x1, const std::size_t x2) const
+const real_t& DataStorage_2D::at(const std::size_t x1, const std::size_t x2) const
 {
     return this->DataStorage::at(x1 * this->Ny + x2);
 }
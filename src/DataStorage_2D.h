@@ -6,8 +6,9 @@
 #include <math.h>
 
 #include "DataStorage.h"
+#include "Expression.h"
 
-class DataStorage_2D : public DataStorage
+class DataStorage_2D : public DataStorage, public Expr::Expression<DataStorage_2D>
 {
     private:
         const std::size_t ndims = 2;
@@ -20,11 +21,33 @@ class DataStorage_2D : public DataStorage
         ***********************************************************/
         bool same_size(const DataStorage_2D& other_storage) const;
 
+        /**
+         * @brief Element-wise operation and assignment with an expression,
+         *        evaluated in one pass
+         *
+         * @tparam Op The element-wise operation
+         * @param expr Expression right of the operator
+         * @return DataStorage_2D& This object after operation
+         */
+        template <typename Op, typename E>
+        inline DataStorage_2D& compound_assign(const Expr::Expression<E>& expr)
+        {
+            static_assert(std::is_same<typename E::result_type, DataStorage_2D>::value,
+                          "Expression does not evaluate to a DataStorage_2D");
+
+            Expr::check_shape(*this, expr.self());
+            Expr::evaluate<Op>(this->data.data(), expr.self());
+
+            return *this;
+        }
+
         // void init_data_storage(std::function<void(DataStorage_2D&,
         //                                           std::size_t, std::size_t)> init_fcn);
         //-----------------------------------------
 
     public:
+        typedef DataStorage_2D result_type;
+
         /**********************************************************
         CONSTRUCTORS/DESTRUCTORS
         ***********************************************************/
@@ -37,154 +60,109 @@ class DataStorage_2D : public DataStorage
         DataStorage_2D(std::size_t Nx, std::size_t Ny,
                        std::vector<double> data);       // a 'copy' constructor
         DataStorage_2D(const DataStorage_2D& copy_obj); // a copy constructor
+        DataStorage_2D(DataStorage_2D&& move_obj) noexcept; // a move constructor
         ~DataStorage_2D();
-        //-----------------------------------------
 
-
-        /**********************************************************
-        OPERATOR FUNCTIONS
-        ***********************************************************/
-        DataStorage_2D &operator=(const DataStorage_2D &to_copy);
-
-        // Indexing operator
         /**
-         * @brief Returns a reference to the element at specified location
-         *        (x1, x2). No bounds checking is performed.
+         * @brief Constructor for DataStorage_2D object - evaluates an
+         *        expression of DataStorage_2D objects in one pass
          *
-         * @param x1 Position of the element in first dimension to return
-         * @param x2 Position of the element in second dimension to return
-         * @return double& Reference to the requested element
+         * @param expr Expression to evaluate
          */
-        inline double &operator()(const std::size_t x1, const std::size_t x2)
+        template <typename E>
+        DataStorage_2D(const Expr::Expression<E>& expr)
         {
-            return this->data[x1 * this->Ny + x2];
-        }
+            static_assert(std::is_same<typename E::result_type, DataStorage_2D>::value,
+                          "Expression does not evaluate to a DataStorage_2D");
 
-        /**
-         * @brief Returns a reference to the element at specified location
-         *        (x1, x2). No bounds checking is performed.
-         *
-         * @param x1 Position of the element in first dimension to return
-         * @param x2 Position of the element in second dimension to return
-         * @return double& Reference to the requested element
-         */
-        inline const double& operator()(const std::size_t x1, const std::size_t x2) const
-        {
-            return this->data[x1 * this->Ny + x2];
-        }
+            const E& e = expr.self();
+            this->Nx = e.get_Ni_size(x1_accessor);
+            this->Ny = e.get_Ni_size(x2_accessor);
+            this->size = this->Nx * this->Ny;
+            this->data.resize(this->size);
 
-
-        // Addition with other DataStorage and with type double
-        /**
-         * @brief Element-wise add two DataStorage objects
-         *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_2D Resultant DataStorage
-         */
-        friend DataStorage_2D operator+(DataStorage_2D d1, const DataStorage_2D& d2)
-        {
-            d1 += d2;
-            return d1;
+            Expr::evaluate<Expr::Assign>(this->data.data(), e);
         }
+        //-----------------------------------------
 
-        /**
-         * @brief Element-wise addition with DataStorage and a scalar
-         *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_2D Resultant DataStorage
-         */
-        friend DataStorage_2D operator+(DataStorage_2D d, const double val)
-        {
-            d += val;
-            return d;
-        }
 
+        /**********************************************************
+        OPERATOR FUNCTIONS
+        ***********************************************************/
+        DataStorage_2D &operator=(const DataStorage_2D &to_copy);
+        DataStorage_2D& operator=(DataStorage_2D&& to_move) noexcept;
 
-        // Subtraction with other DataStorage and with type double
         /**
-         * @brief Element-wise subtraction two DataStorage objects
+         * @brief Evaluates an expression into this object in one pass,
+         *        reusing the storage when the shape is unchanged
          *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_2D Resultant DataStorage
+         * @param expr Expression to evaluate
+         * @return DataStorage_2D& This object holding the result
          */
-        friend DataStorage_2D operator-(DataStorage_2D d1, const DataStorage_2D& d2)
+        template <typename E>
+        inline DataStorage_2D& operator=(const Expr::Expression<E>& expr)
         {
-            d1 -= d2;
-            return d1;
-        }
+            static_assert(std::is_same<typename E::result_type, DataStorage_2D>::value,
+                          "Expression does not evaluate to a DataStorage_2D");
 
-        /**
-         * @brief Element-wise subtraction with DataStorage and a scalar
-         *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_2D Resultant DataStorage
-         */
-        friend DataStorage_2D operator-(DataStorage_2D d, const double val)
-        {
-            d -= val;
-            return d;
-        }
+            const E& e = expr.self();
+            if (this->Nx != e.get_Ni_size(x1_accessor) ||
+                this->Ny != e.get_Ni_size(x2_accessor))
+            {
+                this->Nx = e.get_Ni_size(x1_accessor);
+                this->Ny = e.get_Ni_size(x2_accessor);
+                this->size = this->Nx * this->Ny;
+                this->data.resize(this->size);
+            }
 
+            Expr::evaluate<Expr::Assign>(this->data.data(), e);
 
-        // Multiplication with other DataStorage and with type double
-        /**
-         * @brief Element-wise multiplication two DataStorage objects
-         *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_2D Resultant DataStorage
-         */
-        friend DataStorage_2D operator*(DataStorage_2D d1, const DataStorage_2D& d2)
-        {
-            d1 *= d2;
-            return d1;
+            return *this;
         }
 
+        // Indexing operator
         /**
-         * @brief Element-wise multiplication with DataStorage and a scalar
+         * @brief Returns a reference to the element at specified location
+         *        (x1, x2). Bounds are only checked in a debug build.
          *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_2D Resultant DataStorage
+         * @param x1 Position of the element in first dimension to return
+         * @param x2 Position of the element in second dimension to return
+         * @return real_t& Reference to the requested element
          */
-        friend DataStorage_2D operator*(DataStorage_2D d, const double val)
+        inline real_t &operator()(const std::size_t x1, const std::size_t x2)
         {
-            d *= val;
-            return d;
+#if PIC_DEBUG
+            if (x1 >= this->Nx || x2 >= this->Ny)
+            {
+                throw std::out_of_range(index_err);
+            }
+#endif
+            return this->data[x1 * this->Ny + x2];
         }
 
-
-        // Division with other DataStorage and with type double
         /**
-         * @brief Element-wise division two DataStorage objects
+         * @brief Returns a reference to the element at specified location
+         *        (x1, x2). Bounds are only checked in a debug build.
          *
-         * @param d1 DataStorage left of the operator
-         * @param d2 DataStorage right of the operator
-         * @return DataStorage_2D Resultant DataStorage
+         * @param x1 Position of the element in first dimension to return
+         * @param x2 Position of the element in second dimension to return
+         * @return const real_t& Reference to the requested element
          */
-        friend DataStorage_2D operator/(DataStorage_2D d1, const DataStorage_2D& d2)
+        inline const real_t& operator()(const std::size_t x1, const std::size_t x2) const
         {
-            d1 /= d2;
-            return d1;
+#if PIC_DEBUG
+            if (x1 >= this->Nx || x2 >= this->Ny)
+            {
+                throw std::out_of_range(index_err);
+            }
+#endif
+            return this->data[x1 * this->Ny + x2];
         }
 
-        /**
-         * @brief Element-wise division with DataStorage and a scalar
-         *
-         * @param d DataStorage left of the operator
-         * @param val Scalar right of the operator
-         * @return DataStorage_2D Resultant DataStorage
-         */
-        friend DataStorage_2D operator/(DataStorage_2D d, const double val)
-        {
-            d /= val;
-            return d;
-        }
 
+        // Element-wise +, -, * and / between objects, and with a scalar on
+        // the right, build expressions (see Expression.h) that are evaluated
+        // when assigned
 
         // Addition/Assignment with other DataStorage and double
         /**
@@ -225,6 +203,19 @@ class DataStorage_2D : public DataStorage
             return *this;
         }
 
+        /**
+         * @brief Element-wise addition and assignment for an expression of
+         *        DataStorage_2D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_2D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_2D& operator+=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Add>(expr);
+        }
+
 
         // Subtraction/Assignment with other DataStorage and double
         /**
@@ -266,6 +257,19 @@ class DataStorage_2D : public DataStorage
             return *this;
         }
 
+        /**
+         * @brief Element-wise subtraction and assignment for an expression of
+         *        DataStorage_2D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_2D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_2D& operator-=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Subtract>(expr);
+        }
+
 
         // Multiplication/Assignment with other DataStorage and double
         /**
@@ -307,6 +311,19 @@ class DataStorage_2D : public DataStorage
             return *this;
         }
 
+        /**
+         * @brief Element-wise multiplication and assignment for an expression of
+         *        DataStorage_2D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_2D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_2D& operator*=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Multiply>(expr);
+        }
+
 
         // Division/Assignment with other DataStorage and double
         /**
@@ -346,6 +363,19 @@ class DataStorage_2D : public DataStorage
 
             return *this;
         }
+
+        /**
+         * @brief Element-wise division and assignment for an expression of
+         *        DataStorage_2D objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return DataStorage_2D& This object after operation
+         */
+        template <typename E>
+        inline DataStorage_2D& operator/=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Divide>(expr);
+        }
         //-----------------------------------------
 
 
@@ -353,8 +383,8 @@ class DataStorage_2D : public DataStorage
         CLASS METHODS
         ***********************************************************/
 
-        double& at(const std::size_t x1, const std::size_t x2);
-        const double& at(const std::size_t idx, const std::size_t x2) const;
+        real_t& at(const std::size_t x1, const std::size_t x2);
+        const real_t& at(const std::size_t idx, const std::size_t x2) const;
 
         /**
          * @brief Get the number of Nx points in DataStorage object
@@ -0,0 +1,374 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Precision.h"
+
+/**
+ * @brief Lazy element-wise arithmetic on DataStorage_1D, DataStorage_2D and
+ *        GridObject. An operator between grids only records its operands,
+ *        and a whole expression like a + b * c is evaluated in a single loop
+ *        over the elements when it is assigned, without any temporary grids.
+ *
+ *        The operands of an expression are held by reference, so an
+ *        expression must not outlive the grids it is built from.
+ *
+ */
+namespace Expr
+{
+    const char shape_err[45] = "Error: Data objects are not of the same size";
+
+    /**
+     * @brief Base of every expression, a grid or an operation on grids. E is
+     *        the class deriving from it, which provides get_size, get_ndims,
+     *        get_Ni_size, operator[], and the value_type of its elements and
+     *        the result_type it evaluates to.
+     *
+     * @tparam E The expression type
+     */
+    template <typename E>
+    struct Expression
+    {
+        inline const E& self() const
+        {
+            return static_cast<const E&>(*this);
+        }
+    };
+
+
+    /**
+     * @brief A scalar operand, the same value at every element
+     *
+     */
+    struct Scalar
+    {
+        typedef double value_type;
+
+        double val;
+
+        explicit Scalar(const double val) : val(val)
+        {
+        }
+
+        inline double operator[](const std::size_t) const
+        {
+            return this->val;
+        }
+    };
+
+
+    // Element-wise operations
+    struct Assign
+    {
+        template <typename A, typename B>
+        static inline B apply(const A&, const B& b)
+        {
+            return b;
+        }
+    };
+
+    struct Add
+    {
+        template <typename A, typename B>
+        static inline auto apply(const A& a, const B& b) -> decltype(a + b)
+        {
+            return a + b;
+        }
+    };
+
+    struct Subtract
+    {
+        template <typename A, typename B>
+        static inline auto apply(const A& a, const B& b) -> decltype(a - b)
+        {
+            return a - b;
+        }
+    };
+
+    struct Multiply
+    {
+        template <typename A, typename B>
+        static inline auto apply(const A& a, const B& b) -> decltype(a * b)
+        {
+            return a * b;
+        }
+    };
+
+    struct Divide
+    {
+        template <typename A, typename B>
+        static inline auto apply(const A& a, const B& b) -> decltype(a / b)
+        {
+            return a / b;
+        }
+    };
+
+
+    template <typename L, typename R, typename Op>
+    class Binary;
+
+    // Grids are held by reference, and the operations and scalars, which
+    // are temporaries of the full expression, by value
+    template <typename E>
+    struct Operand
+    {
+        typedef const E& type;
+    };
+
+    template <typename L, typename R, typename Op>
+    struct Operand<Binary<L, R, Op> >
+    {
+        typedef Binary<L, R, Op> type;
+    };
+
+    template <>
+    struct Operand<Scalar>
+    {
+        typedef Scalar type;
+    };
+
+
+    /**
+     * @brief An element-wise operation between an expression on the left and
+     *        an expression or a scalar on the right. The shape is that of the
+     *        left operand.
+     *
+     * @tparam L The left expression type
+     * @tparam R The right expression type, or Scalar
+     * @tparam Op The element-wise operation
+     */
+    template <typename L, typename R, typename Op>
+    class Binary : public Expression<Binary<L, R, Op> >
+    {
+        private:
+            typename Operand<L>::type l;
+            typename Operand<R>::type r;
+
+        public:
+            typedef typename L::result_type result_type;
+            typedef typename std::common_type<typename L::value_type,
+                                              typename R::value_type>::type value_type;
+
+            Binary(const L& l, const R& r) : l(l), r(r)
+            {
+            }
+
+            inline value_type operator[](const std::size_t i) const
+            {
+                return Op::apply(this->l[i], this->r[i]);
+            }
+
+            inline std::size_t get_size() const
+            {
+                return this->l.get_size();
+            }
+
+            inline std::size_t get_ndims() const
+            {
+                return this->l.get_ndims();
+            }
+
+            inline std::size_t get_Ni_size(const std::size_t i) const
+            {
+                return std::size_t(this->l.get_Ni_size(i));
+            }
+    };
+
+
+    /**
+     * @brief Throws if two expressions do not have the same shape
+     *
+     * @param a First expression
+     * @param b Second expression
+     */
+    template <typename A, typename B>
+    inline void check_shape(const A& a, const B& b)
+    {
+        bool same = (a.get_ndims() == b.get_ndims());
+        for (std::size_t i = 0; same && i < a.get_ndims(); ++i)
+        {
+            same = (std::size_t(a.get_Ni_size(i)) ==
+                    std::size_t(b.get_Ni_size(i)));
+        }
+
+        if (!same)
+        {
+            throw std::runtime_error(shape_err);
+        }
+    }
+
+    /**
+     * @brief Evaluates an expression into out in one vectorized loop,
+     *        combining every element already there with Op
+     *
+     *        out may be the storage of one of the operands, as in a = a * b,
+     *        but never overlaps one partially: every operand is a whole grid
+     *        of the same shape. Element i only reads element i of each
+     *        operand, so the lanes of a vector never depend on each other and
+     *        the loop vectorizes without checking for aliasing.
+     *
+     * @tparam Op Assign, or the operation of a compound assignment
+     * @param out Storage of the grid being assigned to
+     * @param e Expression to evaluate, of the same shape as out
+     */
+    template <typename Op, typename E>
+    inline void evaluate(real_t* out, const E& e)
+    {
+        const std::size_t size = e.get_size();
+        #pragma omp simd
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            out[i] = Op::apply(out[i], e[i]);
+        }
+    }
+
+
+    /**********************************************************
+    OPERATOR FUNCTIONS
+    ***********************************************************/
+
+    // Addition with another expression and with type double
+    /**
+     * @brief Element-wise addition of two expressions of the same kind and
+     *        shape of grid
+     *
+     * @param l Expression left of the operator
+     * @param r Expression right of the operator
+     * @return Binary<L, R, Add> The unevaluated addition
+     */
+    template <typename L, typename R>
+    inline Binary<L, R, Add> operator+(const Expression<L>& l,
+                                       const Expression<R>& r)
+    {
+        static_assert(std::is_same<typename L::result_type,
+                                   typename R::result_type>::value,
+                      "Expression operands are different kinds of grid");
+        check_shape(l.self(), r.self());
+        return Binary<L, R, Add>(l.self(), r.self());
+    }
+
+    /**
+     * @brief Element-wise addition of an expression and a scalar
+     *
+     * @param l Expression left of the operator
+     * @param val Scalar right of the operator
+     * @return Binary<L, Scalar, Add> The unevaluated addition
+     */
+    template <typename L>
+    inline Binary<L, Scalar, Add> operator+(const Expression<L>& l,
+                                            const double val)
+    {
+        return Binary<L, Scalar, Add>(l.self(), Scalar(val));
+    }
+
+
+    // Subtraction with another expression and with type double
+    /**
+     * @brief Element-wise subtraction of two expressions of the same kind and
+     *        shape of grid
+     *
+     * @param l Expression left of the operator
+     * @param r Expression right of the operator
+     * @return Binary<L, R, Subtract> The unevaluated subtraction
+     */
+    template <typename L, typename R>
+    inline Binary<L, R, Subtract> operator-(const Expression<L>& l,
+                                            const Expression<R>& r)
+    {
+        static_assert(std::is_same<typename L::result_type,
+                                   typename R::result_type>::value,
+                      "Expression operands are different kinds of grid");
+        check_shape(l.self(), r.self());
+        return Binary<L, R, Subtract>(l.self(), r.self());
+    }
+
+    /**
+     * @brief Element-wise subtraction of an expression and a scalar
+     *
+     * @param l Expression left of the operator
+     * @param val Scalar right of the operator
+     * @return Binary<L, Scalar, Subtract> The unevaluated subtraction
+     */
+    template <typename L>
+    inline Binary<L, Scalar, Subtract> operator-(const Expression<L>& l,
+                                                 const double val)
+    {
+        return Binary<L, Scalar, Subtract>(l.self(), Scalar(val));
+    }
+
+
+    // Multiplication with another expression and with type double
+    /**
+     * @brief Element-wise multiplication of two expressions of the same kind and
+     *        shape of grid
+     *
+     * @param l Expression left of the operator
+     * @param r Expression right of the operator
+     * @return Binary<L, R, Multiply> The unevaluated multiplication
+     */
+    template <typename L, typename R>
+    inline Binary<L, R, Multiply> operator*(const Expression<L>& l,
+                                            const Expression<R>& r)
+    {
+        static_assert(std::is_same<typename L::result_type,
+                                   typename R::result_type>::value,
+                      "Expression operands are different kinds of grid");
+        check_shape(l.self(), r.self());
+        return Binary<L, R, Multiply>(l.self(), r.self());
+    }
+
+    /**
+     * @brief Element-wise multiplication of an expression and a scalar
+     *
+     * @param l Expression left of the operator
+     * @param val Scalar right of the operator
+     * @return Binary<L, Scalar, Multiply> The unevaluated multiplication
+     */
+    template <typename L>
+    inline Binary<L, Scalar, Multiply> operator*(const Expression<L>& l,
+                                                 const double val)
+    {
+        return Binary<L, Scalar, Multiply>(l.self(), Scalar(val));
+    }
+
+
+    // Division with another expression and with type double
+    /**
+     * @brief Element-wise division of two expressions of the same kind and
+     *        shape of grid
+     *
+     * @param l Expression left of the operator
+     * @param r Expression right of the operator
+     * @return Binary<L, R, Divide> The unevaluated division
+     */
+    template <typename L, typename R>
+    inline Binary<L, R, Divide> operator/(const Expression<L>& l,
+                                          const Expression<R>& r)
+    {
+        static_assert(std::is_same<typename L::result_type,
+                                   typename R::result_type>::value,
+                      "Expression operands are different kinds of grid");
+        check_shape(l.self(), r.self());
+        return Binary<L, R, Divide>(l.self(), r.self());
+    }
+
+    /**
+     * @brief Element-wise division of an expression and a scalar
+     *
+     * @param l Expression left of the operator
+     * @param val Scalar right of the operator
+     * @return Binary<L, Scalar, Divide> The unevaluated division
+     */
+    template <typename L>
+    inline Binary<L, Scalar, Divide> operator/(const Expression<L>& l,
+                                               const double val)
+    {
+        return Binary<L, Scalar, Divide>(l.self(), Scalar(val));
+    }
+    //-----------------------------------------
+}
+
+#endif
@@ -4,7 +4,9 @@
 *   FFT Header file, based on code from www.codeproject.com, originally    *
 *   based on code from Numerical Recipes with refinement in speed.         *
 *   Added functionality to load in complex and real arrays          	   *
-*   separately. This requires a number of values which is a power of 2.    *
+*   separately. Lengths are no longer limited to powers of 2: they are     *
+*   factored into radices 2, 3, 4, 5 and 7, or else done by Bluestein.     *
+*   Powers of 2 use radix-4 butterflies compiled for AVX-512 and AVX2.     *
 *   This version is also normalized so that the 1/N is taken into account. *
 *   AGRT 2010                                                              *
 *                                                                          *
@@ -12,20 +14,25 @@
 
     data_re -> float array that represent the real array of complex samples
     data_im -> float array that represent the imag array of complex samples
-    NVALS -> length of real or imaginary arrays (N^2 order number)
+    NVALS -> length of real or imaginary arrays
     isign -> 1 to calculate FFT and -1 to calculate Reverse FFT
 
     The function returns an integer, 0 if FFT ran, 1 otherwise. It will be
-    one if NVALS is not a power of 2
+    one if NVALS is 0 or does not match the plan
 */
 
 #include "FFT.h"
 
-#define SWAP(a, b) \
-    tempr = (a);   \
-    (a) = (b);     \
-    (b) = tempr
-//tempr is a variable from our FFT function
+#include <algorithm>
+#include <utility>
+
+// Compile several versions of a kernel and dispatch between them at load time
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define FFT_TARGET_CLONES \
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define FFT_TARGET_CLONES
+#endif
 
 /**
  * @brief Computes the value of sinc(x)
@@ -45,214 +52,1656 @@ double FFT::sinc(const double x)
     }
 }
 
+/**********************************************************
+PLAN
+***********************************************************/
+
 /**
- * @brief Performs a 1D (inverse) Fourier transform of a grid
+ * @brief Constructor for an empty Plan, which transforms nothing
  *
- * @param data_re The real part of the grid to (i)FFT
- * @param data_im The imaginary part of the grid to (i)FFT
- * @param isign Whether to perform an FFT or an IFFT
+ */
+FFT::Plan::Plan()
+{
+    this->N = 0;
+    this->dir = FFT::FFT_Dir::FFT;
+    this->algorithm = Plan::Algorithm::None;
+    this->M = 0;
+    this->w_dir = FFT::FFT_Dir::FFT;
+    this->radix_2_first = false;
+}
+
+/**
+ * @brief Constructor for Plan - picks the algorithm for the length and
+ *        computes its permutation and twiddles
+ *
+ * @param N Length of the transform. A length of 0 makes a plan whose execute
+ *          returns an error.
+ * @param dir Whether to perform an FFT or an IFFT
+ */
+FFT::Plan::Plan(const std::size_t N, const FFT::FFT_Dir dir)
+{
+    this->N = N;
+    this->dir = dir;
+    this->algorithm = Plan::Algorithm::None;
+    this->M = 0;
+    this->w_dir = dir;
+    this->radix_2_first = false;
+
+    if (N == 0)
+    {
+        return;
+    }
+
+    if (!(N & (N - 1)))
+    {
+        this->algorithm = Plan::Algorithm::Power_Of_2;
+        this->_plan_power_of_2(N, dir);
+        return;
+    }
+
+    // Factors with their own butterflies, 4 first so that powers of 2 take
+    // as few stages as possible
+    const std::size_t factors[5] = {4, 2, 3, 5, 7};
+    std::size_t rest = N;
+    for (std::size_t f = 0; f < 5; ++f)
+    {
+        while (rest % factors[f] == 0)
+        {
+            this->radices.push_back(factors[f]);
+            rest /= factors[f];
+        }
+    }
+
+    if (rest == 1)
+    {
+        this->algorithm = Plan::Algorithm::Mixed_Radix;
+        this->_plan_mixed_radix();
+    }
+    else
+    {
+        this->radices.clear();
+        this->algorithm = Plan::Algorithm::Bluestein;
+        this->_plan_bluestein();
+    }
+}
+
+/**
+ * @brief Performs the transform in place
+ *
+ * @param re The real part of the N values to (i)FFT
+ * @param im The imaginary part of the N values to (i)FFT
  * @return int An error code or 0 if it worked correctly
  */
-int FFT::FFT_1D(std::vector<double>& data_re, std::vector<double>& data_im,
-                FFT::FFT_Dir isign)
+int FFT::Plan::execute(real_t* re, real_t* im) const
 {
-    // assumes real_part and im_part are the same size!
-    const std::size_t NVALS = data_re.size();
-
-    // TEST THAT NVALS IS A POWER OF 2
-    const int err = !(NVALS && !(NVALS & (NVALS - 1)));
-    if (!err)
-    {
-        /*
-	    the complex array is real+complex so the array
-	    as a size n = 2 * number of samples
-	    real part is data[index] and the complex part is data[index+1]
-        */
-        const std::size_t n = NVALS << 1; // bitwise multiply by 2
-
-        /*
-	    Pack components into double array of size n - the ordering
-	    is data[0]=real[0], data[1]=imag[0] .......
-        */
-        std::vector<double> data(n);
-        for (std::size_t i = 0, j = 0; j < n; ++i, j += 2)
+    switch (this->algorithm)
+    {
+        case Plan::Algorithm::Power_Of_2:
+            this->_power_of_2(re, im);
+            break;
+        case Plan::Algorithm::Mixed_Radix:
+            this->_mixed_radix(re, im);
+            break;
+        case Plan::Algorithm::Bluestein:
+            this->_bluestein(re, im);
+            break;
+        default:
+            return 1;
+    }
+
+    if (this->dir == FFT::FFT_Dir::iFFT)
+    {
+        const real_t invNVALs = 1.0 / this->N;
+        for (std::size_t i = 0; i < this->N; ++i)
         {
-            data[j] = data_re[i];
-            data[j + 1] = data_im[i];
+            re[i] *= invNVALs;
+            im[i] *= invNVALs;
         }
-        /*
-	    binary inversion (note that
-	    the indexes start from 1 which means that the
-	    real part of the complex is on the odd-indexes
-	    and the complex part is on the even-indexes
-        */
-
-        std::size_t j = 0;
-        for (std::size_t i = 0; i < n / 2; i += 2)
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Performs the transform in place
+ *
+ * @param re The real part of the values to (i)FFT
+ * @param im The imaginary part of the values to (i)FFT
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::Plan::execute(std::vector<real_t>& re, std::vector<real_t>& im) const
+{
+    if (re.size() != this->N || im.size() != this->N)
+    {
+        return 1;
+    }
+
+    return this->execute(re.data(), im.data());
+}
+
+/**
+ * @brief Performs the transform in place on several lines stored one after
+ *        the other
+ *
+ * @param re The real part of the lines to (i)FFT
+ * @param im The imaginary part of the lines to (i)FFT
+ * @param howmany Number of lines
+ * @param dist Distance between the starts of consecutive lines
+ * @param n_threads Number of threads sharing out the lines
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::Plan::execute_many(real_t* re, real_t* im,
+                            const std::size_t howmany,
+                            const std::size_t dist,
+                            const int n_threads) const
+{
+    if (this->algorithm == Plan::Algorithm::None)
+    {
+        return 1;
+    }
+
+    #pragma omp parallel for num_threads(n_threads) schedule(static)
+    for (std::size_t l = 0; l < howmany; ++l)
+    {
+        this->execute(re + l * dist, im + l * dist);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Performs the transform in place on several lines stored side by
+ *        side, value n of line l being at n * stride + l. Power of 2 lengths
+ *        transform all the lines together, one per vector lane; other lengths
+ *        transform them one at a time.
+ *
+ * @param re The real part of the lines to (i)FFT
+ * @param im The imaginary part of the lines to (i)FFT
+ * @param lanes Number of lines
+ * @param stride Distance between consecutive values of a line
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::Plan::execute_lanes(real_t* re, real_t* im,
+                             const std::size_t lanes,
+                             const std::size_t stride) const
+{
+    if (this->algorithm == Plan::Algorithm::None)
+    {
+        return 1;
+    }
+
+    if (this->algorithm != Plan::Algorithm::Power_Of_2)
+    {
+        static thread_local std::vector<real_t> line_re, line_im;
+        line_re.resize(this->N);
+        line_im.resize(this->N);
+
+        for (std::size_t l = 0; l < lanes; ++l)
         {
-            if (j > i)
+            for (std::size_t n = 0; n < this->N; ++n)
+            {
+                line_re[n] = re[n * stride + l];
+                line_im[n] = im[n * stride + l];
+            }
+            this->execute(line_re.data(), line_im.data());
+            for (std::size_t n = 0; n < this->N; ++n)
             {
-                double tempr; // for the SWAP macro
+                re[n * stride + l] = line_re[n];
+                im[n * stride + l] = line_im[n];
+            }
+        }
 
-                //swap the real part
-                SWAP(data[j], data[i]);
+        return 0;
+    }
 
-                //swap the complex part
-                SWAP(data[j + 1], data[i + 1]);
+    this->_power_of_2_lanes(re, im, lanes, stride);
 
-                // checks if the changes occurs in the first half
-                // and use the mirrored effect on the second half
-                if ((j / 2) < (n / 4))
-                {
-                    //swap the real part
-                    SWAP(data[(n - (i + 2))], data[(n - (j + 2))]);
+    if (this->dir == FFT::FFT_Dir::iFFT)
+    {
+        const real_t invNVALs = 1.0 / this->N;
+        for (std::size_t n = 0; n < this->N; ++n)
+        {
+            real_t* r = re + n * stride;
+            real_t* i = im + n * stride;
 
-                    //swap the complex part
-                    SWAP(data[(n - (i + 2)) + 1], data[(n - (j + 2)) + 1]);
-                }
+            #pragma omp simd
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                r[l] *= invNVALs;
+                i[l] *= invNVALs;
             }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Computes the bit-reversal permutation and the twiddles of power of
+ *        2 transforms
+ *
+ * @param len Length of the transforms, a power of 2
+ * @param d Direction of the transforms
+ */
+void FFT::Plan::_plan_power_of_2(const std::size_t len, const FFT::FFT_Dir d)
+{
+    this->M = len;
+    this->w_dir = d;
+
+    // binary inversion, keeping each pair to swap once
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < len; ++i)
+    {
+        if (i < j)
+        {
+            this->swaps.push_back(i);
+            this->swaps.push_back(j);
+        }
+
+        std::size_t m = len >> 1;
+        while (m >= 1 && (j & m))
+        {
+            j ^= m;
+            m >>= 1;
+        }
+        j |= m;
+    }
+
+    // A radix-4 stage does the work of two radix-2 stages, so an odd number
+    // of them needs one radix-2 stage first
+    this->radix_2_first = false;
+    for (std::size_t n = len; n > 1; n >>= 2)
+    {
+        this->radix_2_first = (n == 2);
+    }
 
-            std::size_t m = NVALS;
-            while (m >= 2 && j >= m)
+    // Twiddles are computed directly rather than by recurrence, so they are
+    // accurate to the last bit
+    this->w_re.clear();
+    this->w_im.clear();
+    for (std::size_t h = this->radix_2_first ? 2 : 1; h < len; h *= 4)
+    {
+        for (std::size_t p = 1; p <= 3; ++p)
+        {
+            for (std::size_t k = 0; k < h; ++k)
             {
-                j -= m;
-                m >>= 1;
+                const double theta = d * M_PI * double(p * k) / double(2 * h);
+                this->w_re.push_back(cos(theta));
+                this->w_im.push_back(sin(theta));
             }
-            j += m;
         }
+    }
+}
+
+/**
+ * @brief Computes the digit-reversal permutation and the twiddles of the
+ *        mixed-radix stages. Stage s joins r_s transforms of length L into
+ *        one of length r_s L, with L the product of the earlier radices.
+ *
+ */
+void FFT::Plan::_plan_mixed_radix()
+{
+    const std::size_t N = this->N;
+    const std::size_t n_stages = this->radices.size();
+
+    // The transform of length L in place at p holds the values of the input
+    // whose index is p with its digits in reverse order, the first radix
+    // being the most significant
+    std::vector<std::size_t> rev(N);
+    for (std::size_t p = 0; p < N; ++p)
+    {
+        std::size_t rest = p, weight = N, in = 0, mult = 1;
+        for (std::size_t s = n_stages; s-- > 0;)
+        {
+            weight /= this->radices[s];
+            in += (rest / weight) * mult;
+            rest %= weight;
+            mult *= this->radices[s];
+        }
+        rev[p] = in;
+    }
+
+    // The permutation is done in place by following each of its cycles
+    std::vector<bool> done(N, false);
+    for (std::size_t p = 0; p < N; ++p)
+    {
+        if (done[p] || rev[p] == p)
+        {
+            continue;
+        }
+
+        std::size_t q = p;
+        do
+        {
+            this->cycles.push_back(q);
+            done[q] = true;
+            q = rev[q];
+        } while (q != p);
+        this->cycle_ends.push_back(this->cycles.size());
+    }
 
-        //Danielson-Lanzcos routine
-        std::size_t mmax = 2;
-        while (n > mmax)
+    // Twiddles exp(dir 2 pi i j k / (r L)) of every butterfly k < L and
+    // input j = 1..r-1
+    std::size_t L = 1;
+    for (std::size_t s = 0; s < n_stages; ++s)
+    {
+        const std::size_t r = this->radices[s];
+        for (std::size_t k = 0; k < L; ++k)
         {
-            std::size_t istep = mmax << 1;
-            double theta = isign * (2.0 * M_PI / mmax);
-            double wtemp = sin(0.5 * theta);
-            double wpr = -2.0 * wtemp * wtemp;
-            double wpi = sin(theta);
-            double wr = 1.0;
-            double wi = 0.0;
-            //internal loops
-
-            for (std::size_t m = 1; m < mmax; m += 2)
+            for (std::size_t j = 1; j < r; ++j)
             {
-                for (std::size_t i = m; i <= n; i += istep)
-                {
-                    std::size_t j = i + mmax;
-                    double tempr = wr * data[j - 1] - wi * data[j];
-                    double tempi = wr * data[j] + wi * data[j - 1];
-                    data[j - 1] = data[i - 1] - tempr;
-                    data[j] = data[i] - tempi;
-                    data[i - 1] += tempr;
-                    data[i] += tempi;
-                }
-                wr = (wtemp = wr) * wpr - wi * wpi + wr;
-                wi = wi * wpr + wtemp * wpi + wi;
+                const double theta = this->dir * 2.0 * M_PI *
+                                     double(j * k) / double(r * L);
+                this->t_re.push_back(cos(theta));
+                this->t_im.push_back(sin(theta));
             }
-            mmax = istep;
         }
-        /*
-	    Return elements to real and complex components
-        */
-        switch (isign)
+        L *= r;
+    }
+
+    // Radix 7 has no butterfly of its own, and is summed over its roots of
+    // unity
+    this->root_re.resize(7);
+    this->root_im.resize(7);
+    for (std::size_t m = 0; m < 7; ++m)
+    {
+        const double theta = this->dir * 2.0 * M_PI * double(m) / 7.0;
+        this->root_re[m] = cos(theta);
+        this->root_im[m] = sin(theta);
+    }
+}
+
+/**
+ * @brief Computes the chirp and the transformed convolution kernel of
+ *        Bluestein's algorithm. With n k = (n^2 + k^2 - (k - n)^2) / 2 the
+ *        transform is X(k) = b(k) sum_n x(n) b(n) b*(k - n), with the chirp
+ *        b(n) = exp(dir i pi n^2 / N): a convolution with b*, done with
+ *        forward power of 2 transforms of a length M of at least 2N - 1.
+ *
+ */
+void FFT::Plan::_plan_bluestein()
+{
+    const std::size_t N = this->N;
+
+    std::size_t M = 1;
+    while (M < 2 * N - 1)
+    {
+        M <<= 1;
+    }
+    this->_plan_power_of_2(M, FFT::FFT_Dir::FFT);
+
+    // n^2 is reduced modulo 2N first, so that the angles stay accurate
+    this->chirp_re.resize(N);
+    this->chirp_im.resize(N);
+    for (std::size_t n = 0; n < N; ++n)
+    {
+        const double theta = this->dir * M_PI *
+                             double((n * n) % (2 * N)) / double(N);
+        this->chirp_re[n] = cos(theta);
+        this->chirp_im[n] = sin(theta);
+    }
+
+    // b*(m) for m = -(N - 1)..N - 1, wrapped around, and zero between
+    this->kernel_re.assign(M, 0.0);
+    this->kernel_im.assign(M, 0.0);
+    for (std::size_t n = 0; n < N; ++n)
+    {
+        this->kernel_re[n] = this->chirp_re[n];
+        this->kernel_im[n] = -this->chirp_im[n];
+        if (n > 0)
         {
-            case FFT::FFT_Dir::FFT:
-                for (std::size_t i = 0, j = 0; j < n; ++i, j += 2)
-                {
-                    data_re[i] = data[j];
-                    data_im[i] = data[j + 1];
-                }
-                break;
-            case FFT::FFT_Dir::iFFT:
-                double invNVALs = 1.0 / NVALS;
-                for (std::size_t i = 0, j = 0; j < n; ++i, j += 2)
-                {
-                    data_re[i] = data[j] * invNVALs;
-                    data_im[i] = data[j + 1] * invNVALs;
-                }
-                break;
+            this->kernel_re[M - n] = this->chirp_re[n];
+            this->kernel_im[M - n] = -this->chirp_im[n];
         }
     }
-    return err;
+
+    this->_power_of_2(this->kernel_re.data(), this->kernel_im.data());
+
+    // The 1/M of the inverse transform of the convolution is done here
+    for (std::size_t m = 0; m < M; ++m)
+    {
+        this->kernel_re[m] /= M;
+        this->kernel_im[m] /= M;
+    }
 }
 
 /**
- * @brief Performs a 2D (inverse) Fourier transform of a grid
+ * @brief Performs an unnormalized power of 2 transform of length M in place.
+ *        With bit-reversed input, the radix-2 stages joining transforms of
+ *        length h and then 2h can be done together as one radix-4 stage: the
+ *        four inputs a0..a3 of butterfly k are taken times 1, t^2, t and t^3,
+ *        t = exp(dir i pi k / 2h), and combined as a transform of length 4.
  *
- * @param real_part The real part of the grid to (i)FFT
- * @param imag_part The imaginary part of the grid to (i)FFT
- * @param transform_dir Whether to perform an FFT or an IFFT
- * @return int An error code or 0 if it worked correctly
+ * @param re The real part of the M values to transform
+ * @param im The imaginary part of the M values to transform
  */
-int FFT::FFT_2D(GridObject& real_part, GridObject& imag_part,
-                FFT::FFT_Dir transform_dir)
+FFT_TARGET_CLONES
+void FFT::Plan::_power_of_2(real_t* re, real_t* im) const
 {
-    int err = 0;
-
-    // assumes real_part and im_part are the same size!
-    const std::size_t Nx = real_part.get_Nx();
-    const std::size_t Ny = real_part.get_Ny();
+    const std::size_t N = this->M;
+    const real_t d = this->w_dir;
 
-    // spectral solve: Fourier transform rows, then columns
-    // for each row: collect data, Fourier transform, return, and store
-    std::vector<double> xs_re(Ny), xs_im(Ny);
+    for (std::size_t s = 0; s < this->swaps.size(); s += 2)
+    {
+        std::swap(re[this->swaps[s]], re[this->swaps[s + 1]]);
+        std::swap(im[this->swaps[s]], im[this->swaps[s + 1]]);
+    }
 
-    for (std::size_t xi = 0; xi < Nx; ++xi)
+    std::size_t h = 1;
+    if (this->radix_2_first)
     {
-        for (std::size_t yj = 0; yj < Ny; ++yj)
+        for (std::size_t i = 0; i < N; i += 2)
         {
-            xs_re[yj] = real_part.get_comp(xi, yj);
-            xs_im[yj] = imag_part.get_comp(xi, yj);
+            const real_t br = re[i + 1], bi = im[i + 1];
+            re[i + 1] = re[i] - br;
+            im[i + 1] = im[i] - bi;
+            re[i] += br;
+            im[i] += bi;
         }
-        err = FFT::FFT_1D(xs_re, xs_im, transform_dir);
-        if (err)
+        h = 2;
+    }
+
+    const real_t* w_re = this->w_re.data();
+    const real_t* w_im = this->w_im.data();
+
+    for (; h < N; h *= 4)
+    {
+        const real_t* w1r = w_re;
+        const real_t* w1i = w_im;
+        const real_t* w2r = w_re + h;
+        const real_t* w2i = w_im + h;
+        const real_t* w3r = w_re + 2 * h;
+        const real_t* w3i = w_im + 2 * h;
+
+        for (std::size_t i = 0; i < N; i += 4 * h)
         {
-            return err;
+            real_t* r0 = re + i;
+            real_t* i0 = im + i;
+            real_t* r1 = r0 + h;
+            real_t* i1 = i0 + h;
+            real_t* r2 = r0 + 2 * h;
+            real_t* i2 = i0 + 2 * h;
+            real_t* r3 = r0 + 3 * h;
+            real_t* i3 = i0 + 3 * h;
+
+            #pragma omp simd
+            for (std::size_t k = 0; k < h; ++k)
+            {
+                const real_t a1r = w2r[k] * r1[k] - w2i[k] * i1[k];
+                const real_t a1i = w2r[k] * i1[k] + w2i[k] * r1[k];
+                const real_t a2r = w1r[k] * r2[k] - w1i[k] * i2[k];
+                const real_t a2i = w1r[k] * i2[k] + w1i[k] * r2[k];
+                const real_t a3r = w3r[k] * r3[k] - w3i[k] * i3[k];
+                const real_t a3i = w3r[k] * i3[k] + w3i[k] * r3[k];
+
+                const real_t s0r = r0[k] + a1r, s0i = i0[k] + a1i;
+                const real_t d0r = r0[k] - a1r, d0i = i0[k] - a1i;
+                const real_t s1r = a2r + a3r, s1i = a2i + a3i;
+                const real_t d1r = a2r - a3r, d1i = a2i - a3i;
+
+                // the quarter turn is i dir
+                r0[k] = s0r + s1r;
+                i0[k] = s0i + s1i;
+                r2[k] = s0r - s1r;
+                i2[k] = s0i - s1i;
+                r1[k] = d0r - d * d1i;
+                i1[k] = d0i + d * d1r;
+                r3[k] = d0r + d * d1i;
+                i3[k] = d0i - d * d1r;
+            }
         }
-        for (std::size_t yj = 0; yj < Ny; ++yj)
+
+        w_re += 3 * h;
+        w_im += 3 * h;
+    }
+}
+
+/**
+ * @brief Performs unnormalized power of 2 transforms of length M in place on
+ *        lines stored side by side, as _power_of_2. The butterflies of every
+ *        line are done together, one line per vector lane.
+ *
+ * @param re The real part of the values to transform, value n of line l
+ *           being at n * stride + l
+ * @param im The imaginary part of the values to transform
+ * @param lanes Number of lines
+ * @param stride Distance between consecutive values of a line
+ */
+FFT_TARGET_CLONES
+void FFT::Plan::_power_of_2_lanes(real_t* re, real_t* im,
+                                  const std::size_t lanes,
+                                  const std::size_t stride) const
+{
+    const std::size_t N = this->M;
+    const real_t d = this->w_dir;
+
+    for (std::size_t s = 0; s < this->swaps.size(); s += 2)
+    {
+        real_t* ar = re + this->swaps[s] * stride;
+        real_t* ai = im + this->swaps[s] * stride;
+        real_t* br = re + this->swaps[s + 1] * stride;
+        real_t* bi = im + this->swaps[s + 1] * stride;
+
+        #pragma omp simd
+        for (std::size_t l = 0; l < lanes; ++l)
         {
-            real_part.set_comp(xi, yj, xs_re[yj]);
-            imag_part.set_comp(xi, yj, xs_im[yj]);
+            const real_t tr = ar[l], ti = ai[l];
+            ar[l] = br[l];
+            ai[l] = bi[l];
+            br[l] = tr;
+            bi[l] = ti;
         }
     }
 
-    // now columns
-    std::vector<double> ys_re(Nx), ys_im(Nx);
-    for (std::size_t yj = 0; yj < Ny; ++yj)
+    std::size_t h = 1;
+    if (this->radix_2_first)
     {
-        for (std::size_t xi = 0; xi < Nx; ++xi)
+        for (std::size_t i = 0; i < N; i += 2)
         {
-            ys_re[xi] = real_part.get_comp(xi, yj);
-            ys_im[xi] = imag_part.get_comp(xi, yj);
+            real_t* ar = re + i * stride;
+            real_t* ai = im + i * stride;
+            real_t* br = ar + stride;
+            real_t* bi = ai + stride;
+
+            #pragma omp simd
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                const real_t tr = br[l], ti = bi[l];
+                br[l] = ar[l] - tr;
+                bi[l] = ai[l] - ti;
+                ar[l] += tr;
+                ai[l] += ti;
+            }
         }
-        err = FFT::FFT_1D(ys_re, ys_im, transform_dir);
-        if (err)
+        h = 2;
+    }
+
+    const real_t* w_re = this->w_re.data();
+    const real_t* w_im = this->w_im.data();
+
+    for (; h < N; h *= 4)
+    {
+        for (std::size_t i = 0; i < N; i += 4 * h)
         {
-            return err;
+            for (std::size_t k = 0; k < h; ++k)
+            {
+                const real_t w1r = w_re[k], w1i = w_im[k];
+                const real_t w2r = w_re[h + k], w2i = w_im[h + k];
+                const real_t w3r = w_re[2 * h + k], w3i = w_im[2 * h + k];
+
+                real_t* r0 = re + (i + k) * stride;
+                real_t* i0 = im + (i + k) * stride;
+                real_t* r1 = r0 + h * stride;
+                real_t* i1 = i0 + h * stride;
+                real_t* r2 = r0 + 2 * h * stride;
+                real_t* i2 = i0 + 2 * h * stride;
+                real_t* r3 = r0 + 3 * h * stride;
+                real_t* i3 = i0 + 3 * h * stride;
+
+                #pragma omp simd
+                for (std::size_t l = 0; l < lanes; ++l)
+                {
+                    const real_t a1r = w2r * r1[l] - w2i * i1[l];
+                    const real_t a1i = w2r * i1[l] + w2i * r1[l];
+                    const real_t a2r = w1r * r2[l] - w1i * i2[l];
+                    const real_t a2i = w1r * i2[l] + w1i * r2[l];
+                    const real_t a3r = w3r * r3[l] - w3i * i3[l];
+                    const real_t a3i = w3r * i3[l] + w3i * r3[l];
+
+                    const real_t s0r = r0[l] + a1r, s0i = i0[l] + a1i;
+                    const real_t d0r = r0[l] - a1r, d0i = i0[l] - a1i;
+                    const real_t s1r = a2r + a3r, s1i = a2i + a3i;
+                    const real_t d1r = a2r - a3r, d1i = a2i - a3i;
+
+                    r0[l] = s0r + s1r;
+                    i0[l] = s0i + s1i;
+                    r2[l] = s0r - s1r;
+                    i2[l] = s0i - s1i;
+                    r1[l] = d0r - d * d1i;
+                    i1[l] = d0i + d * d1r;
+                    r3[l] = d0r + d * d1i;
+                    i3[l] = d0i - d * d1r;
+                }
+            }
         }
-        for (std::size_t xi = 0; xi < Nx; ++xi)
+
+        w_re += 3 * h;
+        w_im += 3 * h;
+    }
+}
+
+/**
+ * @brief Performs an unnormalized mixed-radix transform of length N in place
+ *
+ * @param re The real part of the N values to transform
+ * @param im The imaginary part of the N values to transform
+ */
+void FFT::Plan::_mixed_radix(real_t* re, real_t* im) const
+{
+    const std::size_t N = this->N;
+    const real_t d = this->dir;
+
+    std::size_t start = 0;
+    for (std::size_t c = 0; c < this->cycle_ends.size(); ++c)
+    {
+        const std::size_t end = this->cycle_ends[c];
+        const real_t first_re = re[this->cycles[start]];
+        const real_t first_im = im[this->cycles[start]];
+        for (std::size_t q = start; q + 1 < end; ++q)
         {
-            real_part.set_comp(xi, yj, ys_re[xi]);
-            imag_part.set_comp(xi, yj, ys_im[xi]);
+            re[this->cycles[q]] = re[this->cycles[q + 1]];
+            im[this->cycles[q]] = im[this->cycles[q + 1]];
         }
+        re[this->cycles[end - 1]] = first_re;
+        im[this->cycles[end - 1]] = first_im;
+        start = end;
     }
 
-    return err;
+    const real_t s3 = d * 0.86602540378443864676;  // sin(2 pi / 3)
+    const real_t c5_1 = 0.30901699437494742410;     // cos(2 pi / 5)
+    const real_t c5_2 = -0.80901699437494742410;    // cos(4 pi / 5)
+    const real_t s5_1 = d * 0.95105651629515357212; // sin(2 pi / 5)
+    const real_t s5_2 = d * 0.58778525229247312917; // sin(4 pi / 5)
+
+    const real_t* tw_re = this->t_re.data();
+    const real_t* tw_im = this->t_im.data();
+
+    std::size_t L = 1;
+    for (std::size_t s = 0; s < this->radices.size(); ++s)
+    {
+        const std::size_t r = this->radices[s];
+
+        for (std::size_t i = 0; i < N; i += r * L)
+        {
+            for (std::size_t k = 0; k < L; ++k)
+            {
+                const real_t* wr = tw_re + k * (r - 1);
+                const real_t* wi = tw_im + k * (r - 1);
+                real_t* a_re = re + i + k;
+                real_t* a_im = im + i + k;
+
+                // inputs of the butterfly, times their twiddles
+                real_t xr[7], xi[7];
+                xr[0] = a_re[0];
+                xi[0] = a_im[0];
+                for (std::size_t j = 1; j < r; ++j)
+                {
+                    const real_t br = a_re[j * L], bi = a_im[j * L];
+                    xr[j] = wr[j - 1] * br - wi[j - 1] * bi;
+                    xi[j] = wr[j - 1] * bi + wi[j - 1] * br;
+                }
+
+                switch (r)
+                {
+                    case 2:
+                    {
+                        a_re[0] = xr[0] + xr[1];
+                        a_im[0] = xi[0] + xi[1];
+                        a_re[L] = xr[0] - xr[1];
+                        a_im[L] = xi[0] - xi[1];
+                        break;
+                    }
+                    case 3:
+                    {
+                        // y1,2 = x0 - (x1 + x2) / 2 +- i sin(2 pi / 3) (x1 - x2)
+                        const real_t sr = xr[1] + xr[2], si = xi[1] + xi[2];
+                        const real_t mr = xr[0] - 0.5 * sr;
+                        const real_t mi = xi[0] - 0.5 * si;
+                        const real_t nr = -s3 * (xi[1] - xi[2]);
+                        const real_t ni = s3 * (xr[1] - xr[2]);
+                        a_re[0] = xr[0] + sr;
+                        a_im[0] = xi[0] + si;
+                        a_re[L] = mr + nr;
+                        a_im[L] = mi + ni;
+                        a_re[2 * L] = mr - nr;
+                        a_im[2 * L] = mi - ni;
+                        break;
+                    }
+                    case 4:
+                    {
+                        // the quarter turn is i dir
+                        const real_t pr = xr[0] + xr[2], pi = xi[0] + xi[2];
+                        const real_t mr = xr[0] - xr[2], mi = xi[0] - xi[2];
+                        const real_t qr = xr[1] + xr[3], qi = xi[1] + xi[3];
+                        const real_t nr = -d * (xi[1] - xi[3]);
+                        const real_t ni = d * (xr[1] - xr[3]);
+                        a_re[0] = pr + qr;
+                        a_im[0] = pi + qi;
+                        a_re[L] = mr + nr;
+                        a_im[L] = mi + ni;
+                        a_re[2 * L] = pr - qr;
+                        a_im[2 * L] = pi - qi;
+                        a_re[3 * L] = mr - nr;
+                        a_im[3 * L] = mi - ni;
+                        break;
+                    }
+                    case 5:
+                    {
+                        // pairs of outputs k and 5 - k share their sums and
+                        // differences
+                        const real_t a1r = xr[1] + xr[4], a1i = xi[1] + xi[4];
+                        const real_t b1r = xr[1] - xr[4], b1i = xi[1] - xi[4];
+                        const real_t a2r = xr[2] + xr[3], a2i = xi[2] + xi[3];
+                        const real_t b2r = xr[2] - xr[3], b2i = xi[2] - xi[3];
+
+                        const real_t m1r = xr[0] + c5_1 * a1r + c5_2 * a2r;
+                        const real_t m1i = xi[0] + c5_1 * a1i + c5_2 * a2i;
+                        const real_t n1r = -(s5_1 * b1i + s5_2 * b2i);
+                        const real_t n1i = s5_1 * b1r + s5_2 * b2r;
+
+                        const real_t m2r = xr[0] + c5_2 * a1r + c5_1 * a2r;
+                        const real_t m2i = xi[0] + c5_2 * a1i + c5_1 * a2i;
+                        const real_t n2r = -(s5_2 * b1i - s5_1 * b2i);
+                        const real_t n2i = s5_2 * b1r - s5_1 * b2r;
+
+                        a_re[0] = xr[0] + a1r + a2r;
+                        a_im[0] = xi[0] + a1i + a2i;
+                        a_re[L] = m1r + n1r;
+                        a_im[L] = m1i + n1i;
+                        a_re[2 * L] = m2r + n2r;
+                        a_im[2 * L] = m2i + n2i;
+                        a_re[3 * L] = m2r - n2r;
+                        a_im[3 * L] = m2i - n2i;
+                        a_re[4 * L] = m1r - n1r;
+                        a_im[4 * L] = m1i - n1i;
+                        break;
+                    }
+                    default:
+                    {
+                        // Odd radices as radix 5: outputs q and r - q share
+                        // the sums and differences of inputs j and r - j
+                        const std::size_t h = r / 2;
+                        real_t ar[3], ai[3], br[3], bi[3];
+                        real_t y0r = xr[0], y0i = xi[0];
+                        for (std::size_t j = 1; j <= h; ++j)
+                        {
+                            ar[j - 1] = xr[j] + xr[r - j];
+                            ai[j - 1] = xi[j] + xi[r - j];
+                            br[j - 1] = xr[j] - xr[r - j];
+                            bi[j - 1] = xi[j] - xi[r - j];
+                            y0r += ar[j - 1];
+                            y0i += ai[j - 1];
+                        }
+                        a_re[0] = y0r;
+                        a_im[0] = y0i;
+
+                        for (std::size_t q = 1; q <= h; ++q)
+                        {
+                            real_t mr = xr[0], mi = xi[0];
+                            real_t nr = 0.0, ni = 0.0;
+                            for (std::size_t j = 1; j <= h; ++j)
+                            {
+                                const std::size_t m = (j * q) % r;
+                                mr += this->root_re[m] * ar[j - 1];
+                                mi += this->root_re[m] * ai[j - 1];
+                                nr -= this->root_im[m] * bi[j - 1];
+                                ni += this->root_im[m] * br[j - 1];
+                            }
+                            a_re[q * L] = mr + nr;
+                            a_im[q * L] = mi + ni;
+                            a_re[(r - q) * L] = mr - nr;
+                            a_im[(r - q) * L] = mi - ni;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        tw_re += L * (r - 1);
+        tw_im += L * (r - 1);
+        L *= r;
+    }
 }
 
+/**
+ * @brief Performs an unnormalized transform of length N in place with
+ *        Bluestein's algorithm. The convolution is done in a line of length M
+ *        kept by each thread, so that several threads can share the plan.
+ *
+ * @param re The real part of the N values to transform
+ * @param im The imaginary part of the N values to transform
+ */
+void FFT::Plan::_bluestein(real_t* re, real_t* im) const
+{
+    const std::size_t N = this->N, M = this->M;
+
+    static thread_local std::vector<real_t> a_re, a_im;
+    if (a_re.size() < M)
+    {
+        a_re.resize(M);
+        a_im.resize(M);
+    }
+
+    // a(n) = x(n) b(n), padded with zeros
+    for (std::size_t n = 0; n < N; ++n)
+    {
+        const real_t br = this->chirp_re[n], bi = this->chirp_im[n];
+        a_re[n] = re[n] * br - im[n] * bi;
+        a_im[n] = re[n] * bi + im[n] * br;
+    }
+    std::fill(a_re.begin() + N, a_re.begin() + M, 0.0);
+    std::fill(a_im.begin() + N, a_im.begin() + M, 0.0);
+
+    this->_power_of_2(a_re.data(), a_im.data());
+
+    // Multiplied by the kernel and conjugated, so that the forward transform
+    // gives the conjugate of the inverse one
+    for (std::size_t m = 0; m < M; ++m)
+    {
+        const real_t kr = this->kernel_re[m], ki = this->kernel_im[m];
+        const real_t ar = a_re[m], ai = a_im[m];
+        a_re[m] = ar * kr - ai * ki;
+        a_im[m] = -(ar * ki + ai * kr);
+    }
+
+    this->_power_of_2(a_re.data(), a_im.data());
+
+    // X(k) = b(k) conv(k), conjugating the convolution back
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        const real_t br = this->chirp_re[k], bi = this->chirp_im[k];
+        const real_t cr = a_re[k], ci = -a_im[k];
+        re[k] = cr * br - ci * bi;
+        im[k] = cr * bi + ci * br;
+    }
+}
+//-----------------------------------------
+
+
+/**********************************************************
+REAL PLAN
+***********************************************************/
+
+/**
+ * @brief Constructor for an empty RealPlan, which transforms nothing
+ *
+ */
+FFT::RealPlan::RealPlan()
+{
+    this->N = 0;
+}
+
+/**
+ * @brief Constructor for RealPlan
+ *
+ * @param N Number of real samples, at least 1
+ */
+FFT::RealPlan::RealPlan(const std::size_t N)
+{
+    this->N = N;
+
+    const std::size_t L = this->line_size();
+    this->line_fwd = FFT::Plan(L, FFT::FFT_Dir::FFT);
+    this->line_inv = FFT::Plan(L, FFT::FFT_Dir::iFFT);
+
+    if (N % 2 == 0)
+    {
+        const std::size_t M = N / 2;
+        this->w_re.resize(M + 1);
+        this->w_im.resize(M + 1);
+        for (std::size_t k = 0; k <= M; ++k)
+        {
+            const double theta = 2.0 * M_PI * double(k) / double(N);
+            this->w_re[k] = cos(theta);
+            this->w_im[k] = sin(theta);
+        }
+    }
+
+    this->z_re.resize(L);
+    this->z_im.resize(L);
+}
+
+/**
+ * @brief Fourier transforms N real samples into the N/2 + 1 complex values
+ *        that determine the whole spectrum, the rest being their complex
+ *        conjugates
+ *
+ * @param data The N real samples
+ * @param spec_re Set to the real part of the N/2 + 1 spectral values
+ * @param spec_im Set to the imaginary part of the N/2 + 1 spectral values
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan::r2c(const real_t* data, real_t* spec_re, real_t* spec_im)
+{
+    return this->r2c(data, spec_re, spec_im,
+                     this->z_re.data(), this->z_im.data());
+}
+
+/**
+ * @brief Fourier transforms N real samples, as r2c above, working in the
+ *        scratch lines given rather than in the plan's own
+ *
+ * @param data The N real samples
+ * @param spec_re Set to the real part of the N/2 + 1 spectral values
+ * @param spec_im Set to the imaginary part of the N/2 + 1 spectral values
+ * @param line_re Scratch of line_size() values
+ * @param line_im Scratch of line_size() values
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan::r2c(const real_t* data, real_t* spec_re, real_t* spec_im,
+                       real_t* line_re, real_t* line_im) const
+{
+    const std::size_t M = this->N / 2;
+    int err = 0;
+
+    if (this->N % 2)
+    {
+        // No halves to pack, so the samples are transformed as a complex
+        // line with no imaginary part
+        std::copy(data, data + this->N, line_re);
+        std::fill(line_im, line_im + this->N, 0.0);
+
+        err = this->line_fwd.execute(line_re, line_im);
+        std::copy(line_re, line_re + M + 1, spec_re);
+        std::copy(line_im, line_im + M + 1, spec_im);
+
+        return err;
+    }
+
+    for (std::size_t m = 0; m < M; ++m)
+    {
+        line_re[m] = data[2 * m];
+        line_im[m] = data[2 * m + 1];
+    }
+
+    err = this->line_fwd.execute(line_re, line_im);
+    if (err)
+    {
+        return err;
+    }
+
+    // With Z = E + iO, E and O the transforms of the even and odd samples:
+    // E(k) = (Z(k) + Z*(M-k)) / 2, O(k) = -i (Z(k) - Z*(M-k)) / 2 and
+    // X(k) = E(k) + w^k O(k)
+    for (std::size_t k = 0; k <= M; ++k)
+    {
+        const std::size_t a = (k == M) ? 0 : k;
+        const std::size_t b = (k == 0) ? 0 : M - k;
+
+        const double er = 0.5 * (double(line_re[a]) + line_re[b]);
+        const double ei = 0.5 * (double(line_im[a]) - line_im[b]);
+        const double o_r = 0.5 * (double(line_im[a]) + line_im[b]);
+        const double oi = -0.5 * (double(line_re[a]) - line_re[b]);
+
+        const double wr = this->w_re[k], wi = this->w_im[k];
+        spec_re[k] = er + wr * o_r - wi * oi;
+        spec_im[k] = ei + wr * oi + wi * o_r;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Inverse of r2c: rebuilds N real samples from the N/2 + 1 spectral
+ *        values, including the 1/N normalization. The imaginary parts of the
+ *        zero mode and, for even N, the N/2 mode, which are zero for the
+ *        spectrum of real samples, are ignored.
+ *
+ * @param spec_re The real part of the N/2 + 1 spectral values
+ * @param spec_im The imaginary part of the N/2 + 1 spectral values
+ * @param data Set to the N real samples
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan::c2r(const real_t* spec_re, const real_t* spec_im,
+                       real_t* data)
+{
+    return this->c2r(spec_re, spec_im, data,
+                     this->z_re.data(), this->z_im.data());
+}
+
+/**
+ * @brief Inverse of r2c, as c2r above, working in the scratch lines given
+ *        rather than in the plan's own
+ *
+ * @param spec_re The real part of the N/2 + 1 spectral values
+ * @param spec_im The imaginary part of the N/2 + 1 spectral values
+ * @param data Set to the N real samples
+ * @param line_re Scratch of line_size() values
+ * @param line_im Scratch of line_size() values
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan::c2r(const real_t* spec_re, const real_t* spec_im,
+                       real_t* data, real_t* line_re, real_t* line_im) const
+{
+    const std::size_t M = this->N / 2;
+    int err = 0;
+
+    if (this->N % 2)
+    {
+        // The rest of the spectrum is the complex conjugate of the values
+        // given, X(N - k) = X*(k)
+        line_re[0] = spec_re[0];
+        line_im[0] = 0.0;
+        for (std::size_t k = 1; k <= M; ++k)
+        {
+            line_re[k] = spec_re[k];
+            line_im[k] = spec_im[k];
+            line_re[this->N - k] = spec_re[k];
+            line_im[this->N - k] = -spec_im[k];
+        }
+
+        err = this->line_inv.execute(line_re, line_im);
+        std::copy(line_re, line_re + this->N, data);
+
+        return err;
+    }
+
+    // E(k) = (X(k) + X*(M-k)) / 2, O(k) = w^-k (X(k) - X*(M-k)) / 2 and the
+    // line to inverse transform is Z = E + iO
+    for (std::size_t k = 0; k < M; ++k)
+    {
+        const double xr = spec_re[k];
+        const double xi = (k == 0) ? 0.0 : double(spec_im[k]);
+        const double yr = spec_re[M - k];
+        const double yi = (k == 0) ? 0.0 : -double(spec_im[M - k]);
+
+        const double er = 0.5 * (xr + yr), ei = 0.5 * (xi + yi);
+        const double dr = 0.5 * (xr - yr), di = 0.5 * (xi - yi);
+
+        const double wr = this->w_re[k], wi = this->w_im[k];
+        const double o_r = dr * wr + di * wi;
+        const double oi = di * wr - dr * wi;
+
+        line_re[k] = er - oi;
+        line_im[k] = ei + o_r;
+    }
+
+    err = this->line_inv.execute(line_re, line_im);
+    if (err)
+    {
+        return err;
+    }
+
+    for (std::size_t m = 0; m < M; ++m)
+    {
+        data[2 * m] = line_re[m];
+        data[2 * m + 1] = line_im[m];
+    }
+
+    return 0;
+}
+//-----------------------------------------
+
+
+/**********************************************************
+REAL PLAN 2D
+***********************************************************/
+
+/**
+ * @brief Constructor for an empty RealPlan_2D, which transforms nothing
+ *
+ */
+FFT::RealPlan_2D::RealPlan_2D()
+{
+    this->Nx = 0;
+    this->Ny = 0;
+    this->n_threads = 0;
+}
+
+/**
+ * @brief Constructor for RealPlan_2D
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ */
+FFT::RealPlan_2D::RealPlan_2D(const std::size_t Nx, const std::size_t Ny)
+{
+    this->Nx = Nx;
+    this->Ny = Ny;
+    this->n_threads = 0;
+
+    this->rows = FFT::RealPlan(Ny);
+    this->cols_fwd = FFT::Plan(Nx, FFT::FFT_Dir::FFT);
+    this->cols_inv = FFT::Plan(Nx, FFT::FFT_Dir::iFFT);
+    this->rows_inv = FFT::Plan(Ny, FFT::FFT_Dir::iFFT);
+
+    this->work_re.resize(Nx * (Ny / 2 + 1));
+    this->work_im.resize(Nx * (Ny / 2 + 1));
+}
+
+/**
+ * @brief Performs a 2D Fourier transform of a real grid
+ *
+ * @param data The Nx by Ny real grid to FFT
+ * @param spec_re Set to the real part of the transposed spectrum, an
+ *                Ny/2 + 1 by Nx grid
+ * @param spec_im Set to the imaginary part of the transposed spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan_2D::r2c(const GridObject& data,
+                          GridObject& spec_re, GridObject& spec_im)
+{
+    int err = 0;
+
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t L = this->rows.line_size();
+    const std::size_t Nh = this->Ny / 2 + 1;
+
+    if (std::size_t(data.get_Nx()) != this->Nx ||
+        std::size_t(data.get_Ny()) != this->Ny)
+    {
+        return 1;
+    }
+    if (std::size_t(spec_re.get_Nx()) != Nh ||
+        std::size_t(spec_re.get_Ny()) != this->Nx)
+    {
+        spec_re = GridObject(Nh, this->Nx);
+        spec_im = GridObject(Nh, this->Nx);
+    }
+
+    this->_reserve_lines(nt);
+
+    #pragma omp parallel for num_threads(nt) schedule(static) reduction(|:err)
+    for (std::size_t xi = 0; xi < this->Nx; ++xi)
+    {
+        const std::size_t line = Threads::thread_id() * L;
+        err |= this->rows.r2c(&data.gridded_data(xi, 0),
+                              &this->work_re[xi * Nh],
+                              &this->work_im[xi * Nh],
+                              &this->line_re[line], &this->line_im[line]);
+    }
+    if (err)
+    {
+        return err;
+    }
+
+    real_t* s_re = &spec_re.gridded_data(0, 0);
+    real_t* s_im = &spec_im.gridded_data(0, 0);
+
+    if (this->cols_fwd.lanes_vectorized())
+    {
+        err = this->_cols(this->cols_fwd, nt);
+        FFT::transpose(this->work_re.data(), this->Nx, Nh, s_re, nt);
+        FFT::transpose(this->work_im.data(), this->Nx, Nh, s_im, nt);
+        return err;
+    }
+
+    FFT::transpose(this->work_re.data(), this->Nx, Nh, s_re, nt);
+    FFT::transpose(this->work_im.data(), this->Nx, Nh, s_im, nt);
+
+    return this->cols_fwd.execute_many(s_re, s_im, Nh, this->Nx, nt);
+}
+
+/**
+ * @brief Performs the inverse of r2c. The spectrum is used as scratch and is
+ *        overwritten.
+ *
+ * @param spec_re The real part of the transposed spectrum, an Ny/2 + 1 by Nx
+ *                grid
+ * @param spec_im The imaginary part of the transposed spectrum
+ * @param data Set to the Nx by Ny real grid
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan_2D::c2r(GridObject& spec_re, GridObject& spec_im,
+                          GridObject& data)
+{
+    int err = 0;
+
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t L = this->rows.line_size();
+    const std::size_t Nh = this->Ny / 2 + 1;
+
+    if (std::size_t(spec_re.get_Nx()) != Nh ||
+        std::size_t(spec_re.get_Ny()) != this->Nx)
+    {
+        return 1;
+    }
+    if (std::size_t(data.get_Nx()) != this->Nx ||
+        std::size_t(data.get_Ny()) != this->Ny)
+    {
+        data = GridObject(this->Nx, this->Ny);
+    }
+
+    real_t* s_re = &spec_re.gridded_data(0, 0);
+    real_t* s_im = &spec_im.gridded_data(0, 0);
+
+    // x1 first, undoing the last pass of the forward transform
+    if (this->cols_inv.lanes_vectorized())
+    {
+        FFT::transpose(s_re, Nh, this->Nx, this->work_re.data(), nt);
+        FFT::transpose(s_im, Nh, this->Nx, this->work_im.data(), nt);
+        err = this->_cols(this->cols_inv, nt);
+    }
+    else
+    {
+        err = this->cols_inv.execute_many(s_re, s_im, Nh, this->Nx, nt);
+        FFT::transpose(s_re, Nh, this->Nx, this->work_re.data(), nt);
+        FFT::transpose(s_im, Nh, this->Nx, this->work_im.data(), nt);
+    }
+    if (err)
+    {
+        return err;
+    }
+
+    this->_reserve_lines(nt);
+
+    #pragma omp parallel for num_threads(nt) schedule(static) reduction(|:err)
+    for (std::size_t xi = 0; xi < this->Nx; ++xi)
+    {
+        const std::size_t line = Threads::thread_id() * L;
+        err |= this->rows.c2r(&this->work_re[xi * Nh],
+                              &this->work_im[xi * Nh],
+                              &data.gridded_data(xi, 0),
+                              &this->line_re[line], &this->line_im[line]);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Performs the inverse of r2c for two spectra at once. The grids are
+ *        real, so they are taken as the real and imaginary parts of one
+ *        complex grid: its spectrum is A + iB, with the modes left out of
+ *        the half spectra given by Z(-k) = A*(k) + i B*(k), and a single
+ *        complex inverse transform gives both grids. As in c2r, the parts of
+ *        the ky = 0 and Nyquist ky rows that real grids cannot have are
+ *        dropped.
+ *
+ * @param a_re The real part of the first transposed spectrum, an Ny/2 + 1
+ *             by Nx grid
+ * @param a_im The imaginary part of the first transposed spectrum
+ * @param b_re The real part of the second transposed spectrum
+ * @param b_im The imaginary part of the second transposed spectrum
+ * @param data_a Set to the Nx by Ny real grid of the first spectrum
+ * @param data_b Set to the Nx by Ny real grid of the second spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan_2D::c2r_pair(const GridObject& a_re, const GridObject& a_im,
+                               const GridObject& b_re, const GridObject& b_im,
+                               GridObject& data_a, GridObject& data_b)
+{
+    int err = 0;
+
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t Nx = this->Nx, Ny = this->Ny;
+    const std::size_t Nh = Ny / 2 + 1;
+
+    if (std::size_t(a_re.get_Nx()) != Nh ||
+        std::size_t(a_re.get_Ny()) != Nx ||
+        std::size_t(b_re.get_Nx()) != Nh ||
+        std::size_t(b_re.get_Ny()) != Nx)
+    {
+        return 1;
+    }
+    if (std::size_t(data_a.get_Nx()) != Nx ||
+        std::size_t(data_a.get_Ny()) != Ny)
+    {
+        data_a = GridObject(Nx, Ny);
+    }
+    if (std::size_t(data_b.get_Nx()) != Nx ||
+        std::size_t(data_b.get_Ny()) != Ny)
+    {
+        data_b = GridObject(Nx, Ny);
+    }
+    if (this->full_re.size() != Ny * Nx)
+    {
+        this->full_re.resize(Ny * Nx);
+        this->full_im.resize(Ny * Nx);
+    }
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t yj = 0; yj < Nh; ++yj)
+    {
+        const real_t* ar = &a_re.gridded_data(yj, 0);
+        const real_t* ai = &a_im.gridded_data(yj, 0);
+        const real_t* br = &b_re.gridded_data(yj, 0);
+        const real_t* bi = &b_im.gridded_data(yj, 0);
+        real_t* z_re = &this->full_re[yj * Nx];
+        real_t* z_im = &this->full_im[yj * Nx];
+
+        if (yj == 0 || 2 * yj == Ny)
+        {
+            // These rows hold both kx and -kx, so only their Hermitian
+            // parts, (A(kx) + A*(-kx)) / 2, belong to real grids
+            for (std::size_t xi = 0; xi < Nx; ++xi)
+            {
+                const std::size_t xm = (Nx - xi) % Nx;
+                const real_t hr_a = 0.5 * (ar[xi] + ar[xm]);
+                const real_t hi_a = 0.5 * (ai[xi] - ai[xm]);
+                const real_t hr_b = 0.5 * (br[xi] + br[xm]);
+                const real_t hi_b = 0.5 * (bi[xi] - bi[xm]);
+                z_re[xi] = hr_a - hi_b;
+                z_im[xi] = hi_a + hr_b;
+            }
+            continue;
+        }
+
+        // Z(kx, ky) = A + iB, and Z(-kx, -ky) = A* + iB* in row Ny - ky
+        real_t* m_re = &this->full_re[(Ny - yj) * Nx];
+        real_t* m_im = &this->full_im[(Ny - yj) * Nx];
+        for (std::size_t xi = 0; xi < Nx; ++xi)
+        {
+            const std::size_t xm = (Nx - xi) % Nx;
+            z_re[xi] = ar[xi] - bi[xi];
+            z_im[xi] = ai[xi] + br[xi];
+            m_re[xm] = ar[xi] + bi[xi];
+            m_im[xm] = br[xi] - ai[xi];
+        }
+    }
+
+    // x1 first, then the rows after a transpose straight into the grids
+    err = this->cols_inv.execute_many(this->full_re.data(),
+                                      this->full_im.data(), Ny, Nx, nt);
+    if (err)
+    {
+        return err;
+    }
+
+    real_t* out_a = &data_a.gridded_data(0, 0);
+    real_t* out_b = &data_b.gridded_data(0, 0);
+
+    FFT::transpose(this->full_re.data(), Ny, Nx, out_a, nt);
+    FFT::transpose(this->full_im.data(), Ny, Nx, out_b, nt);
+
+    return this->rows_inv.execute_many(out_a, out_b, Nx, Ny, nt);
+}
+
+/**
+ * @brief Transforms the x1 direction of the half spectrum before its
+ *        transpose, where the x2 modes of one x1 mode are contiguous. The
+ *        columns are done in blocks of COL_BLOCK side by side, one per vector
+ *        lane, and the blocks are shared out between the threads.
+ *
+ * @param plan The plan of the x1 direction
+ * @param nt Number of threads
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::RealPlan_2D::_cols(const FFT::Plan& plan, const int nt)
+{
+    int err = 0;
+
+    const std::size_t Nh = this->Ny / 2 + 1;
+    const std::size_t block = RealPlan_2D::COL_BLOCK;
+    const std::size_t n_blocks = (Nh + block - 1) / block;
+    real_t* re = this->work_re.data();
+    real_t* im = this->work_im.data();
+
+    #pragma omp parallel for num_threads(nt) schedule(static) reduction(|:err)
+    for (std::size_t b = 0; b < n_blocks; ++b)
+    {
+        const std::size_t first = b * block;
+        err |= plan.execute_lanes(re + first, im + first,
+                                  std::min(block, Nh - first), Nh);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Makes sure there is a scratch line for each thread of the row
+ *        transforms. The lines are kept, so this only allocates when the
+ *        number of threads grows.
+ *
+ * @param nt Number of threads
+ */
+void FFT::RealPlan_2D::_reserve_lines(const int nt)
+{
+    const std::size_t size = std::size_t(nt) * this->rows.line_size();
+    if (this->line_re.size() < size)
+    {
+        this->line_re.resize(size);
+        this->line_im.resize(size);
+    }
+}
+//-----------------------------------------
+
+
+/**********************************************************
+TRANSPOSE
+***********************************************************/
+
+/**
+ * @brief Transposes a row-major matrix into another. The matrix is walked in
+ *        square blocks small enough that the rows of a block being read and
+ *        the rows of the block being written all stay in cache. Within a
+ *        block the writes are contiguous: the output rows are a power of 2
+ *        long in the FFTs, and reading across them would map every element of
+ *        a block column to the same cache set.
+ *
+ * @param in The rows by cols matrix to transpose
+ * @param rows Number of rows of in
+ * @param cols Number of columns of in
+ * @param out Set to the cols by rows transpose of in
+ * @param n_threads Number of threads sharing out the blocks of rows of out
+ */
+void FFT::transpose(const real_t* in, const std::size_t rows,
+                    const std::size_t cols, real_t* out, const int n_threads)
+{
+    const std::size_t block = 32;
+
+    #pragma omp parallel for num_threads(n_threads) schedule(static)
+    for (std::size_t jb = 0; jb < cols; jb += block)
+    {
+        const std::size_t j_end = std::min(jb + block, cols);
+        for (std::size_t ib = 0; ib < rows; ib += block)
+        {
+            const std::size_t i_end = std::min(ib + block, rows);
+            for (std::size_t j = jb; j < j_end; ++j)
+            {
+                for (std::size_t i = ib; i < i_end; ++i)
+                {
+                    out[j * rows + i] = in[i * cols + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Transposes a row-major matrix into another as above, multiplying
+ *        every value by a factor on the way
+ *
+ * @param in The rows by cols matrix to transpose
+ * @param rows Number of rows of in
+ * @param cols Number of columns of in
+ * @param out Set to scale times the cols by rows transpose of in
+ * @param scale Factor multiplying every value
+ * @param n_threads Number of threads sharing out the blocks of rows of out
+ */
+void FFT::transpose(const real_t* in, const std::size_t rows,
+                    const std::size_t cols, real_t* out, const real_t scale,
+                    const int n_threads)
+{
+    const std::size_t block = 32;
+
+    #pragma omp parallel for num_threads(n_threads) schedule(static)
+    for (std::size_t jb = 0; jb < cols; jb += block)
+    {
+        const std::size_t j_end = std::min(jb + block, cols);
+        for (std::size_t ib = 0; ib < rows; ib += block)
+        {
+            const std::size_t i_end = std::min(ib + block, rows);
+            for (std::size_t j = jb; j < j_end; ++j)
+            {
+                for (std::size_t i = ib; i < i_end; ++i)
+                {
+                    out[j * rows + i] = scale * in[i * cols + j];
+                }
+            }
+        }
+    }
+}
+//-----------------------------------------
+
+
+/**********************************************************
+ONE-OFF TRANSFORMS
+***********************************************************/
+
+/**
+ * @brief Performs a 1D (inverse) Fourier transform of a grid
+ *
+ * @param data_re The real part of the grid to (i)FFT
+ * @param data_im The imaginary part of the grid to (i)FFT
+ * @param isign Whether to perform an FFT or an IFFT
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFT_1D(std::vector<real_t>& data_re, std::vector<real_t>& data_im,
+                FFT::FFT_Dir isign)
+{
+    const FFT::Plan plan(data_re.size(), isign);
+
+    return plan.execute(data_re, data_im);
+}
+
+/**
+ * @brief Performs a 2D (inverse) Fourier transform of a grid
+ *
+ * @param real_part The real part of the grid to (i)FFT
+ * @param imag_part The imaginary part of the grid to (i)FFT
+ * @param transform_dir Whether to perform an FFT or an IFFT
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFT_2D(GridObject& real_part, GridObject& imag_part,
+                FFT::FFT_Dir transform_dir)
+{
+    int err = 0;
+
+    // assumes real_part and im_part are the same size!
+    const std::size_t Nx = real_part.get_Nx();
+    const std::size_t Ny = real_part.get_Ny();
+
+    const FFT::Plan row_plan(Ny, transform_dir);
+    const FFT::Plan col_plan(Nx, transform_dir);
+
+    const int nt = Threads::resolve(0);
+
+    real_t* re = &real_part.gridded_data(0, 0);
+    real_t* im = &imag_part.gridded_data(0, 0);
+
+    // spectral solve: Fourier transform rows, then columns, which are
+    // transposed into rows and back
+    err = row_plan.execute_many(re, im, Nx, Ny, nt);
+    if (err)
+    {
+        return err;
+    }
+
+    std::vector<real_t> t_re(Nx * Ny), t_im(Nx * Ny);
+    FFT::transpose(re, Nx, Ny, t_re.data(), nt);
+    FFT::transpose(im, Nx, Ny, t_im.data(), nt);
+
+    err = col_plan.execute_many(t_re.data(), t_im.data(), Ny, Nx, nt);
+    if (err)
+    {
+        return err;
+    }
+
+    FFT::transpose(t_re.data(), Ny, Nx, re, nt);
+    FFT::transpose(t_im.data(), Ny, Nx, im, nt);
+
+    return err;
+}
+
+/**
+ * @brief Performs a 1D Fourier transform of real data, keeping only the
+ *        N/2 + 1 non-redundant values of the spectrum
+ *
+ * @param data The N real samples
+ * @param spec_re Set to the real part of the spectrum
+ * @param spec_im Set to the imaginary part of the spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFT_1D_r2c(const std::vector<real_t>& data,
+                    std::vector<real_t>& spec_re, std::vector<real_t>& spec_im)
+{
+    const std::size_t N = data.size();
+    FFT::RealPlan plan(N);
+
+    spec_re.resize(N / 2 + 1);
+    spec_im.resize(N / 2 + 1);
+
+    return plan.r2c(data.data(), spec_re.data(), spec_im.data());
+}
+
+/**
+ * @brief Performs the inverse of FFT_1D_r2c, for an even number of samples
+ *
+ * @param spec_re The real part of the N/2 + 1 values of the spectrum
+ * @param spec_im The imaginary part of the N/2 + 1 values of the spectrum
+ * @param data Set to the N real samples
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFT_1D_c2r(const std::vector<real_t>& spec_re,
+                    const std::vector<real_t>& spec_im,
+                    std::vector<real_t>& data)
+{
+    if (spec_re.empty())
+    {
+        return 1;
+    }
+
+    const std::size_t N = 2 * (spec_re.size() - 1);
+    FFT::RealPlan plan(N);
+
+    data.resize(N);
+
+    return plan.c2r(spec_re.data(), spec_im.data(), data.data());
+}
+
+/**
+ * @brief Performs a 2D Fourier transform of a real grid, see RealPlan_2D
+ *
+ * @param data The Nx by Ny real grid to FFT
+ * @param spec_re Set to the real part of the transposed spectrum, an
+ *                Ny/2 + 1 by Nx grid
+ * @param spec_im Set to the imaginary part of the transposed spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFT_2D_r2c(const GridObject& data,
+                    GridObject& spec_re, GridObject& spec_im)
+{
+    FFT::RealPlan_2D plan(data.get_Nx(), data.get_Ny());
+
+    return plan.r2c(data, spec_re, spec_im);
+}
+
+/**
+ * @brief Performs the inverse of FFT_2D_r2c. The spectrum is overwritten.
+ *
+ * @param spec_re The real part of the transposed spectrum, an Ny/2 + 1 by Nx
+ *                grid
+ * @param spec_im The imaginary part of the transposed spectrum
+ * @param data Set to the Nx by Ny real grid. It must already be Nx by Ny.
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFT_2D_c2r(GridObject& spec_re, GridObject& spec_im,
+                    GridObject& data)
+{
+    FFT::RealPlan_2D plan(data.get_Nx(), data.get_Ny());
+
+    return plan.c2r(spec_re, spec_im, data);
+}
+//-----------------------------------------
+
+
+/**
+ * @brief Computes the wavenumbers of the modes of a transform, in the order
+ *        of the spectrum: 2 pi i / (size dx) for the first (size + 1) / 2
+ *        modes and the negative ones after. For even sizes the size/2 mode
+ *        is counted as negative, -pi / dx.
+ *
+ * @param size Number of grid points
+ * @param dx Grid spacing
+ * @return std::vector<double> The wavenumber of every mode
+ */
 std::vector<double> FFT::get_k_vec(const std::size_t size, const double dx)
 {
     std::vector<double> k = std::vector<double>(size);
     const double kmax = M_PI / dx;
 
-    //TODO: verify divide by (size/2) and not just size
-    for (std::size_t i = 0; i < size / 2; ++i)
+    // k = 2 pi i / (size dx) = kmax i / (size / 2), with size / 2 kept as a
+    // real number so that odd sizes are right too
+    const double half = 0.5 * size;
+    const std::size_t n_pos = (size + 1) / 2;
+    for (std::size_t i = 0; i < n_pos; ++i)
     {
-        k[i] = kmax * i / (size / 2);
+        k[i] = kmax * i / half;
     }
-    for (std::size_t i = size / 2; i < size; ++i)
+    for (std::size_t i = n_pos; i < size; ++i)
     {
-        k[i] = kmax * i / (size / 2) - 2 * kmax;
+        k[i] = kmax * i / half - 2 * kmax;
     }
 
     return k;
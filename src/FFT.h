@@ -4,7 +4,8 @@
 *   FFT Header file, based on code from www.codeproject.com, originally    *
 *   based on code from Numerical Recipes with refinement in speed.         *
 *   Added functionality to load in complex and real arrays          	   *
-*   separately. This requires a number of values which is a power of 2.    *
+*   separately. Lengths are no longer limited to powers of 2: they are     *
+*   factored into radices 2, 3, 4, 5 and 7, or else done by Bluestein.     *
 *   This version is also normalized so that the 1/N is taken into account. *
 *   AGRT 2010                                                              *
 *                                                                          *
@@ -12,11 +13,14 @@
 
     data_re -> float array that represent the real array of complex samples
     data_im -> float array that represent the imag array of complex samples
-    NVALS -> length of real or imaginary arrays (N^2 order number)
+    NVALS -> length of real or imaginary arrays
     isign -> 1 to calculate FFT and -1 to calculate Reverse FFT
 
-    The function returns an integer, 1 if FFT ran, 0 otherwise. It will be
-    zero if NVALS is not a power of 2
+    The function returns an integer, 0 if FFT ran, 1 otherwise. It will be
+    one if NVALS is 0 or does not match the plan
+
+    Code that transforms many lines of the same size, every step, should make
+    an FFT::Plan (or RealPlan, RealPlan_2D) once and reuse it.
 */
 
 #ifndef FFT_H
@@ -26,6 +30,8 @@
 #include <cmath>
 
 #include "GridObject.h"
+#include "Precision.h"
+#include "Threads.h"
 
 namespace FFT
 {
@@ -35,14 +41,277 @@ namespace FFT
         iFFT = -1
     };
 
+    /**
+     * @brief A complex 1D transform of one length in one direction. The
+     *        permutation and the twiddles are computed once, when the plan is
+     *        made, so that transforming many lines of the same length only
+     *        does the butterflies. The real and imaginary parts are kept in
+     *        separate arrays throughout.
+     *
+     *        Powers of 2 use radix-4 butterflies, after one radix-2 stage for
+     *        odd powers. Other lengths whose only prime factors are 2, 3, 5
+     *        and 7 use mixed-radix butterflies. Any other length is done by
+     *        Bluestein's algorithm, as a convolution computed with power of 2
+     *        transforms of at least twice the length.
+     *
+     *        The butterflies of a stage are independent, so the loops over
+     *        them are vectorized. execute_lanes transforms several lines
+     *        stored side by side, one per vector lane, which keeps the
+     *        vectors full in the first stages too.
+     *
+     */
+    class Plan
+    {
+        private:
+            enum Algorithm
+            {
+                None,
+                Power_Of_2,
+                Mixed_Radix,
+                Bluestein
+            };
+
+            std::size_t N;
+            FFT::FFT_Dir dir;
+            Plan::Algorithm algorithm;
+
+            // Length of the power of 2 transforms: N, or the padded length
+            // of the Bluestein convolution, and their direction
+            std::size_t M;
+            FFT::FFT_Dir w_dir;
+
+            // Pairs of indices swapped by the bit-reversal permutation
+            std::vector<std::size_t> swaps;
+
+            // Whether M is an odd power of 2, which starts with a radix-2
+            // stage
+            bool radix_2_first;
+
+            // Twiddles t, t^2 and t^3, t = exp(w_dir i pi k / 2h), of every
+            // radix-4 stage joining transforms of length h, stored one stage
+            // after the other as h values of each power
+            std::vector<real_t> w_re, w_im;
+
+            // Mixed radix: the radix of every stage, the cycles of the
+            // digit-reversal permutation stored one after the other, where
+            // each cycle ends and the r - 1 twiddles of every butterfly
+            std::vector<std::size_t> radices;
+            std::vector<std::size_t> cycles, cycle_ends;
+            std::vector<real_t> t_re, t_im;
+
+            // Roots of unity of the radices without their own butterflies
+            std::vector<real_t> root_re, root_im;
+
+            // Bluestein: the chirp exp(dir i pi n^2 / N) and the transform of
+            // its conjugate, divided by M
+            std::vector<real_t> chirp_re, chirp_im;
+            std::vector<real_t> kernel_re, kernel_im;
+
+            /**********************************************************
+            PRIVATE CLASS METHODS
+            ***********************************************************/
+            void _plan_power_of_2(const std::size_t len, const FFT::FFT_Dir d);
+            void _plan_mixed_radix();
+            void _plan_bluestein();
+
+            void _power_of_2(real_t* re, real_t* im) const;
+            void _power_of_2_lanes(real_t* re, real_t* im,
+                                   const std::size_t lanes,
+                                   const std::size_t stride) const;
+            void _mixed_radix(real_t* re, real_t* im) const;
+            void _bluestein(real_t* re, real_t* im) const;
+            //-----------------------------------------
+
+        public:
+            /**********************************************************
+            CONSTRUCTORS/DESTRUCTORS
+            ***********************************************************/
+            Plan();
+            Plan(const std::size_t N, const FFT::FFT_Dir dir);
+            //-----------------------------------------
+
+
+            /**********************************************************
+            CLASS METHODS
+            ***********************************************************/
+            int execute(real_t* re, real_t* im) const;
+            int execute(std::vector<real_t>& re,
+                        std::vector<real_t>& im) const;
+            int execute_many(real_t* re, real_t* im,
+                             const std::size_t howmany,
+                             const std::size_t dist,
+                             const int n_threads) const;
+            int execute_lanes(real_t* re, real_t* im,
+                              const std::size_t lanes,
+                              const std::size_t stride) const;
+
+            inline std::size_t size() const
+            {
+                return this->N;
+            }
+
+            // Whether execute_lanes does the lines together in vector lanes
+            // rather than one at a time
+            inline bool lanes_vectorized() const
+            {
+                return this->algorithm == Plan::Algorithm::Power_Of_2;
+            }
+            //-----------------------------------------
+    };
+
+    /**
+     * @brief Transforms of real data of one length, in both directions. The
+     *        forward transform keeps only the N/2 + 1 non-redundant values of
+     *        the spectrum, and the inverse rebuilds the data from them. For
+     *        even N the even and odd samples are packed into a complex line
+     *        of length N/2, so the work is done by complex plans of half the
+     *        length. Odd N are transformed as complex lines of length N.
+     *
+     */
+    class RealPlan
+    {
+        private:
+            std::size_t N;
+
+            // Complex plans of length line_size()
+            FFT::Plan line_fwd, line_inv;
+
+            // Twiddles exp(2 pi i k / N), k = 0..N/2, that separate the even
+            // and odd halves
+            std::vector<real_t> w_re, w_im;
+
+            // Complex line of length line_size()
+            std::vector<real_t> z_re, z_im;
+
+        public:
+            /**********************************************************
+            CONSTRUCTORS/DESTRUCTORS
+            ***********************************************************/
+            RealPlan();
+            RealPlan(const std::size_t N);
+            //-----------------------------------------
+
+
+            /**********************************************************
+            CLASS METHODS
+            ***********************************************************/
+            int r2c(const real_t* data, real_t* spec_re, real_t* spec_im);
+            int c2r(const real_t* spec_re, const real_t* spec_im,
+                    real_t* data);
+
+            // With scratch lines of line_size() values from the caller, so
+            // that several threads can share the plan
+            int r2c(const real_t* data, real_t* spec_re, real_t* spec_im,
+                    real_t* line_re, real_t* line_im) const;
+            int c2r(const real_t* spec_re, const real_t* spec_im,
+                    real_t* data, real_t* line_re, real_t* line_im) const;
+
+            inline std::size_t size() const
+            {
+                return this->N;
+            }
+
+            inline std::size_t line_size() const
+            {
+                return (this->N % 2) ? this->N : this->N / 2;
+            }
+            //-----------------------------------------
+    };
+
+    /**
+     * @brief Transforms of a real Nx by Ny grid, in both directions. The rows
+     *        (the x2 direction) are transformed as real data, so the spectrum
+     *        holds only the Ny/2 + 1 non-negative x2 modes of every x1 mode.
+     *        The x1 direction is transformed around a cache-blocked
+     *        transpose: before it for powers of 2, with blocks of
+     *        neighbouring x2 modes side by side in the vector lanes, and
+     *        after it as contiguous rows otherwise. The spectrum is left
+     *        transposed: it is an Ny/2 + 1 by Nx grid, indexed (x2 mode,
+     *        x1 mode). The lines of each pass are independent and are
+     *        shared out between n_threads threads. Two real grids can be
+     *        rebuilt together, packed as the real and imaginary parts of one
+     *        complex grid, with c2r_pair.
+     *
+     */
+    class RealPlan_2D
+    {
+        private:
+            std::size_t Nx, Ny;
+
+            FFT::RealPlan rows;
+            FFT::Plan cols_fwd, cols_inv;
+
+            // Complex rows for c2r_pair
+            FFT::Plan rows_inv;
+
+            // Half spectrum before the transpose, Nx by Ny/2 + 1
+            std::vector<real_t> work_re, work_im;
+
+            // Number of x1 lines transformed side by side by _cols
+            static const std::size_t COL_BLOCK = 16;
+
+            // Whole spectrum of c2r_pair, Ny by Nx, made on its first call
+            std::vector<real_t> full_re, full_im;
+
+            // Lines for the row transforms, one per thread
+            std::vector<real_t> line_re, line_im;
+
+            /**********************************************************
+            PRIVATE CLASS METHODS
+            ***********************************************************/
+            int _cols(const FFT::Plan& plan, const int nt);
+            void _reserve_lines(const int nt);
+            //-----------------------------------------
+
+        public:
+            std::size_t n_threads;  // 0 uses the OpenMP default
+
+            /**********************************************************
+            CONSTRUCTORS/DESTRUCTORS
+            ***********************************************************/
+            RealPlan_2D();
+            RealPlan_2D(const std::size_t Nx, const std::size_t Ny);
+            //-----------------------------------------
+
+
+            /**********************************************************
+            CLASS METHODS
+            ***********************************************************/
+            int r2c(const GridObject& data,
+                    GridObject& spec_re, GridObject& spec_im);
+            int c2r(GridObject& spec_re, GridObject& spec_im,
+                    GridObject& data);
+            int c2r_pair(const GridObject& a_re, const GridObject& a_im,
+                         const GridObject& b_re, const GridObject& b_im,
+                         GridObject& data_a, GridObject& data_b);
+            //-----------------------------------------
+    };
+
+    void transpose(const real_t* in, const std::size_t rows,
+                   const std::size_t cols, real_t* out, const int n_threads);
+    void transpose(const real_t* in, const std::size_t rows,
+                   const std::size_t cols, real_t* out, const real_t scale,
+                   const int n_threads);
+
     double sinc(const double x);
 
-    int FFT_1D(std::vector<double>& data_re, std::vector<double>& data_im,
+    int FFT_1D(std::vector<real_t>& data_re, std::vector<real_t>& data_im,
                FFT::FFT_Dir isign);
 
     int FFT_2D(GridObject& real_part, GridObject& imag_part,
                FFT::FFT_Dir transform_dir);
 
+    int FFT_1D_r2c(const std::vector<real_t>& data,
+                   std::vector<real_t>& spec_re, std::vector<real_t>& spec_im);
+    int FFT_1D_c2r(const std::vector<real_t>& spec_re,
+                   const std::vector<real_t>& spec_im,
+                   std::vector<real_t>& data);
+
+    int FFT_2D_r2c(const GridObject& data,
+                   GridObject& spec_re, GridObject& spec_im);
+    int FFT_2D_c2r(GridObject& spec_re, GridObject& spec_im,
+                   GridObject& data);
+
     std::vector<double> get_k_vec(const std::size_t size, const double dx);
 
     std::vector<double> get_K2_vec(const std::vector<double>& k, const double dx);
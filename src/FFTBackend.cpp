@@ -0,0 +1,189 @@
+#include "FFTBackend.h"
+
+/**
+ * @brief Checks whether a backend has been built in
+ *
+ * @param backend The backend to check
+ * @return true If the backend can be used
+ * @return false Otherwise
+ */
+bool FFT::has_backend(const FFT::FFT_Backend backend)
+{
+    switch (backend)
+    {
+        case FFT::FFT_Backend::Builtin:
+            return true;
+        case FFT::FFT_Backend::FFTW:
+            return PIC_FFTW;
+        default:
+            return false;
+    }
+}
+
+
+/**********************************************************
+CONSTRUCTORS/DESTRUCTORS
+***********************************************************/
+
+/**
+ * @brief Constructor for an empty Transform_2D, which transforms nothing
+ *
+ */
+FFT::Transform_2D::Transform_2D()
+{
+    this->Nx = 0;
+    this->Ny = 0;
+    this->backend = FFT::FFT_Backend::Builtin;
+    this->n_threads = 0;
+}
+
+/**
+ * @brief Constructor for Transform_2D - plans the transforms with the
+ *        backend
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param backend The library doing the transforms
+ */
+FFT::Transform_2D::Transform_2D(const std::size_t Nx, const std::size_t Ny,
+                                const FFT::FFT_Backend backend)
+{
+    this->Nx = Nx;
+    this->Ny = Ny;
+    this->backend = FFT::FFT_Backend::Builtin;
+    this->n_threads = 0;
+
+    this->set_backend(backend);
+}
+//-----------------------------------------
+
+
+/**********************************************************
+CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Performs a 2D Fourier transform of a real grid, see
+ *        RealPlan_2D::r2c
+ *
+ * @param data The Nx by Ny real grid to FFT
+ * @param spec_re Set to the real part of the transposed spectrum, an
+ *                Ny/2 + 1 by Nx grid
+ * @param spec_im Set to the imaginary part of the transposed spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::Transform_2D::r2c(const GridObject& data,
+                           GridObject& spec_re, GridObject& spec_im)
+{
+    switch (this->backend)
+    {
+#if PIC_FFTW
+        case FFT::FFT_Backend::FFTW:
+            this->fftw.n_threads = this->n_threads;
+            return this->fftw.r2c(data, spec_re, spec_im);
+#endif
+        default:
+            this->builtin.n_threads = this->n_threads;
+            return this->builtin.r2c(data, spec_re, spec_im);
+    }
+}
+
+/**
+ * @brief Performs the inverse of r2c. The spectrum is used as scratch and is
+ *        overwritten.
+ *
+ * @param spec_re The real part of the transposed spectrum, an Ny/2 + 1 by Nx
+ *                grid
+ * @param spec_im The imaginary part of the transposed spectrum
+ * @param data Set to the Nx by Ny real grid
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::Transform_2D::c2r(GridObject& spec_re, GridObject& spec_im,
+                           GridObject& data)
+{
+    switch (this->backend)
+    {
+#if PIC_FFTW
+        case FFT::FFT_Backend::FFTW:
+            this->fftw.n_threads = this->n_threads;
+            return this->fftw.c2r(spec_re, spec_im, data);
+#endif
+        default:
+            this->builtin.n_threads = this->n_threads;
+            return this->builtin.c2r(spec_re, spec_im, data);
+    }
+}
+
+/**
+ * @brief Performs the inverse of r2c for two spectra of real grids at once,
+ *        see RealPlan_2D::c2r_pair. Outputs with several real components
+ *        should be rebuilt in pairs this way.
+ *
+ * @param a_re The real part of the first transposed spectrum, an Ny/2 + 1
+ *             by Nx grid
+ * @param a_im The imaginary part of the first transposed spectrum
+ * @param b_re The real part of the second transposed spectrum
+ * @param b_im The imaginary part of the second transposed spectrum
+ * @param data_a Set to the Nx by Ny real grid of the first spectrum
+ * @param data_b Set to the Nx by Ny real grid of the second spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::Transform_2D::c2r_pair(const GridObject& a_re,
+                                const GridObject& a_im,
+                                const GridObject& b_re,
+                                const GridObject& b_im,
+                                GridObject& data_a, GridObject& data_b)
+{
+    switch (this->backend)
+    {
+#if PIC_FFTW
+        case FFT::FFT_Backend::FFTW:
+            this->fftw.n_threads = this->n_threads;
+            return this->fftw.c2r_pair(a_re, a_im, b_re, b_im,
+                                       data_a, data_b);
+#endif
+        default:
+            this->builtin.n_threads = this->n_threads;
+            return this->builtin.c2r_pair(a_re, a_im, b_re, b_im,
+                                          data_a, data_b);
+    }
+}
+
+/**
+ * @brief Switches to another backend, planning its transforms. The plans of
+ *        the previous backend are dropped.
+ *
+ * @param backend The library doing the transforms
+ */
+void FFT::Transform_2D::set_backend(const FFT::FFT_Backend backend)
+{
+    if (!FFT::has_backend(backend))
+    {
+        throw std::runtime_error(FFT::backend_err);
+    }
+
+    this->backend = backend;
+
+    // Nothing to plan for an empty transform
+    if (this->Nx == 0 || this->Ny == 0)
+    {
+        return;
+    }
+
+    switch (backend)
+    {
+#if PIC_FFTW
+        case FFT::FFT_Backend::FFTW:
+            this->builtin = FFT::RealPlan_2D();
+            this->fftw = FFT::FFTWPlan_2D(this->Nx, this->Ny);
+            break;
+#endif
+        default:
+            this->builtin = FFT::RealPlan_2D(this->Nx, this->Ny);
+#if PIC_FFTW
+            this->fftw = FFT::FFTWPlan_2D();
+#endif
+            break;
+    }
+}
+//-----------------------------------------
@@ -0,0 +1,78 @@
+#ifndef FFTBACKEND_H
+#define FFTBACKEND_H
+
+#include <stdexcept>
+
+#include "FFT.h"
+#include "FFTWPlan.h"
+#include "GridObject.h"
+
+namespace FFT
+{
+    const char backend_err[39] = "Error: FFT backend has not been built";
+
+    // Libraries that can do the 2D transforms of the field solve
+    enum FFT_Backend
+    {
+        Builtin,  // FFT::RealPlan_2D
+        FFTW      // FFT::FFTWPlan_2D, needs a build with PIC_FFTW set to 1
+    };
+
+    const FFT_Backend default_backend = PIC_FFTW ? FFT_Backend::FFTW :
+                                                   FFT_Backend::Builtin;
+
+    bool has_backend(const FFT::FFT_Backend backend);
+
+    /**
+     * @brief Transforms of a real Nx by Ny grid, done by one of the backends.
+     *        Every backend gives the spectrum in the layout of RealPlan_2D,
+     *        so code using the transforms does not depend on the backend. A
+     *        new backend is a class with the same r2c, c2r and c2r_pair, an
+     *        entry in FFT_Backend and a case in each method here.
+     *
+     */
+    class Transform_2D
+    {
+        private:
+            std::size_t Nx, Ny;
+            FFT::FFT_Backend backend;
+
+            FFT::RealPlan_2D builtin;
+#if PIC_FFTW
+            FFT::FFTWPlan_2D fftw;
+#endif
+
+        public:
+            std::size_t n_threads;  // 0 uses the OpenMP default
+
+            /**********************************************************
+            CONSTRUCTORS/DESTRUCTORS
+            ***********************************************************/
+            Transform_2D();
+            Transform_2D(const std::size_t Nx, const std::size_t Ny,
+                         const FFT::FFT_Backend backend);
+            //-----------------------------------------
+
+
+            /**********************************************************
+            CLASS METHODS
+            ***********************************************************/
+            int r2c(const GridObject& data,
+                    GridObject& spec_re, GridObject& spec_im);
+            int c2r(GridObject& spec_re, GridObject& spec_im,
+                    GridObject& data);
+            int c2r_pair(const GridObject& a_re, const GridObject& a_im,
+                         const GridObject& b_re, const GridObject& b_im,
+                         GridObject& data_a, GridObject& data_b);
+
+            void set_backend(const FFT::FFT_Backend backend);
+
+            inline FFT::FFT_Backend get_backend() const
+            {
+                return this->backend;
+            }
+            //-----------------------------------------
+    };
+}
+
+#endif
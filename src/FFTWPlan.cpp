@@ -0,0 +1,415 @@
+#include "FFTWPlan.h"
+
+#if PIC_FFTW
+
+#include <fftw3.h>
+
+#include "FFT.h"
+
+// The FFTW functions and types of the storage precision
+#if PIC_SINGLE_PRECISION
+#define PIC_FFTW_NAME(name) fftwf_##name
+#else
+#define PIC_FFTW_NAME(name) fftw_##name
+#endif
+
+typedef PIC_FFTW_NAME(plan) fftw_plan_t;
+typedef PIC_FFTW_NAME(iodim64) fftw_iodim_t;
+
+namespace
+{
+    // Wisdom is read once, before the first plan, and written after every
+    // new plan. An empty name turns both off.
+    std::string wisdom_file = "pic_fftw.wisdom";
+    bool fftw_started = false;
+
+    void start_fftw()
+    {
+        if (fftw_started)
+        {
+            return;
+        }
+        fftw_started = true;
+
+        PIC_FFTW_NAME(init_threads)();
+        if (!wisdom_file.empty())
+        {
+            PIC_FFTW_NAME(import_wisdom_from_filename)(wisdom_file.c_str());
+        }
+    }
+}
+
+/**
+ * @brief The plans of a 2D transform and the buffer holding the half spectrum
+ *        while they work on it, Nx by Ny/2 + 1 with the imaginary parts after
+ *        the real parts. The rows of the grid are transformed to and from the
+ *        buffer, and its columns in place. The column plans are made for the
+ *        buffer itself, so they can use FFTW's aligned SIMD code.
+ *
+ */
+struct FFT::FFTWPlan_2D::Plans
+{
+    fftw_plan_t rows_fwd, rows_inv, cols_fwd, cols_inv;
+    real_t* buffer;
+
+    Plans() : rows_fwd(nullptr), rows_inv(nullptr),
+              cols_fwd(nullptr), cols_inv(nullptr), buffer(nullptr)
+    {
+    }
+
+    ~Plans()
+    {
+        fftw_plan_t all[4] = {this->rows_fwd, this->rows_inv,
+                              this->cols_fwd, this->cols_inv};
+        for (int p = 0; p < 4; ++p)
+        {
+            if (all[p])
+            {
+                PIC_FFTW_NAME(destroy_plan)(all[p]);
+            }
+        }
+        PIC_FFTW_NAME(free)(this->buffer);
+    }
+
+    bool complete() const
+    {
+        return this->rows_fwd && this->rows_inv &&
+               this->cols_fwd && this->cols_inv;
+    }
+};
+
+
+/**********************************************************
+CONSTRUCTORS/DESTRUCTORS
+***********************************************************/
+
+/**
+ * @brief Constructor for an empty FFTWPlan_2D, which transforms nothing
+ *
+ */
+FFT::FFTWPlan_2D::FFTWPlan_2D()
+{
+    this->Nx = 0;
+    this->Ny = 0;
+    this->planned_threads = 0;
+    this->n_threads = 0;
+}
+
+/**
+ * @brief Constructor for FFTWPlan_2D - measures the plans for the default
+ *        number of threads
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ */
+FFT::FFTWPlan_2D::FFTWPlan_2D(const std::size_t Nx, const std::size_t Ny)
+{
+    this->Nx = Nx;
+    this->Ny = Ny;
+    this->planned_threads = 0;
+    this->n_threads = 0;
+
+    this->_make_plans(Threads::resolve(this->n_threads));
+}
+
+/**
+ * @brief Copy constructor for FFTWPlan_2D - makes plans of its own, which
+ *        the wisdom of the first ones makes quick
+ *
+ * @param copy_obj The plan to copy
+ */
+FFT::FFTWPlan_2D::FFTWPlan_2D(const FFTWPlan_2D& copy_obj)
+{
+    this->Nx = copy_obj.Nx;
+    this->Ny = copy_obj.Ny;
+    this->planned_threads = 0;
+    this->n_threads = copy_obj.n_threads;
+
+    if (copy_obj.plans)
+    {
+        this->_make_plans(copy_obj.planned_threads);
+    }
+}
+
+/**
+ * @brief Move constructor for FFTWPlan_2D - takes over the plans
+ *
+ * @param move_obj The plan to move
+ */
+FFT::FFTWPlan_2D::FFTWPlan_2D(FFTWPlan_2D&& move_obj) noexcept
+    : Nx(move_obj.Nx), Ny(move_obj.Ny),
+      plans(std::move(move_obj.plans)),
+      planned_threads(move_obj.planned_threads),
+      n_threads(move_obj.n_threads)
+{
+    move_obj.planned_threads = 0;
+}
+
+/**
+ * @brief Destructor for FFTWPlan_2D
+ *
+ */
+FFT::FFTWPlan_2D::~FFTWPlan_2D()
+{
+}
+//-----------------------------------------
+
+
+/**********************************************************
+OPERATOR FUNCTIONS
+***********************************************************/
+
+/**
+ * @brief Copy assignment, making plans of its own
+ *
+ * @param to_copy The plan to copy
+ * @return FFT::FFTWPlan_2D& This plan
+ */
+FFT::FFTWPlan_2D& FFT::FFTWPlan_2D::operator=(const FFTWPlan_2D& to_copy)
+{
+    if (this != &to_copy)
+    {
+        FFTWPlan_2D copy(to_copy);
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+/**
+ * @brief Move assignment, taking over the plans
+ *
+ * @param to_move The plan to move
+ * @return FFT::FFTWPlan_2D& This plan
+ */
+FFT::FFTWPlan_2D& FFT::FFTWPlan_2D::operator=(FFTWPlan_2D&& to_move) noexcept
+{
+    this->Nx = to_move.Nx;
+    this->Ny = to_move.Ny;
+    this->plans = std::move(to_move.plans);
+    this->planned_threads = to_move.planned_threads;
+    this->n_threads = to_move.n_threads;
+    to_move.planned_threads = 0;
+
+    return *this;
+}
+//-----------------------------------------
+
+
+/**********************************************************
+CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Performs a 2D Fourier transform of a real grid, see
+ *        RealPlan_2D::r2c
+ *
+ * @param data The Nx by Ny real grid to FFT
+ * @param spec_re Set to the real part of the transposed spectrum, an
+ *                Ny/2 + 1 by Nx grid
+ * @param spec_im Set to the imaginary part of the transposed spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFTWPlan_2D::r2c(const GridObject& data,
+                          GridObject& spec_re, GridObject& spec_im)
+{
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t Nh = this->Ny / 2 + 1;
+
+    if (!this->plans ||
+        std::size_t(data.get_Nx()) != this->Nx ||
+        std::size_t(data.get_Ny()) != this->Ny)
+    {
+        return 1;
+    }
+    if (std::size_t(spec_re.get_Nx()) != Nh ||
+        std::size_t(spec_re.get_Ny()) != this->Nx)
+    {
+        spec_re = GridObject(Nh, this->Nx);
+        spec_im = GridObject(Nh, this->Nx);
+    }
+    if (nt != this->planned_threads)
+    {
+        this->_make_plans(nt);
+    }
+
+    real_t* w_re = this->plans->buffer;
+    real_t* w_im = w_re + this->Nx * Nh;
+
+    // The rows plan does not write to its input
+    PIC_FFTW_NAME(execute_split_dft_r2c)(this->plans->rows_fwd,
+        const_cast<real_t*>(&data.gridded_data(0, 0)), w_re, w_im);
+    PIC_FFTW_NAME(execute)(this->plans->cols_fwd);
+
+    // FFTW transforms forward with exp(-i k x). For real data the spectrum
+    // with exp(+i k x) is its complex conjugate.
+    FFT::transpose(w_re, this->Nx, Nh, &spec_re.gridded_data(0, 0), 1.0, nt);
+    FFT::transpose(w_im, this->Nx, Nh, &spec_im.gridded_data(0, 0), -1.0, nt);
+
+    return 0;
+}
+
+/**
+ * @brief Performs the inverse of r2c, see RealPlan_2D::c2r
+ *
+ * @param spec_re The real part of the transposed spectrum, an Ny/2 + 1 by Nx
+ *                grid
+ * @param spec_im The imaginary part of the transposed spectrum
+ * @param data Set to the Nx by Ny real grid
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFTWPlan_2D::c2r(const GridObject& spec_re,
+                          const GridObject& spec_im, GridObject& data)
+{
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t Nh = this->Ny / 2 + 1;
+
+    if (!this->plans ||
+        std::size_t(spec_re.get_Nx()) != Nh ||
+        std::size_t(spec_re.get_Ny()) != this->Nx)
+    {
+        return 1;
+    }
+    if (std::size_t(data.get_Nx()) != this->Nx ||
+        std::size_t(data.get_Ny()) != this->Ny)
+    {
+        data = GridObject(this->Nx, this->Ny);
+    }
+    if (nt != this->planned_threads)
+    {
+        this->_make_plans(nt);
+    }
+
+    real_t* w_re = this->plans->buffer;
+    real_t* w_im = w_re + this->Nx * Nh;
+
+    // Back to FFTW's sign convention, normalizing on the way. FFTW leaves
+    // the 1/N out.
+    const real_t norm = 1.0 / (double(this->Nx) * double(this->Ny));
+    FFT::transpose(&spec_re.gridded_data(0, 0), Nh, this->Nx, w_re, norm, nt);
+    FFT::transpose(&spec_im.gridded_data(0, 0), Nh, this->Nx, w_im, -norm, nt);
+
+    PIC_FFTW_NAME(execute)(this->plans->cols_inv);
+    PIC_FFTW_NAME(execute_split_dft_c2r)(this->plans->rows_inv,
+                                         w_re, w_im,
+                                         &data.gridded_data(0, 0));
+
+    return 0;
+}
+
+/**
+ * @brief Performs the inverse of r2c for two spectra, see
+ *        RealPlan_2D::c2r_pair. FFTW's c2r transforms already only do the
+ *        work of a half length complex transform, so the pair is done as two
+ *        of them rather than packed into one complex grid.
+ *
+ * @param a_re The real part of the first transposed spectrum, an Ny/2 + 1
+ *             by Nx grid
+ * @param a_im The imaginary part of the first transposed spectrum
+ * @param b_re The real part of the second transposed spectrum
+ * @param b_im The imaginary part of the second transposed spectrum
+ * @param data_a Set to the Nx by Ny real grid of the first spectrum
+ * @param data_b Set to the Nx by Ny real grid of the second spectrum
+ * @return int An error code or 0 if it worked correctly
+ */
+int FFT::FFTWPlan_2D::c2r_pair(const GridObject& a_re, const GridObject& a_im,
+                               const GridObject& b_re, const GridObject& b_im,
+                               GridObject& data_a, GridObject& data_b)
+{
+    const int err = this->c2r(a_re, a_im, data_a);
+    if (err)
+    {
+        return err;
+    }
+
+    return this->c2r(b_re, b_im, data_b);
+}
+//-----------------------------------------
+
+
+/**********************************************************
+PRIVATE CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Measures the plans for a number of threads. Measuring overwrites
+ *        the arrays, so the row plans are made on a scratch grid; they are
+ *        made for unaligned arrays, so that they can be executed on the grid
+ *        of any field.
+ *
+ * @param nt Number of threads
+ */
+void FFT::FFTWPlan_2D::_make_plans(const int nt)
+{
+    start_fftw();
+
+    const std::ptrdiff_t Nx = this->Nx, Ny = this->Ny;
+    const std::ptrdiff_t Nh = Ny / 2 + 1;
+
+    std::unique_ptr<Plans> new_plans(new Plans());
+    new_plans->buffer = static_cast<real_t*>(
+        PIC_FFTW_NAME(malloc)(sizeof(real_t) * 2 * Nx * Nh));
+    real_t* w_re = new_plans->buffer;
+    real_t* w_im = w_re + Nx * Nh;
+
+    real_t* data = static_cast<real_t*>(
+        PIC_FFTW_NAME(malloc)(sizeof(real_t) * Nx * Ny));
+
+    PIC_FFTW_NAME(plan_with_nthreads)(nt);
+
+    // Row xi of the grid to and from row xi of the buffer
+    fftw_iodim_t row_fwd = {Ny, 1, 1};
+    fftw_iodim_t rows_fwd = {Nx, Ny, Nh};
+    new_plans->rows_fwd = PIC_FFTW_NAME(plan_guru64_split_dft_r2c)(
+        1, &row_fwd, 1, &rows_fwd, data, w_re, w_im,
+        FFTW_MEASURE | FFTW_UNALIGNED);
+
+    fftw_iodim_t row_inv = {Ny, 1, 1};
+    fftw_iodim_t rows_inv = {Nx, Nh, Ny};
+    new_plans->rows_inv = PIC_FFTW_NAME(plan_guru64_split_dft_c2r)(
+        1, &row_inv, 1, &rows_inv, w_re, w_im, data,
+        FFTW_MEASURE | FFTW_UNALIGNED | FFTW_DESTROY_INPUT);
+
+    // The columns of the buffer, in place. The backward transform is the
+    // forward one with the real and imaginary parts swapped.
+    fftw_iodim_t col = {Nx, Nh, Nh};
+    fftw_iodim_t cols = {Nh, 1, 1};
+    new_plans->cols_fwd = PIC_FFTW_NAME(plan_guru64_split_dft)(
+        1, &col, 1, &cols, w_re, w_im, w_re, w_im, FFTW_MEASURE);
+    new_plans->cols_inv = PIC_FFTW_NAME(plan_guru64_split_dft)(
+        1, &col, 1, &cols, w_im, w_re, w_im, w_re, FFTW_MEASURE);
+
+    PIC_FFTW_NAME(free)(data);
+
+    if (new_plans->complete())
+    {
+        this->plans = std::move(new_plans);
+        this->planned_threads = nt;
+    }
+    else
+    {
+        this->plans.reset();
+        this->planned_threads = 0;
+    }
+
+    if (!wisdom_file.empty())
+    {
+        PIC_FFTW_NAME(export_wisdom_to_filename)(wisdom_file.c_str());
+    }
+}
+//-----------------------------------------
+
+
+/**
+ * @brief Sets the file FFTW wisdom is read from and saved to, so that plans
+ *        measured in one run are reused by the next. Only the first plan of
+ *        a run reads it. An empty name turns the file off.
+ *
+ * @param filename Path of the wisdom file
+ */
+void FFT::set_fftw_wisdom_file(const std::string& filename)
+{
+    wisdom_file = filename;
+}
+
+#endif
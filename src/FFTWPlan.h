@@ -0,0 +1,86 @@
+#ifndef FFTWPLAN_H
+#define FFTWPLAN_H
+
+// Build with PIC_FFTW set to 1 to link FFTW and make it the default backend
+// of the field solve
+#ifndef PIC_FFTW
+#define PIC_FFTW 0
+#endif
+
+#if PIC_FFTW
+
+#include <memory>
+#include <string>
+
+#include "GridObject.h"
+#include "Precision.h"
+#include "Threads.h"
+
+namespace FFT
+{
+    /**
+     * @brief The same transforms of a real Nx by Ny grid as RealPlan_2D, with
+     *        the same transposed layout of the spectrum and the same sign and
+     *        normalization conventions, done by FFTW. The plans are measured
+     *        when the object is made, using and then saving the wisdom file,
+     *        and are threaded with n_threads threads. They are planned again
+     *        if n_threads changes, and when the object is copied.
+     *
+     */
+    class FFTWPlan_2D
+    {
+        private:
+            std::size_t Nx, Ny;
+
+            // The plans and the buffer they work in
+            struct Plans;
+            std::unique_ptr<Plans> plans;
+            int planned_threads;
+
+            /**********************************************************
+            PRIVATE CLASS METHODS
+            ***********************************************************/
+            void _make_plans(const int nt);
+            //-----------------------------------------
+
+        public:
+            std::size_t n_threads;  // 0 uses the OpenMP default
+
+            /**********************************************************
+            CONSTRUCTORS/DESTRUCTORS
+            ***********************************************************/
+            FFTWPlan_2D();
+            FFTWPlan_2D(const std::size_t Nx, const std::size_t Ny);
+            FFTWPlan_2D(const FFTWPlan_2D& copy_obj);
+            FFTWPlan_2D(FFTWPlan_2D&& move_obj) noexcept;
+            ~FFTWPlan_2D();
+            //-----------------------------------------
+
+
+            /**********************************************************
+            OPERATOR FUNCTIONS
+            ***********************************************************/
+            FFTWPlan_2D& operator=(const FFTWPlan_2D& to_copy);
+            FFTWPlan_2D& operator=(FFTWPlan_2D&& to_move) noexcept;
+            //-----------------------------------------
+
+
+            /**********************************************************
+            CLASS METHODS
+            ***********************************************************/
+            int r2c(const GridObject& data,
+                    GridObject& spec_re, GridObject& spec_im);
+            int c2r(const GridObject& spec_re, const GridObject& spec_im,
+                    GridObject& data);
+            int c2r_pair(const GridObject& a_re, const GridObject& a_im,
+                         const GridObject& b_re, const GridObject& b_im,
+                         GridObject& data_a, GridObject& data_b);
+            //-----------------------------------------
+    };
+
+    void set_fftw_wisdom_file(const std::string& filename);
+}
+
+#endif
+
+#endif
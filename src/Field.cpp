@@ -1,6 +1,104 @@
 #include "Field.h"
 
 
+/**
+ * @brief Gets the value of a field component in a guard cell past a wall,
+ *        from its value at the mirror image of the guard cell inside the
+ *        grid. The potential is odd about a Dirichlet wall, which makes the
+ *        normal component even and the others odd, and even about a Neumann
+ *        wall apart from its fixed slope, which makes the normal component
+ *        odd about its value on the wall and the others even.
+ *
+ * @param wall The condition on the wall
+ * @param normal Whether the component is normal to the wall
+ * @param E_wall The normal component on a Neumann wall
+ * @param inside The value at the mirror image
+ * @return real_t The value in the guard cell
+ */
+static inline real_t wall_image(const Multigrid::Boundary& wall,
+                                const bool normal, const double E_wall,
+                                const real_t inside)
+{
+    if (wall.type == Multigrid::Dirichlet)
+    {
+        return normal ? inside : -inside;
+    }
+
+    return normal ? real_t(2.0 * E_wall - inside) : inside;
+}
+
+/**
+ * @brief Overwrites the guard cells past the walls of a grid with the mirror
+ *        images of the field inside it, and leaves those of periodic sides.
+ *        A wall is half a cell past the first and last grid points, so guard
+ *        cell -d mirrors grid point d - 1. The x1 walls are done first, and
+ *        the x2 walls then mirror the guard rows too, which fills the corners.
+ *
+ * @param boundaries The conditions on the four sides
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param g Number of guard cells on each side
+ * @param node Gives a reference to component k of grid point (a, c), for a
+ *             and c from -g to N + g - 1
+ */
+template <typename Node>
+static void mirror_walls(const Multigrid::Boundaries& boundaries,
+                         const long Nx, const long Ny, const long g,
+                         Node node)
+{
+    // Outward derivatives of the potential give E = value on a low wall and
+    // E = -value on a high one
+    const Multigrid::Boundary* x1_walls[2] = {&boundaries.x1_lo,
+                                              &boundaries.x1_hi};
+    for (int hi = 0; hi < 2; ++hi)
+    {
+        const Multigrid::Boundary& wall = *x1_walls[hi];
+        if (wall.type == Multigrid::Periodic)
+        {
+            continue;
+        }
+
+        const double E_wall = hi ? -wall.value : wall.value;
+        for (long d = 1; d <= g; ++d)
+        {
+            const long a = hi ? Nx - 1 + d : -d;
+            const long m = hi ? Nx - d : d - 1;
+            for (long c = -g; c < Ny + g; ++c)
+            {
+                node(0, a, c) = wall_image(wall, true, E_wall, node(0, m, c));
+                node(1, a, c) = wall_image(wall, false, E_wall, node(1, m, c));
+                node(2, a, c) = wall_image(wall, false, E_wall, node(2, m, c));
+            }
+        }
+    }
+
+    const Multigrid::Boundary* x2_walls[2] = {&boundaries.x2_lo,
+                                              &boundaries.x2_hi};
+    for (int hi = 0; hi < 2; ++hi)
+    {
+        const Multigrid::Boundary& wall = *x2_walls[hi];
+        if (wall.type == Multigrid::Periodic)
+        {
+            continue;
+        }
+
+        const double E_wall = hi ? -wall.value : wall.value;
+        for (long a = -g; a < Nx + g; ++a)
+        {
+            for (long d = 1; d <= g; ++d)
+            {
+                const long c = hi ? Ny - 1 + d : -d;
+                const long m = hi ? Ny - d : d - 1;
+                node(0, a, c) = wall_image(wall, false, E_wall, node(0, a, m));
+                node(1, a, c) = wall_image(wall, true, E_wall, node(1, a, m));
+                node(2, a, c) = wall_image(wall, false, E_wall, node(2, a, m));
+            }
+        }
+    }
+}
+
+
+
 /**********************************************************
 CONSTRUCTORS/DESTRUCTORS
 ***********************************************************/
@@ -11,6 +109,15 @@ CONSTRUCTORS/DESTRUCTORS
  */
 Field::Field() //TODO: See if this can be removed
 {
+    this->n_threads = 0;
+
+    this->solver = Field_T::Field_Solver::Spectral;
+    this->boundaries = Multigrid::periodic;
+    this->solver_tolerance = Multigrid::default_tolerance;
+
+    this->interleaved = false;
+    this->node_guard = 0;
+    this->node_stride = 0;
 }
 
 /**
@@ -25,14 +132,17 @@ Field::Field(const std::size_t Nx, const std::size_t Ny,
              const double dx, const double dy)
 {
     this->total_U = 0.0;
+    this->n_threads = 0;
 
-    std::vector<double> k_x = FFT::get_k_vec(Nx, dx);
-    std::vector<double> k_y = FFT::get_k_vec(Ny, dy);
+    this->fft_plan = FFT::Transform_2D(Nx, Ny, FFT::default_backend);
 
-    this->K_x2 = FFT::get_K2_vec(k_x, dx);
-    this->K_y2 = FFT::get_K2_vec(k_y, dy);
-    this->Kappa_x = FFT::get_kappa_vec(k_x, dx);
-    this->Kappa_y = FFT::get_kappa_vec(k_y, dy);
+    this->solver = Field_T::Field_Solver::Spectral;
+    this->boundaries = Multigrid::periodic;
+    this->solver_tolerance = Multigrid::default_tolerance;
+
+    this->interleaved = false;
+    this->node_guard = 0;
+    this->node_stride = 0;
 
     this->f1 = GridObject(Nx, Ny);
     this->f2 = GridObject(Nx, Ny);
@@ -54,14 +164,17 @@ Field::Field(const std::size_t Nx, const std::size_t Ny,
              std::size_t component, double value)
 {
     this->total_U = 0.0;
+    this->n_threads = 0;
+
+    this->fft_plan = FFT::Transform_2D(Nx, Ny, FFT::default_backend);
 
-    std::vector<double> k_x = FFT::get_k_vec(Nx, dx);
-    std::vector<double> k_y = FFT::get_k_vec(Ny, dy);
+    this->solver = Field_T::Field_Solver::Spectral;
+    this->boundaries = Multigrid::periodic;
+    this->solver_tolerance = Multigrid::default_tolerance;
 
-    this->K_x2 = FFT::get_K2_vec(k_x, dx);
-    this->K_y2 = FFT::get_K2_vec(k_y, dy);
-    this->Kappa_x = FFT::get_kappa_vec(k_x, dx);
-    this->Kappa_y = FFT::get_kappa_vec(k_y, dy);
+    this->interleaved = false;
+    this->node_guard = 0;
+    this->node_stride = 0;
 
     switch(component)
     {
@@ -101,14 +214,17 @@ Field::Field(const std::size_t Nx,const  std::size_t Ny,
              std::function<void(Field &, std::size_t, std::size_t)> init_fcn)
 {
     this->total_U = 0.0;
+    this->n_threads = 0;
+
+    this->fft_plan = FFT::Transform_2D(Nx, Ny, FFT::default_backend);
 
-    std::vector<double> k_x = FFT::get_k_vec(Nx, dx);
-    std::vector<double> k_y = FFT::get_k_vec(Ny, dy);
+    this->solver = Field_T::Field_Solver::Spectral;
+    this->boundaries = Multigrid::periodic;
+    this->solver_tolerance = Multigrid::default_tolerance;
 
-    this->K_x2 = FFT::get_K2_vec(k_x, dx);
-    this->K_y2 = FFT::get_K2_vec(k_y, dy);
-    this->Kappa_x = FFT::get_kappa_vec(k_x, dx);
-    this->Kappa_y = FFT::get_kappa_vec(k_y, dy);
+    this->interleaved = false;
+    this->node_guard = 0;
+    this->node_stride = 0;
 
     init_field(init_fcn, Nx, Ny);
 }
@@ -128,7 +244,9 @@ CLASS METHODS
 ***********************************************************/
 
 /**
- * @brief Solves Poisson equation with periodic BCs
+ * @brief Solves Poisson equation for the electric field of a charge density,
+ *        with the solver picked by set_solver. Guard cells that have been
+ *        exchanged before are exchanged again for the new field.
  * @param charge_density The charge densitt distribution to calculate the
  *                       resulting field of
  * @param dx Spatial grid step in x direction
@@ -138,104 +256,140 @@ CLASS METHODS
 int Field::solve_field(const GridObject& charge_density,
                        const double dx, const double dy)
 {
-    int err = 0;
+    const int err = (this->solver == Field_T::Field_Solver::Multigrid) ?
+                    this->_solve_multigrid(charge_density, dx, dy) :
+                    this->_solve_spectral(charge_density, dx, dy);
 
-    const std::size_t Nx = charge_density.get_Nx();
-    const std::size_t Ny = charge_density.get_Ny();
+    if (this->has_guards())
+    {
+        this->exchange_guards();
+    }
 
-    phi_dens_re = GridObject(charge_density);
-    phi_dens_im = GridObject(Nx, Ny);
+    return err;
+}
 
-    // A phi = density
-    // 1 fourier transform density
-    err = FFT::FFT_2D(phi_dens_re, phi_dens_im, FFT::FFT_Dir::FFT);
+/**
+ * @brief Switches the library doing the transforms of the field solve,
+ *        planning them again
+ *
+ * @param backend The library to use
+ */
+void Field::set_fft_backend(const FFT::FFT_Backend backend)
+{
+    if (backend != this->fft_plan.get_backend())
+    {
+        this->fft_plan.set_backend(backend);
+    }
+}
 
-    // Set k=0 mode to zero
-    phi_dens_re.set_comp(0, 0, 0);
-    phi_dens_im.set_comp(0, 0, 0);
+/**
+ * @brief Picks the solver of Poisson equation and the conditions on the
+ *        sides of the grid. The guard cells past a wall are filled with the
+ *        mirror image of the field, so a gather through them does not read
+ *        the other side of the grid. Only the field sees the walls, though:
+ *        the particles and their deposit still wrap around the grid, and a
+ *        gather without guard cells wraps too.
+ *
+ * @param solver The solver to use
+ * @param boundaries The conditions on the four sides. The spectral solve
+ *                   only does periodic sides.
+ */
+void Field::set_solver(const Field_T::Field_Solver solver,
+                       const Multigrid::Boundaries& boundaries)
+{
+    if (solver == Field_T::Field_Solver::Spectral &&
+        !Multigrid::is_periodic(boundaries))
+    {
+        throw std::runtime_error(Field_T::solver_err);
+    }
+
+    this->solver = solver;
+    this->boundaries = boundaries;
 
+    // Made again by the next multigrid solve
+    this->multigrid = Multigrid::Poisson_2D();
 
-    for (std::size_t xi = 0; xi < Nx; ++xi)
+    if (this->has_guards())
     {
-        // double kx = (2. * M_PI * xi) / (Nx * dx);
-        // double sinckx2 = sinc(kx * dx / 2.);
-        // double Klsq = kx*kx * sinckx2*sinckx2;
+        this->exchange_guards();
+    }
+}
 
-        for (std::size_t yj = 0; yj < Ny; ++yj)
-        {
-            // Don't overwrite the k=0 mode
-            if (xi == 0 and yj == 0)
-            {
-                continue;
-            }
+/**
+ * @brief Copies every component into its guard cells, for the particle gather
+ *        to read without wrapping around the grid. Guard cells past a
+ *        periodic side hold the other side of the grid, and those past a
+ *        wall the mirror image of the field inside it. The field solve keeps
+ *        them up to date afterwards, but a field changed in any other way
+ *        needs to exchange them again.
+ *
+ */
+void Field::exchange_guards()
+{
+    if (this->interleaved)
+    {
+        this->_exchange_nodes();
+        return;
+    }
 
-            // double ky = (2. * M_PI * yj) / (Ny * dy);
-            // double sincky2 = sinc(ky * dy / 2.);
+    this->f1.exchange_guards(Shape::guard_cells);
+    this->f2.exchange_guards(Shape::guard_cells);
+    this->f3.exchange_guards(Shape::guard_cells);
 
-            // double Klmsq_ij = Klsq + (ky*ky * sincky2*sincky2);
-            double Klmsq_ij = this->K_x2[xi] + this->K_y2[yj];
+    if (!Multigrid::is_periodic(this->boundaries))
+    {
+        GridObject* comps[3] = {&this->f1, &this->f2, &this->f3};
+        mirror_walls(this->boundaries, this->f1.Nx, this->f1.Ny,
+                     long(Shape::guard_cells),
+                     [&comps](const int k, const long a, const long c) -> real_t&
+                     {
+                         return comps[k]->guarded(a, c);
+                     });
+    }
+}
 
-            // energy is rhobar * phibar conj = |rhobar|^2 / Klm^2
-            this->total_U += (phi_dens_re.get_comp(xi,yj) *
-                              phi_dens_re.get_comp(xi,yj) +
-                              phi_dens_im.get_comp(xi,yj) *
-                              phi_dens_im.get_comp(xi,yj) ) / Klmsq_ij;
+/**
+ * @brief Picks whether the guard cells the gather reads are one grid per
+ *        component, or one grid of nodes holding all three components next
+ *        to each other. Guard cells that were exchanged before are exchanged
+ *        again in the new layout.
+ *
+ * @param interleaved Whether to interleave the components
+ */
+void Field::set_interleaved(const bool interleaved)
+{
+    const bool had_guards = this->has_guards();
 
-            phi_dens_re.comp_multiply_by(xi, yj, 1./Klmsq_ij);
-            phi_dens_im.comp_multiply_by(xi, yj, 1./Klmsq_ij);
-        }
-    }
+    this->interleaved = interleaved;
 
-    // then Ex, Ey are phi times appropriate value
-    // Ex(l,m) = -i kl sinc(kl dx) phi(l,m)
-    // Ey(l,m) = -i km sinc(km dy) phi(l,m)
-    // or:
-    // Ex_re(l,m) = kl sinc(kl dx) phi_im
-    // Ex_im(l,m) = - kl sinc(kl dx) phi_re
-    // Ey_re(l,m) = km sinc(km dy) phi_im
-    // Ey_im(l,m) = - km sinc(km dy) phi_re
-    f1 = GridObject(phi_dens_im);
-    GridObject Ex_im(phi_dens_re);
-    f2 = phi_dens_im;
-    GridObject Ey_im = phi_dens_re;
-
-    for (std::size_t xi = 0; xi < Nx; ++xi)
+    if (had_guards)
     {
-        // double kappa_x = (2. * M_PI * xi) / (Nx * dx);
-        // double sinc_kappa_x = sinc(kappa_x * dx);
-        // double Kappa_i = kappa_x * sinc_kappa_x;
+        this->exchange_guards();
+    }
+}
 
-        for (std::size_t yj = 0; yj < Ny; ++yj)
+/**
+ * @brief Checks whether every component of the field is zero everywhere
+ *
+ * @return true If all of the field values are zero
+ * @return false If any of the field values are non-zero
+ */
+bool Field::is_zero() const
+{
+    const GridObject* comps[3] = {&f1, &f2, &f3};
+
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+        for (auto it = comps[c]->cbegin(); it != comps[c]->cend(); ++it)
         {
-            // Don't overwrite the k=0 mode
-            if (xi == 0 and yj == 0)
+            if (*it != 0.0)
             {
-                continue;
+                return false;
             }
-
-            // double kappa_y = (2. * M_PI * yj) / (Ny * dy);
-            // double sinc_kappa_y = sinc(kappa_y * dy);
-
-            // double Kappa_j = kappa_y * sinc_kappa_y;
-            double Kappa_i = Kappa_x[xi];
-            double Kappa_j = Kappa_y[yj];
-
-            // TODO: is negative sign in the f_ or the E__im ?
-            f1.comp_multiply_by(xi, yj, -Kappa_i);
-            Ex_im.comp_multiply_by(xi, yj, Kappa_i);
-            f2.comp_multiply_by(xi, yj, -Kappa_j);
-            Ey_im.comp_multiply_by(xi, yj, Kappa_j);
         }
     }
 
-    // then Ex, Ey are inverse Fourier transformed.
-    err = FFT::FFT_2D(f1, Ex_im, FFT::FFT_Dir::iFFT);
-    err = FFT::FFT_2D(f2, Ey_im, FFT::FFT_Dir::iFFT);
-
-    // For total electrostatic energy diagnostic
-    this->total_U *= 0.5;
-
-    return err;
+    return true;
 }
 
 /**
@@ -257,33 +411,207 @@ void Field::print_field()
 /**********************************************************
 PRIVATE FUNCTIONS
 ***********************************************************/
+
+/**
+ * @brief Copies the three components, and their periodic or mirror images in
+ *        the guard cells, into the interleaved nodes
+ *
+ */
+void Field::_exchange_nodes()
+{
+    const long g = Shape::guard_cells;
+    const long Nx = this->f1.Nx, Ny = this->f1.Ny;
+    const std::size_t w = Field::node_width;
+
+    this->node_guard = g;
+    this->node_stride = padded_row((Ny + 2 * g) * w, sizeof(real_t));
+    this->node_data.resize((Nx + 2 * g) * this->node_stride);
+
+    const int nt = Threads::resolve(this->n_threads);
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (long a = -g; a < Nx + g; ++a)
+    {
+        const std::size_t gi = wrap_index(a, Nx);
+        const real_t* c1 = &this->f1.gridded_data(gi, 0);
+        const real_t* c2 = &this->f2.gridded_data(gi, 0);
+        const real_t* c3 = &this->f3.gridded_data(gi, 0);
+        real_t* nodes = &this->node_data[(a + g) * this->node_stride];
+
+        for (long c = -g; c < Ny + g; ++c)
+        {
+            const std::size_t gj = (c >= 0 && c < Ny) ? c : wrap_index(c, Ny);
+            real_t* n = nodes + (c + g) * w;
+            n[0] = c1[gj];
+            n[1] = c2[gj];
+            n[2] = c3[gj];
+            n[3] = 0.0;
+        }
+    }
+
+    if (!Multigrid::is_periodic(this->boundaries))
+    {
+        real_t* nodes = this->node_data.data();
+        const std::size_t stride = this->node_stride;
+        mirror_walls(this->boundaries, Nx, Ny, g,
+                     [nodes, stride, g, w](const int k, const long a,
+                                           const long c) -> real_t&
+                     {
+                         return nodes[(a + g) * stride + (c + g) * w + k];
+                     });
+    }
+}
 void Field::init_field(std::function<void(Field &, std::size_t, std::size_t)> init_fcn, std::size_t Nx, std::size_t Ny)
 {
     init_fcn(*this, Nx, Ny);
 }
-//-----------------------------------------
 
+/**
+ * @brief Solves Poisson equation with periodic BCs. The density and the
+ *        fields are real, so only half of their spectra is computed: the
+ *        modes with negative ky are the complex conjugates of the others.
+ *        The spectrum of the density is turned into those of the fields in
+ *        one sweep, in place, with the Green's function of the grid shared
+ *        by the fields of the same geometry. The transforms and the sweep
+ *        are shared out between n_threads threads.
+ * @param charge_density The charge densitt distribution to calculate the
+ *                       resulting field of
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @return int An error code or 0 if it worked correctly
+ */
+int Field::_solve_spectral(const GridObject& charge_density,
+                           const double dx, const double dy)
+{
+    int err = 0;
 
-/**********************************************************
-TO BE IMPLEMENTED
-***********************************************************/
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t Nx = charge_density.get_Nx();
+    const std::size_t Ny = charge_density.get_Ny();
+    const std::size_t Nh = Ny / 2 + 1;
+
+    // The scratch grids are kept between solves. The spectra are transposed,
+    // indexed (ky, kx).
+    if (std::size_t(Ey_hat_re.get_Nx()) != Nh ||
+        std::size_t(Ey_hat_re.get_Ny()) != Nx)
+    {
+        Ey_hat_re = GridObject(Nh, Nx);
+        Ey_hat_im = GridObject(Nh, Nx);
+        U_rows.resize(Nh);
+    }
+    if (!this->greens || !this->greens->matches(Nx, Ny, dx, dy))
+    {
+        this->greens = GreensFunction_2D::get(Nx, Ny, dx, dy);
+    }
+
+    this->fft_plan.n_threads = this->n_threads;
+
+    // A phi = density
+    // 1 fourier transform density
+    err = this->fft_plan.r2c(charge_density, rho_hat_re, rho_hat_im);
+
+    // then phi = G rho and Ex, Ey are phi times appropriate value
+    // Ex(l,m) = i kappa_l phi(l,m)
+    // Ey(l,m) = i kappa_m phi(l,m)
+    // or:
+    // Ex_re(l,m) = - kappa_l phi_im
+    // Ex_im(l,m) = kappa_l phi_re
+    // Ey_re(l,m) = - kappa_m phi_im
+    // Ey_im(l,m) = kappa_m phi_re
+    // with kappa_l = kl sinc(kl dx). Ex is written over the density.
+    //
+    // The ky rows are independent, so they are shared out between threads
+    const GreensFunction_2D& greens = *this->greens;
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t yj = 0; yj < Nh; ++yj)
+    {
+        real_t* Ex_re_row = &rho_hat_re.gridded_data(yj, 0);
+        real_t* Ex_im_row = &rho_hat_im.gridded_data(yj, 0);
+        real_t* Ey_re_row = &Ey_hat_re.gridded_data(yj, 0);
+        real_t* Ey_im_row = &Ey_hat_im.gridded_data(yj, 0);
+
+        const real_t* G_row = greens.green_row(yj);
+        const real_t* Kappa_x = greens.kappa_x();
+        const real_t Kappa_y = greens.kappa_y(yj);
+
+        // Apart from ky = 0 and the Nyquist ky, each mode here also stands
+        // for its conjugate
+        const double n_modes = (yj == 0 || 2 * yj == Ny) ? 1.0 : 2.0;
+        double U_row = 0.0;
+
+        // G is zero for the k=0 mode, which sets it to zero
+        #pragma omp simd reduction(+:U_row)
+        for (std::size_t xi = 0; xi < Nx; ++xi)
+        {
+            const real_t rho_re = Ex_re_row[xi];
+            const real_t rho_im = Ex_im_row[xi];
+
+            const real_t phi_re = G_row[xi] * rho_re;
+            const real_t phi_im = G_row[xi] * rho_im;
+
+            // energy is rhobar * phibar conj = |rhobar|^2 / Klm^2
+            U_row += double(rho_re) * phi_re + double(rho_im) * phi_im;
+
+            // TODO: is negative sign in the f_ or the E__im ?
+            Ex_re_row[xi] = -Kappa_x[xi] * phi_im;
+            Ex_im_row[xi] = Kappa_x[xi] * phi_re;
+            Ey_re_row[xi] = -Kappa_y * phi_im;
+            Ey_im_row[xi] = Kappa_y * phi_re;
+        }
+
+        this->U_rows[yj] = n_modes * U_row;
+    }
+
+    for (std::size_t yj = 0; yj < Nh; ++yj)
+    {
+        this->total_U += this->U_rows[yj];
+    }
+
+    // then Ex, Ey are inverse Fourier transformed.
+    // Both are real, so they come out of one complex transform of Ex + iEy
+    err = this->fft_plan.c2r_pair(rho_hat_re, rho_hat_im,
+                                  Ey_hat_re, Ey_hat_im, f1, f2);
+
+    // For total electrostatic energy diagnostic
+    this->total_U *= 0.5;
+
+    return err;
+}
 
 /**
- * @brief
- *
- * @param charge_density
- * @return int
+ * @brief Solves Poisson equation with the multigrid solver, for the
+ *        boundaries given to set_solver. The solver is kept, with its
+ *        potential as the first guess of the next solve, as long as the grid
+ *        does not change.
+ * @param charge_density The charge density distribution to calculate the
+ *                       resulting field of
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @return int An error code or 0 if it worked correctly
  */
-int solve_field_fftw(GridObject &charge_density)
+int Field::_solve_multigrid(const GridObject& charge_density,
+                            const double dx, const double dy)
 {
-    // consider building fftw plan outside function loop
-
-    // initialize fftw things
-    // load charge_density into fftw pointer
-    // perform 2d fft
-    // get phibar from densitybar
-    // get Ebars from phibar
-    // ifft
-    return 1;
+    const std::size_t Nx = charge_density.get_Nx();
+    const std::size_t Ny = charge_density.get_Ny();
+
+    if (!this->multigrid.matches(Nx, Ny, dx, dy))
+    {
+        this->multigrid = Multigrid::Poisson_2D(Nx, Ny, dx, dy,
+                                                this->boundaries);
+    }
+
+    this->multigrid.n_threads = this->n_threads;
+    this->multigrid.tolerance = this->solver_tolerance;
+
+    double U = 0.0;
+    const int err = this->multigrid.solve(charge_density, f1, f2, U);
+
+    // For total electrostatic energy diagnostic, as the spectral solve
+    this->total_U += U;
+    this->total_U *= 0.5;
+
+    return err;
 }
 //-----------------------------------------
@@ -2,13 +2,17 @@
 #define Field_H
 
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <functional>
 
-// #include <fftw3.h>
-
-#include "FFT.h"
+#include "Aligned.h"
+#include "FFTBackend.h"
+#include "GreensFunction.h"
 #include "GridObject.h"
+#include "Multigrid.h"
+#include "Shape.h"
+#include "Threads.h"
 
 namespace Field_T
 {
@@ -18,6 +22,16 @@ namespace Field_T
         Electric,
         Magnetic
     };
+
+    const char solver_err[47] = "Error: the spectral solve needs periodic sides";
+    const char node_err[48] = "Error: Field node is outside of the guard cells";
+
+    // Solvers of the Poisson equation for the electric field
+    enum Field_Solver
+    {
+        Spectral,  // FFTs, periodic sides only
+        Multigrid  // Multigrid::Poisson_2D, any sides
+    };
 }
 
 class Field
@@ -30,10 +44,39 @@ class Field
             x3_accessor = 2
         };
 
-        //TODO: these should just be defined once for all fields rather than for each field object
-        std::vector<double> K_x2, K_y2;
-        std::vector<double> Kappa_x, Kappa_y;
-        GridObject phi_dens_re, phi_dens_im, Ex_im, Ey_im;
+        // Green's function of the grid, shared by the fields of the same
+        // geometry and fetched by the first solve
+        std::shared_ptr<const GreensFunction_2D> greens;
+
+        // Half spectra of the density and the fields, kept so that only the
+        // first solve allocates. The density spectrum becomes that of Ex.
+        GridObject rho_hat_re, rho_hat_im;
+        GridObject Ey_hat_re, Ey_hat_im;
+
+        // Energy of each ky row of the spectrum, summed in a fixed order so
+        // the total does not depend on the number of threads
+        std::vector<double> U_rows;
+
+        // Transforms of the grid, planned once when the field is made
+        FFT::Transform_2D fft_plan;
+
+        Field_T::Field_Solver solver;
+        Multigrid::Boundaries boundaries;
+
+        // Multigrid solver, made by the first solve that uses it. It keeps
+        // the potential, which starts the next solve.
+        Multigrid::Poisson_2D multigrid;
+
+        // Node-interleaved copy of the field with guard cells, for the
+        // gather: the three components of node (i, j), and a zero to make
+        // node_width values, start at
+        // (i + node_guard) * node_stride + (j + node_guard) * node_width,
+        // where node_stride is the row of Ny + 2 * node_guard nodes padded
+        // by padded_row. A node never crosses a cache line.
+        bool interleaved;
+        std::size_t node_guard;
+        std::size_t node_stride;
+        cache_aligned_vector<real_t> node_data;
 
         char no_dimension_err[45] = "Error: Field dimension does not exist"; //TODO: want to make this constant but it destroys the assignment constructor. need to define my own operator= ?
 
@@ -42,22 +85,29 @@ class Field
         PRIVATE CLASS METHODS
         ***********************************************************/
         void init_field(std::function<void(Field &, std::size_t, std::size_t)> init_fcn, std::size_t Nx, std::size_t Ny);
-        //-----------------------------------------
-
 
-        /**********************************************************
-        TO BE IMPLEMENTED
-        ***********************************************************/
-        int solve_field_fftw(const GridObject& charge_density);
+        int _solve_spectral(const GridObject& charge_density,
+                            const double dx, const double dy);
+        int _solve_multigrid(const GridObject& charge_density,
+                             const double dx, const double dy);
+        void _exchange_nodes();
         //-----------------------------------------
 
     public:
+        // Values stored for each node of the interleaved layout
+        static const std::size_t node_width = 4;
+
         GridObject f1;
         GridObject f2;
         GridObject f3;
 
         double total_U;
 
+        std::size_t n_threads;  // 0 uses the OpenMP default
+
+        // Residual the multigrid solve stops at, relative to the density
+        double solver_tolerance;
+
         /**********************************************************
         CONSTRUCTORS/DESTRUCTORS
         ***********************************************************/
@@ -70,16 +120,107 @@ class Field
         Field(const std::size_t Nx, const std::size_t Ny,
               const double dx, const double dy,
               std::function<void(Field &, std::size_t, std::size_t)> init_fcn);
+        Field(const Field& copy_obj) = default;
+        Field(Field&& move_obj) noexcept = default;
         ~Field();
         //-----------------------------------------
 
 
+        /**********************************************************
+        OPERATOR FUNCTIONS
+        ***********************************************************/
+        Field& operator=(const Field& to_copy) = default;
+        Field& operator=(Field&& to_move) noexcept = default;
+        //-----------------------------------------
+
+
         /**********************************************************
         CLASS METHODS
         ***********************************************************/
         int solve_field(const GridObject& charge_density,
                         const double dx, const double dy);
 
+        void set_fft_backend(const FFT::FFT_Backend backend);
+
+        void set_solver(const Field_T::Field_Solver solver,
+                        const Multigrid::Boundaries& boundaries);
+
+        inline Field_T::Field_Solver get_solver() const
+        {
+            return this->solver;
+        }
+
+        inline FFT::FFT_Backend get_fft_backend() const
+        {
+            return this->fft_plan.get_backend();
+        }
+
+        void exchange_guards();
+
+        void set_interleaved(const bool interleaved);
+
+        inline bool is_interleaved() const
+        {
+            return this->interleaved;
+        }
+
+        /**
+         * @brief Checks whether the guard cells of the current layout are
+         *        wide enough for every particle shape
+         *
+         * @return true If the guard cells have been exchanged
+         * @return false If they never have
+         */
+        inline bool has_guards() const
+        {
+            const std::size_t g = Shape::guard_cells;
+
+            if (this->interleaved)
+            {
+                return this->node_guard >= g;
+            }
+
+            return this->f1.get_n_guard() >= g &&
+                   this->f2.get_n_guard() >= g &&
+                   this->f3.get_n_guard() >= g;
+        }
+
+        /**
+         * @brief Get the number of values from the start of a row of the
+         *        interleaved nodes to the next
+         *
+         * @return std::size_t The row stride, 0 before the nodes exist
+         */
+        inline std::size_t get_node_stride() const
+        {
+            return this->node_stride;
+        }
+
+        /**
+         * @brief Get the components of a node of the interleaved layout.
+         *        Indices may be up to the guard cells outside of the grid,
+         *        and are only checked in a debug build.
+         *
+         * @param i x index of grid
+         * @param j y index of grid
+         * @return const real_t* The node_width values of the node
+         */
+        inline const real_t* node(const long i, const long j) const
+        {
+            const long g = long(this->node_guard);
+#if PIC_DEBUG
+            if (i < -g || i >= this->f1.Nx + g ||
+                j < -g || j >= this->f1.Ny + g)
+            {
+                throw std::out_of_range(Field_T::node_err);
+            }
+#endif
+            return &this->node_data[(i + g) * long(this->node_stride) +
+                                    (j + g) * long(Field::node_width)];
+        }
+
+        bool is_zero() const;
+
         void print_field();
         //-----------------------------------------
 };
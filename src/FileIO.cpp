@@ -1,5 +1,12 @@
 #include "FileIO.h"
 
+// HDF5 type matching the floating point type the data is stored in
+#if PIC_SINGLE_PRECISION
+#define H5_REAL_T H5::PredType::NATIVE_FLOAT
+#else
+#define H5_REAL_T H5::PredType::NATIVE_DOUBLE
+#endif
+
 /**********************************************************
 CONSTRUCTORS/DESTRUCTORS
 ***********************************************************/
@@ -141,9 +148,9 @@ int FileIO::write_species_to_HDF5(const std::size_t spec_name, const std::size_t
 
         H5::DataSpace spec_ds(data.get_ndims(), dim_sizes);
         H5std_string spec_dsname(std::to_string(itr_num));
-        H5::DataSet spec_dataset = spec_group.createDataSet(spec_dsname, H5::PredType::NATIVE_DOUBLE, spec_ds, *plist);
+        H5::DataSet spec_dataset = spec_group.createDataSet(spec_dsname, H5_REAL_T, spec_ds, *plist);
 
-        spec_dataset.write(data.get_data(), H5::PredType::NATIVE_DOUBLE);
+        spec_dataset.write(data.get_data(), H5_REAL_T);
 
         spec_dataset.close();
         spec_ds.close();
@@ -232,9 +239,9 @@ int FileIO::write_e_field_to_HDF5(const std::size_t field_comp, const std::size_
 
         H5::DataSpace f_ds(data.get_ndims(), dim_sizes);
         H5std_string f_dsname(std::to_string(itr_num));
-        H5::DataSet f_dataset = comp_group.createDataSet(f_dsname, H5::PredType::NATIVE_DOUBLE, f_ds, *plist);
+        H5::DataSet f_dataset = comp_group.createDataSet(f_dsname, H5_REAL_T, f_ds, *plist);
 
-        f_dataset.write(data.get_data(), H5::PredType::NATIVE_DOUBLE);
+        f_dataset.write(data.get_data(), H5_REAL_T);
 
         f_dataset.close();
         f_ds.close();
@@ -324,9 +331,9 @@ int FileIO::write_b_field_to_HDF5(const std::size_t field_comp, const std::size_
 
         H5::DataSpace f_ds(data.get_ndims(), dim_sizes);
         H5std_string f_dsname(std::to_string(itr_num));
-        H5::DataSet f_dataset = comp_group.createDataSet(f_dsname, H5::PredType::NATIVE_DOUBLE, f_ds, *plist);
+        H5::DataSet f_dataset = comp_group.createDataSet(f_dsname, H5_REAL_T, f_ds, *plist);
 
-        f_dataset.write(data.get_data(), H5::PredType::NATIVE_DOUBLE);
+        f_dataset.write(data.get_data(), H5_REAL_T);
 
         f_dataset.close();
         f_ds.close();
@@ -428,9 +435,9 @@ int FileIO::write_phase_to_HDF5(const char phase_name[], const std::size_t spec_
 
         H5::DataSpace p_ds(data.get_ndims(), dim_sizes);
         H5std_string p_dsname(std::to_string(itr_num));
-        H5::DataSet p_dataset = spec_group.createDataSet(p_dsname, H5::PredType::NATIVE_DOUBLE, p_ds, *plist);
+        H5::DataSet p_dataset = spec_group.createDataSet(p_dsname, H5_REAL_T, p_ds, *plist);
 
-        p_dataset.write(data.get_data(), H5::PredType::NATIVE_DOUBLE);
+        p_dataset.write(data.get_data(), H5_REAL_T);
 
         p_dataset.close();
         p_ds.close();
@@ -0,0 +1,122 @@
+#include "GreensFunction.h"
+
+#include <mutex>
+
+namespace
+{
+    // Tables handed out by get(), dropped once no field uses them
+    std::vector<std::weak_ptr<const GreensFunction_2D>> tables;
+    std::mutex tables_mutex;
+}
+
+
+/**********************************************************
+CONSTRUCTORS/DESTRUCTORS
+***********************************************************/
+
+/**
+ * @brief Constructor for GreensFunction_2D - computes the tables
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param dx Spatial grid step in x1
+ * @param dy Spatial grid step in x2
+ */
+GreensFunction_2D::GreensFunction_2D(const std::size_t Nx, const std::size_t Ny,
+                                     const double dx, const double dy)
+{
+    this->Nx = Nx;
+    this->Ny = Ny;
+    this->dx = dx;
+    this->dy = dy;
+
+    const std::size_t Nh = Ny / 2 + 1;
+
+    std::vector<double> k_x = FFT::get_k_vec(Nx, dx);
+    std::vector<double> k_y = FFT::get_k_vec(Ny, dy);
+
+    std::vector<double> K_x2 = FFT::get_K2_vec(k_x, dx);
+    std::vector<double> K_y2 = FFT::get_K2_vec(k_y, dy);
+    std::vector<double> kappa_x = FFT::get_kappa_vec(k_x, dx);
+    std::vector<double> kappa_y = FFT::get_kappa_vec(k_y, dy);
+
+    this->Kappa_x.assign(kappa_x.begin(), kappa_x.end());
+    this->Kappa_y.assign(kappa_y.begin(), kappa_y.begin() + Nh);
+
+    this->G.resize(Nh * Nx);
+    for (std::size_t yj = 0; yj < Nh; ++yj)
+    {
+        for (std::size_t xi = 0; xi < Nx; ++xi)
+        {
+            // The k = 0 mode is set to zero
+            const double Klmsq = K_x2[xi] + K_y2[yj];
+            this->G[yj * Nx + xi] = (xi == 0 && yj == 0) ? 0.0 : 1.0 / Klmsq;
+        }
+    }
+}
+//-----------------------------------------
+
+
+/**********************************************************
+CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Gets the tables of a grid geometry, shared with every other user of
+ *        the same geometry. They are only computed if no one holds them yet.
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param dx Spatial grid step in x1
+ * @param dy Spatial grid step in x2
+ * @return std::shared_ptr<const GreensFunction_2D> The tables
+ */
+std::shared_ptr<const GreensFunction_2D> GreensFunction_2D::get(
+    const std::size_t Nx, const std::size_t Ny,
+    const double dx, const double dy)
+{
+    std::lock_guard<std::mutex> lock(tables_mutex);
+
+    std::shared_ptr<const GreensFunction_2D> found;
+    std::size_t kept = 0;
+    for (std::size_t t = 0; t < tables.size(); ++t)
+    {
+        std::shared_ptr<const GreensFunction_2D> table = tables[t].lock();
+        if (!table)
+        {
+            continue;
+        }
+        if (table->matches(Nx, Ny, dx, dy))
+        {
+            found = table;
+        }
+        tables[kept++] = tables[t];
+    }
+    tables.resize(kept);
+
+    if (!found)
+    {
+        found = std::make_shared<const GreensFunction_2D>(Nx, Ny, dx, dy);
+        tables.push_back(found);
+    }
+
+    return found;
+}
+
+/**
+ * @brief Checks whether the tables are those of a grid geometry
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param dx Spatial grid step in x1
+ * @param dy Spatial grid step in x2
+ * @return true If they are
+ * @return false Otherwise
+ */
+bool GreensFunction_2D::matches(const std::size_t Nx, const std::size_t Ny,
+                                const double dx, const double dy) const
+{
+    return this->Nx == Nx && this->Ny == Ny &&
+           this->dx == dx && this->dy == dy;
+}
+//-----------------------------------------
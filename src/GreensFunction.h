@@ -0,0 +1,69 @@
+#ifndef GREENSFUNCTION_H
+#define GREENSFUNCTION_H
+
+#include <memory>
+#include <vector>
+
+#include "FFT.h"
+#include "Precision.h"
+
+/**
+ * @brief The tables of the spectral field solve for one grid geometry. The
+ *        Green's function G = 1/K^2 of the discrete Poisson equation, phi =
+ *        G rho, is kept for every mode of the half spectrum, in the
+ *        transposed layout of FFT::RealPlan_2D: an Ny/2 + 1 by Nx grid
+ *        indexed (ky, kx). The gradient, E = -i kappa phi, only needs the
+ *        kappa of each direction. G is zero for the k = 0 mode, so that the
+ *        solve needs no special case for it.
+ *
+ *        The tables never change once made, so fields of the same geometry
+ *        share one copy through get().
+ *
+ */
+class GreensFunction_2D
+{
+    private:
+        std::size_t Nx, Ny;
+        double dx, dy;
+
+        std::vector<real_t> G;
+        std::vector<real_t> Kappa_x, Kappa_y;
+
+    public:
+        /**********************************************************
+        CONSTRUCTORS/DESTRUCTORS
+        ***********************************************************/
+        GreensFunction_2D(const std::size_t Nx, const std::size_t Ny,
+                          const double dx, const double dy);
+        //-----------------------------------------
+
+
+        /**********************************************************
+        CLASS METHODS
+        ***********************************************************/
+        static std::shared_ptr<const GreensFunction_2D> get(
+            const std::size_t Nx, const std::size_t Ny,
+            const double dx, const double dy);
+
+        bool matches(const std::size_t Nx, const std::size_t Ny,
+                     const double dx, const double dy) const;
+
+        // G of the modes of ky row yj
+        inline const real_t* green_row(const std::size_t yj) const
+        {
+            return &this->G[yj * this->Nx];
+        }
+
+        inline const real_t* kappa_x() const
+        {
+            return this->Kappa_x.data();
+        }
+
+        inline real_t kappa_y(const std::size_t yj) const
+        {
+            return this->Kappa_y[yj];
+        }
+        //-----------------------------------------
+};
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef GRIDDIMS_H
+#define GRIDDIMS_H
+
+#include <cstddef>
+
+#include "Aligned.h"
+#include "Field.h"
+#include "GridObject.h"
+#include "Precision.h"
+#include "Shape.h"
+
+// Grid sizes, Nx by Ny, that the particle kernels are also compiled for. A
+// problem on one of these grids runs kernels whose dimensions and strides are
+// constants, and whose periodic wraps are masks when the size is a power of
+// 2. Any other grid runs the kernels for dimensions known at run time. Build
+// with DEFINES+='-DPIC_FIXED_GRIDS=GridDims::Fixed<96, 48>' to compile for
+// other sizes instead, or with an empty list for none.
+#ifndef PIC_FIXED_GRIDS
+#define PIC_FIXED_GRIDS GridDims::Fixed<32, 32>, GridDims::Fixed<64, 64>, \
+                        GridDims::Fixed<128, 128>, GridDims::Fixed<256, 256>, \
+                        GridDims::Fixed<512, 512>
+#endif
+
+/**
+ * @brief Grid dimensions for the particle kernels, either known only at run
+ *        time or fixed at compile time. A kernel templated on the dimensions
+ *        indexes the grid through them.
+ *
+ */
+namespace GridDims
+{
+    /**
+     * @brief The shape of the grid a kernel works on, and the row strides of
+     *        the copies with guard cells it reads from. A stride of 0 means
+     *        the kernel does not use that copy, and wraps the indices instead.
+     *
+     */
+    struct Layout
+    {
+        std::size_t Nx, Ny;
+        std::size_t guard_stride;  // rows of the guard cell copies
+        std::size_t node_stride;   // rows of the interleaved field nodes
+
+        Layout(const std::size_t Nx, const std::size_t Ny)
+            : Nx(Nx), Ny(Ny), guard_stride(0), node_stride(0)
+        {
+        }
+    };
+
+    /**
+     * @brief Wraps a grid index back into a grid of N points whose size is a
+     *        compile time constant, with a mask if N is a power of 2
+     *
+     * @tparam N Number of grid spaces in that direction
+     * @param k The grid index
+     * @return std::size_t The periodic image of k on the grid
+     */
+    template <std::size_t N>
+    inline std::size_t wrap(const long k)
+    {
+        if ((N & (N - 1)) == 0)
+        {
+            return std::size_t(k) & (N - 1);
+        }
+
+        return wrap_index(k, N);
+    }
+
+
+    /**
+     * @brief Dimensions and strides read from the layout at run time
+     *
+     */
+    class Dynamic
+    {
+        private:
+            std::size_t Nx, Ny;
+            long guard_row, node_row;
+
+        public:
+            explicit Dynamic(const Layout& layout)
+                : Nx(layout.Nx), Ny(layout.Ny),
+                  guard_row(long(layout.guard_stride)),
+                  node_row(long(layout.node_stride))
+            {
+            }
+
+            inline std::size_t nx() const
+            {
+                return this->Nx;
+            }
+
+            inline std::size_t ny() const
+            {
+                return this->Ny;
+            }
+
+            inline std::size_t wrap_x(const long k) const
+            {
+                return wrap_index(k, this->Nx);
+            }
+
+            inline std::size_t wrap_y(const long k) const
+            {
+                return wrap_index(k, this->Ny);
+            }
+
+            inline long guard_stride() const
+            {
+                return this->guard_row;
+            }
+
+            inline long node_stride() const
+            {
+                return this->node_row;
+            }
+    };
+
+
+    /**
+     * @brief Dimensions and strides fixed at compile time, for a grid of NX
+     *        by NY points with Shape::guard_cells guard cells on each side
+     *
+     * @tparam NX Number of grid spaces in x direction
+     * @tparam NY Number of grid spaces in y direction
+     */
+    template <std::size_t NX, std::size_t NY>
+    class Fixed
+    {
+        private:
+            static const std::size_t guard_row =
+                padded_row(NY + 2 * Shape::guard_cells, sizeof(real_t));
+            static const std::size_t node_row =
+                padded_row((NY + 2 * Shape::guard_cells) * Field::node_width,
+                           sizeof(real_t));
+
+        public:
+            explicit Fixed(const Layout&)
+            {
+            }
+
+            /**
+             * @brief Checks whether a layout has these dimensions, and the
+             *        strides of their guard cells, so the kernels compiled for
+             *        them can run on it
+             *
+             * @param layout The layout of the grid
+             * @return true If the layout matches
+             * @return false If it does not
+             */
+            static inline bool matches(const Layout& layout)
+            {
+                return layout.Nx == NX && layout.Ny == NY &&
+                       (layout.guard_stride == 0 ||
+                        layout.guard_stride == guard_row) &&
+                       (layout.node_stride == 0 ||
+                        layout.node_stride == node_row);
+            }
+
+            inline std::size_t nx() const
+            {
+                return NX;
+            }
+
+            inline std::size_t ny() const
+            {
+                return NY;
+            }
+
+            inline std::size_t wrap_x(const long k) const
+            {
+                return wrap<NX>(k);
+            }
+
+            inline std::size_t wrap_y(const long k) const
+            {
+                return wrap<NY>(k);
+            }
+
+            inline long guard_stride() const
+            {
+                return long(guard_row);
+            }
+
+            inline long node_stride() const
+            {
+                return long(node_row);
+            }
+    };
+
+
+    template <typename... Dims>
+    struct List
+    {
+    };
+
+    // The fixed dimensions the kernels are compiled for
+    typedef List<PIC_FIXED_GRIDS> Fixed_Grids;
+
+    /**
+     * @brief Looks through a list of fixed dimensions for the first that
+     *        matches a layout
+     *
+     * @tparam Kernel Provides the type of the kernels and, in
+     *                get<Dims>(order), the kernel of a shape order compiled
+     *                for the dimensions Dims
+     * @tparam Grids The list of fixed dimensions left to try
+     */
+    template <typename Kernel, typename Grids>
+    struct Select;
+
+    template <typename Kernel>
+    struct Select<Kernel, List<> >
+    {
+        static inline typename Kernel::type get(const Layout&, const int order)
+        {
+            return Kernel::template get<Dynamic>(order);
+        }
+    };
+
+    template <typename Kernel, typename First, typename... Rest>
+    struct Select<Kernel, List<First, Rest...> >
+    {
+        static inline typename Kernel::type get(const Layout& layout,
+                                                const int order)
+        {
+            if (First::matches(layout))
+            {
+                return Kernel::template get<First>(order);
+            }
+
+            return Select<Kernel, List<Rest...> >::get(layout, order);
+        }
+    };
+
+    /**
+     * @brief Picks the kernel compiled for the fixed dimensions that match a
+     *        layout, or the one for dimensions known at run time if none do
+     *
+     * @tparam Kernel Provides the type and the instantiations of the kernel
+     * @param layout The layout of the grid the kernel will work on
+     * @param order Order of the particle shape function
+     * @return Kernel::type The kernel to call
+     */
+    template <typename Kernel>
+    inline typename Kernel::type select(const Layout& layout, const int order)
+    {
+        return Select<Kernel, Fixed_Grids>::get(layout, order);
+    }
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "GridObject.h"
 
+#include <algorithm>
+
 /**********************************************************
 CONSTRUCTORS/DESTRUCTORS
 ***********************************************************/
@@ -10,6 +12,8 @@ CONSTRUCTORS/DESTRUCTORS
  */
 GridObject::GridObject()
 {
+    this->Nx = 0;
+    this->Ny = 0;
 }
 
 /**
@@ -83,6 +87,30 @@ GridObject::GridObject(GridObject const &copy_obj)
     this->Nx = copy_obj.Nx;
     this->Ny = copy_obj.Ny;
     this->gridded_data = copy_obj.gridded_data;
+    this->n_guard = copy_obj.n_guard;
+    this->guard_stride = copy_obj.guard_stride;
+    this->guard_data = copy_obj.guard_data;
+}
+
+/**
+ * @brief Constructor for GridObject object - takes over the data of another
+ *        GridObject without copying it, leaving the other one empty
+ *
+ * @param move_obj GridObject to move from
+ */
+GridObject::GridObject(GridObject&& move_obj) noexcept
+{
+    this->Nx = move_obj.Nx;
+    this->Ny = move_obj.Ny;
+    this->gridded_data = std::move(move_obj.gridded_data);
+    this->n_guard = move_obj.n_guard;
+    this->guard_stride = move_obj.guard_stride;
+    this->guard_data = std::move(move_obj.guard_data);
+
+    move_obj.Nx = 0;
+    move_obj.Ny = 0;
+    move_obj.n_guard = 0;
+    move_obj.guard_stride = 0;
 }
 
 /**
@@ -95,6 +123,51 @@ GridObject::~GridObject()
 //-----------------------------------------
 
 
+/**********************************************************
+OPERATOR FUNCTIONS
+***********************************************************/
+
+/**
+ * @brief Overload copy assignment operator
+ *
+ * @param to_copy Object to copy values from
+ * @return GridObject& This object holding the copied values
+ */
+GridObject& GridObject::operator=(const GridObject& to_copy)
+{
+    Nx = to_copy.Nx;
+    Ny = to_copy.Ny;
+    gridded_data = to_copy.gridded_data;
+    n_guard = to_copy.n_guard;
+    guard_stride = to_copy.guard_stride;
+    guard_data = to_copy.guard_data;
+    return *this;
+}
+
+/**
+ * @brief Overload move assignment operator
+ *
+ * @param to_move Object to take the values from, left empty
+ * @return GridObject& This object holding the moved values
+ */
+GridObject& GridObject::operator=(GridObject&& to_move) noexcept
+{
+    Nx = to_move.Nx;
+    Ny = to_move.Ny;
+    gridded_data = std::move(to_move.gridded_data);
+    n_guard = to_move.n_guard;
+    guard_stride = to_move.guard_stride;
+    guard_data = std::move(to_move.guard_data);
+
+    to_move.Nx = 0;
+    to_move.Ny = 0;
+    to_move.n_guard = 0;
+    to_move.guard_stride = 0;
+    return *this;
+}
+//-----------------------------------------
+
+
 /**********************************************************
 CLASS METHODS
 ***********************************************************/
@@ -149,6 +222,70 @@ void GridObject::zero()
 {
     this->gridded_data.zero();
 }
+
+/**
+ * @brief Copies the grid into the grid with guard cells, filling the guard
+ *        cells with the values from the other side of the periodic grid
+ *
+ * @param n_guard Number of guard cells on each side
+ */
+void GridObject::exchange_guards(const std::size_t n_guard)
+{
+    this->_resize_guards(n_guard);
+
+    const long g = long(n_guard);
+
+    for (long a = -g; a < this->Nx + g; ++a)
+    {
+        const real_t* src = &this->gridded_data(wrap_index(a, this->Nx), 0);
+        real_t* dst = &this->guarded(a, 0);
+
+        std::copy(src, src + this->Ny, dst);
+        for (long c = 1; c <= g; ++c)
+        {
+            dst[-c] = src[wrap_index(-c, this->Ny)];
+            dst[this->Ny - 1 + c] = src[wrap_index(this->Ny - 1 + c,
+                                                   this->Ny)];
+        }
+    }
+}
+
+/**
+ * @brief Zeros the grid with guard cells, ready for a deposit into it
+ *
+ * @param n_guard Number of guard cells on each side
+ */
+void GridObject::zero_guards(const std::size_t n_guard)
+{
+    this->_resize_guards(n_guard);
+    std::fill(this->guard_data.begin(), this->guard_data.end(), 0.0);
+}
+
+/**
+ * @brief Adds the grid with guard cells onto the grid, adding each guard cell
+ *        to the grid point it is a periodic copy of
+ *
+ */
+void GridObject::fold_guards()
+{
+    const long g = long(this->n_guard);
+
+    for (long a = -g; a < this->Nx + g; ++a)
+    {
+        const real_t* src = &this->guarded(a, 0);
+        real_t* dst = &this->gridded_data(wrap_index(a, this->Nx), 0);
+
+        for (long c = 0; c < this->Ny; ++c)
+        {
+            dst[c] += src[c];
+        }
+        for (long c = 1; c <= g; ++c)
+        {
+            dst[wrap_index(-c, this->Ny)] += src[-c];
+            dst[wrap_index(this->Ny - 1 + c, this->Ny)] += src[this->Ny - 1 + c];
+        }
+    }
+}
 //-----------------------------------------
 
 
@@ -159,4 +296,17 @@ void GridObject::init_grid_obj(std::function<void(GridObject &, std::size_t, std
 {
     init_fcn(*this, this->Nx, this->Ny);
 }
+
+/**
+ * @brief Sizes the grid with guard cells for the given number of guard cells
+ *        on each side, keeping its storage if it does not change
+ *
+ * @param n_guard Number of guard cells on each side
+ */
+void GridObject::_resize_guards(const std::size_t n_guard)
+{
+    this->n_guard = n_guard;
+    this->guard_stride = padded_row(this->Ny + 2 * n_guard, sizeof(real_t));
+    this->guard_data.resize((this->Nx + 2 * n_guard) * this->guard_stride);
+}
 //-----------------------------------------
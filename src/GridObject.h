@@ -10,20 +10,97 @@
 
 #define MODULO(a, b) (int)((a % b) >= 0 ? (a % b) : (a % b) + b)
 
+/**
+ * @brief Wraps a grid index that may lie a few cells outside of the grid
+ *        back into it
+ *
+ * @param k The grid index
+ * @param N Number of grid spaces in that direction
+ * @return std::size_t The periodic image of k on the grid
+ */
+inline std::size_t wrap_index(long k, const std::size_t N)
+{
+    while (k < 0)
+    {
+        k += long(N);
+    }
+    while (k >= long(N))
+    {
+        k -= long(N);
+    }
+
+    return std::size_t(k);
+}
+
 /**
  * @brief A 2D Grid that can be used to store data
  *
  */
-class GridObject
+class GridObject : public Expr::Expression<GridObject>
 {
     private:
+        const char guard_err[48] = "Error: Grid index is outside of the guard cells";
+
+        // Copy of the grid with n_guard extra cells on every side, so that
+        // the particle kernels can reach past the edges without wrapping
+        // around the periodic boundaries. Point (i, j), for i from -n_guard
+        // to Nx + n_guard - 1 and likewise j, is stored at
+        // (i + n_guard) * guard_stride + j + n_guard, where guard_stride is
+        // the row of Ny + 2 * n_guard points padded by padded_row.
+        std::size_t n_guard = 0;
+        std::size_t guard_stride = 0;
+        cache_aligned_vector<real_t> guard_data;
+
         /**********************************************************
         PRIVATE CLASS METHODS
         ***********************************************************/
         void init_grid_obj(std::function<void(GridObject &, std::size_t, std::size_t)> init_fcn);
+        void _resize_guards(const std::size_t n_guard);
+
+        /**
+         * @brief Element-wise operation and assignment with an expression,
+         *        evaluated in one pass
+         *
+         * @tparam Op The element-wise operation
+         * @param expr Expression right of the operator
+         * @return GridObject& This object after operation
+         */
+        template <typename Op, typename E>
+        inline GridObject& compound_assign(const Expr::Expression<E>& expr)
+        {
+            static_assert(std::is_same<typename E::result_type, GridObject>::value,
+                          "Expression does not evaluate to a GridObject");
+
+            Expr::check_shape(*this, expr.self());
+            Expr::evaluate<Op>(this->gridded_data.get_data(), expr.self());
+
+            return *(this);
+        }
+
+        /**
+         * @brief Get the position of a grid point in the guard cell storage
+         *
+         * @param i x index of grid, from -n_guard to Nx + n_guard - 1
+         * @param j y index of grid, from -n_guard to Ny + n_guard - 1
+         * @return std::size_t Position in guard_data
+         */
+        inline std::size_t _guarded_index(const long i, const long j) const
+        {
+            const long g = long(this->n_guard);
+#if PIC_DEBUG
+            if (i < -g || i >= this->Nx + g || j < -g || j >= this->Ny + g)
+            {
+                throw std::out_of_range(guard_err);
+            }
+#endif
+            return std::size_t((i + g) * long(this->guard_stride) + j + g);
+        }
         //-----------------------------------------
 
     public:
+        typedef GridObject result_type;
+        typedef real_t value_type;
+
         DataStorage_2D gridded_data;
         int Nx, Ny;
 
@@ -38,15 +115,36 @@ class GridObject
         GridObject(std::size_t Nx, std::size_t Ny,
                    std::vector<double> data);   // a 'copy' constructor
         GridObject(GridObject const &copy_obj); // a copy constructor
+        GridObject(GridObject&& move_obj) noexcept; // a move constructor
         ~GridObject();
+
+        /**
+         * @brief Constructor for GridObject object - evaluates an expression
+         *        of GridObject objects in one pass
+         *
+         * @param expr Expression to evaluate
+         */
+        template <typename E>
+        GridObject(const Expr::Expression<E>& expr)
+        {
+            static_assert(std::is_same<typename E::result_type, GridObject>::value,
+                          "Expression does not evaluate to a GridObject");
+
+            const E& e = expr.self();
+            this->Nx = e.get_Ni_size(0);
+            this->Ny = e.get_Ni_size(1);
+            this->gridded_data = DataStorage_2D(this->Nx, this->Ny);
+
+            Expr::evaluate<Expr::Assign>(this->gridded_data.get_data(), e);
+        }
         //-----------------------------------------
 
 
         /**********************************************************
         ITERATOR FUNCTIONS
         ***********************************************************/
-        using iterator = std::vector<double>::iterator;
-        using const_iterator = std::vector<double>::const_iterator;
+        using iterator = DataStorage_2D::iterator;
+        using const_iterator = DataStorage_2D::const_iterator;
 
         inline iterator begin() noexcept
         {
@@ -70,12 +168,57 @@ class GridObject
         /**********************************************************
         OPERATOR FUNCTIONS
         ***********************************************************/
+        GridObject& operator=(const GridObject& to_copy);
+        GridObject& operator=(GridObject&& to_move) noexcept;
+
+        /**
+         * @brief Evaluates an expression into the grid in one pass, reusing
+         *        the storage when the shape is unchanged. The guard cells are
+         *        left as they were.
+         *
+         * @param expr Expression to evaluate
+         * @return GridObject& This object holding the result
+         */
+        template <typename E>
+        inline GridObject& operator=(const Expr::Expression<E>& expr)
+        {
+            static_assert(std::is_same<typename E::result_type, GridObject>::value,
+                          "Expression does not evaluate to a GridObject");
+
+            const E& e = expr.self();
+            if (std::size_t(this->Nx) != e.get_Ni_size(0) ||
+                std::size_t(this->Ny) != e.get_Ni_size(1))
+            {
+                this->Nx = e.get_Ni_size(0);
+                this->Ny = e.get_Ni_size(1);
+                this->gridded_data = DataStorage_2D(this->Nx, this->Ny);
+            }
+
+            Expr::evaluate<Expr::Assign>(this->gridded_data.get_data(), e);
+
+            return *(this);
+        }
+
+        /**
+         * @brief Returns the element at specified location idx of the grid
+         *        storage, for evaluating expressions
+         *
+         * @param idx Position of the element to return
+         * @return const real_t& Reference to the requested element
+         */
+        inline const real_t& operator[](const std::size_t idx) const
+        {
+            return this->gridded_data[idx];
+        }
+
         /**
          * @brief Overload the += operator for element-wise addition between
          *        GridObject objects
          *
+         * @param grid GridObject right of the operator
+         * @return GridObject& This object after operation
          */
-        inline GridObject operator+=(const GridObject& grid)
+        inline GridObject& operator+=(const GridObject& grid)
         {
             this->gridded_data += grid.gridded_data;
             return *(this);
@@ -85,12 +228,40 @@ class GridObject
          * @brief Overload the -= operator for element-wise subtraction between
          *        GridObject objects
          *
+         * @param grid GridObject right of the operator
+         * @return GridObject& This object after operation
          */
-        inline GridObject operator-=(const GridObject& grid)
+        inline GridObject& operator-=(const GridObject& grid)
         {
             this->gridded_data -= grid.gridded_data;
             return *(this);
         }
+
+        /**
+         * @brief Overload the += operator for element-wise addition of an
+         *        expression of GridObject objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return GridObject& This object after operation
+         */
+        template <typename E>
+        inline GridObject& operator+=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Add>(expr);
+        }
+
+        /**
+         * @brief Overload the -= operator for element-wise subtraction of an
+         *        expression of GridObject objects, evaluated in one pass
+         *
+         * @param expr Expression right of the operator
+         * @return GridObject& This object after operation
+         */
+        template <typename E>
+        inline GridObject& operator-=(const Expr::Expression<E>& expr)
+        {
+            return this->compound_assign<Expr::Subtract>(expr);
+        }
         //-----------------------------------------
 
 
@@ -109,7 +280,7 @@ class GridObject
         {
             index_x = MODULO(index_x, this->Nx);
             index_y = MODULO(index_y, this->Ny);
-            gridded_data.at(index_x, index_y) += val;
+            gridded_data(index_x, index_y) += val;
         }
 
         /**
@@ -124,7 +295,7 @@ class GridObject
         {
             index_x = MODULO(index_x, this->Nx);
             index_y = MODULO(index_y, this->Ny);
-            gridded_data.at(index_x, index_y) *= val;
+            gridded_data(index_x, index_y) *= val;
         }
 
 
@@ -139,7 +310,7 @@ class GridObject
         {
             index_x = MODULO(index_x, this->Nx);
             index_y = MODULO(index_y, this->Ny);
-            gridded_data.at(index_x, index_y) = val;
+            gridded_data(index_x, index_y) = val;
         }
 
         /**
@@ -153,7 +324,7 @@ class GridObject
         {
             index_x = MODULO(index_x, this->Nx);
             index_y = MODULO(index_y, this->Ny);
-            return gridded_data.at(index_x, index_y);
+            return gridded_data(index_x, index_y);
         }
 
         /**
@@ -198,6 +369,81 @@ class GridObject
             return gridded_data.get_Ni_size(i);
         }
 
+        /**
+         * @brief Get the total number of elements in the grid
+         *
+         * @return std::size_t The number of elements in the grid
+         */
+        inline std::size_t get_size() const
+        {
+            return gridded_data.get_size();
+        }
+
+        /**
+         * @brief Get the dimensionality of the grid
+         *
+         * @return std::size_t The dimensionality of the grid
+         */
+        inline std::size_t get_ndims() const
+        {
+            return gridded_data.get_ndims();
+        }
+
+
+        // Guard cells
+        void exchange_guards(const std::size_t n_guard);
+        void zero_guards(const std::size_t n_guard);
+        void fold_guards();
+
+        /**
+         * @brief Get the number of guard cells on each side of the grid,
+         *        which is 0 until they are first exchanged or zeroed
+         *
+         * @return std::size_t Number of guard cells on each side
+         */
+        inline std::size_t get_n_guard() const
+        {
+            return this->n_guard;
+        }
+
+        /**
+         * @brief Get the number of values from the start of a row of the
+         *        guard cell storage to the next
+         *
+         * @return std::size_t The row stride, 0 before the guard cells exist
+         */
+        inline std::size_t get_guard_stride() const
+        {
+            return this->guard_stride;
+        }
+
+        /**
+         * @brief Returns a reference to the copy of a grid point in the grid
+         *        with guard cells. Indices may be up to n_guard cells outside
+         *        of the grid, and are only checked in a debug build.
+         *
+         * @param i x index of grid, from -n_guard to Nx + n_guard - 1
+         * @param j y index of grid, from -n_guard to Ny + n_guard - 1
+         * @return real_t& Reference to the value in the guarded grid
+         */
+        inline real_t& guarded(const long i, const long j)
+        {
+            return this->guard_data[this->_guarded_index(i, j)];
+        }
+
+        /**
+         * @brief Returns a reference to the copy of a grid point in the grid
+         *        with guard cells. Indices may be up to n_guard cells outside
+         *        of the grid, and are only checked in a debug build.
+         *
+         * @param i x index of grid, from -n_guard to Nx + n_guard - 1
+         * @param j y index of grid, from -n_guard to Ny + n_guard - 1
+         * @return const real_t& Reference to the value in the guarded grid
+         */
+        inline const real_t& guarded(const long i, const long j) const
+        {
+            return this->guard_data[this->_guarded_index(i, j)];
+        }
 
         void print() const;
         void print_comp(std::size_t xi, std::size_t yj) const;
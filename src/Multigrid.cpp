@@ -0,0 +1,609 @@
+#include "Multigrid.h"
+
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * @brief Checks whether all four sides are periodic, which is all the
+ *        spectral solve can do
+ *
+ * @param boundaries The conditions on the sides
+ * @return true If they are all periodic
+ * @return false Otherwise
+ */
+bool Multigrid::is_periodic(const Multigrid::Boundaries& boundaries)
+{
+    return boundaries.x1_lo.type == Multigrid::Periodic &&
+           boundaries.x1_hi.type == Multigrid::Periodic &&
+           boundaries.x2_lo.type == Multigrid::Periodic &&
+           boundaries.x2_hi.type == Multigrid::Periodic;
+}
+
+
+/**********************************************************
+CONSTRUCTORS/DESTRUCTORS
+***********************************************************/
+
+/**
+ * @brief Constructor for an empty Poisson_2D, which solves nothing
+ *
+ */
+Multigrid::Poisson_2D::Poisson_2D()
+{
+    this->Nx = 0;
+    this->Ny = 0;
+    this->dx = 0.0;
+    this->dy = 0.0;
+
+    this->boundaries = Multigrid::periodic;
+    for (std::size_t k = 0; k < 4; ++k)
+    {
+        this->s[k] = 0.0;
+        this->b[k] = 0.0;
+    }
+    this->periodic_x1 = true;
+    this->periodic_x2 = true;
+    this->singular = true;
+
+    this->n_cycles = 0;
+
+    this->tolerance = Multigrid::default_tolerance;
+    this->max_cycles = 100;
+    this->n_pre = 2;
+    this->n_post = 2;
+    this->n_threads = 0;
+}
+
+/**
+ * @brief Constructor for Poisson_2D - makes the hierarchy of grids, starting
+ *        from a zero potential
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param dx Spatial grid step in x1
+ * @param dy Spatial grid step in x2
+ * @param boundaries The conditions on the four sides. A periodic side needs
+ *                   the opposite side to be periodic too.
+ */
+Multigrid::Poisson_2D::Poisson_2D(const std::size_t Nx, const std::size_t Ny,
+                                  const double dx, const double dy,
+                                  const Multigrid::Boundaries& boundaries)
+    : Poisson_2D()
+{
+    if ((boundaries.x1_lo.type == Multigrid::Periodic) !=
+        (boundaries.x1_hi.type == Multigrid::Periodic) ||
+        (boundaries.x2_lo.type == Multigrid::Periodic) !=
+        (boundaries.x2_hi.type == Multigrid::Periodic))
+    {
+        throw std::runtime_error(Multigrid::boundary_err);
+    }
+
+    this->Nx = Nx;
+    this->Ny = Ny;
+    this->dx = dx;
+    this->dy = dy;
+    this->boundaries = boundaries;
+
+    this->periodic_x1 = boundaries.x1_lo.type == Multigrid::Periodic;
+    this->periodic_x2 = boundaries.x2_lo.type == Multigrid::Periodic;
+
+    // The wall is halfway between the ghost and the value next to it: a
+    // Dirichlet ghost is 2 value - phi, a Neumann ghost phi + h value
+    const Multigrid::Boundary* sides[4] = {&boundaries.x1_lo,
+                                           &boundaries.x1_hi,
+                                           &boundaries.x2_lo,
+                                           &boundaries.x2_hi};
+    const double h[4] = {dx, dx, dy, dy};
+    this->singular = true;
+    for (std::size_t k = 0; k < 4; ++k)
+    {
+        switch (sides[k]->type)
+        {
+            case Multigrid::Dirichlet:
+                this->s[k] = -1.0;
+                this->b[k] = 2.0 * sides[k]->value;
+                this->singular = false;
+                break;
+            case Multigrid::Neumann:
+                this->s[k] = 1.0;
+                this->b[k] = h[k] * sides[k]->value;
+                break;
+            default:
+                this->s[k] = 0.0;
+                this->b[k] = 0.0;
+                break;
+        }
+    }
+
+    std::size_t nx = Nx, ny = Ny;
+    double hx = dx, hy = dy;
+    while (true)
+    {
+        Level level;
+        level.nx = nx;
+        level.ny = ny;
+        level.dx = hx;
+        level.dy = hy;
+        level.phi.assign((nx + 2) * (ny + 2), 0.0);
+        level.rhs.assign((nx + 2) * (ny + 2), 0.0);
+        level.res.assign((nx + 2) * (ny + 2), 0.0);
+        this->levels.push_back(level);
+
+        if (nx % 2 || ny % 2 || nx < 4 || ny < 4)
+        {
+            break;
+        }
+        nx /= 2;
+        ny /= 2;
+        hx *= 2.0;
+        hy *= 2.0;
+    }
+}
+//-----------------------------------------
+
+
+/**********************************************************
+CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Solves for the potential of a charge density, from the potential of
+ *        the last solve, and takes the electric field from it. Without a
+ *        Dirichlet side the potential is only defined up to a constant, so
+ *        the mean of the sources is taken out, as the spectral solve does,
+ *        and the potential is kept at zero mean.
+ *
+ * @param density The charge density, an Nx by Ny grid
+ * @param E_x1 Set to the x1 component of the electric field
+ * @param E_x2 Set to the x2 component of the electric field
+ * @param U Set to the sum of rho phi over the grid, times Nx Ny to match the
+ *          energy of the spectral solve
+ * @return int An error code or 0 if it worked correctly. It is 1 if the
+ *             residual did not reach the tolerance in max_cycles V-cycles.
+ */
+int Multigrid::Poisson_2D::solve(const GridObject& density,
+                                 GridObject& E_x1, GridObject& E_x2,
+                                 double& U)
+{
+    int err = 0;
+
+    if (this->levels.empty() ||
+        std::size_t(density.get_Nx()) != this->Nx ||
+        std::size_t(density.get_Ny()) != this->Ny)
+    {
+        return 1;
+    }
+    if (std::size_t(E_x1.get_Nx()) != this->Nx ||
+        std::size_t(E_x1.get_Ny()) != this->Ny)
+    {
+        E_x1 = GridObject(this->Nx, this->Ny);
+        E_x2 = GridObject(this->Nx, this->Ny);
+    }
+
+    const int nt = Threads::resolve(this->n_threads);
+    Level& fine = this->levels[0];
+    const std::size_t nx = fine.nx, ny = fine.ny;
+    const std::size_t S = ny + 2;
+    const double cx = 1.0 / (fine.dx * fine.dx);
+    const double cy = 1.0 / (fine.dy * fine.dy);
+
+    for (std::size_t i = 0; i < nx; ++i)
+    {
+        for (std::size_t j = 0; j < ny; ++j)
+        {
+            fine.rhs[(i + 1) * S + j + 1] = density.gridded_data(i, j);
+        }
+    }
+
+    // Without a Dirichlet side the sources, including the flux through
+    // Neumann walls, have to add up to zero
+    if (this->singular)
+    {
+        this->_remove_mean(0, fine.rhs);
+
+        const double walls = (cx * (this->b[0] + this->b[1]) / double(nx) +
+                              cy * (this->b[2] + this->b[3]) / double(ny));
+        for (std::size_t i = 1; i <= nx; ++i)
+        {
+            for (std::size_t j = 1; j <= ny; ++j)
+            {
+                fine.rhs[i * S + j] -= walls;
+            }
+        }
+    }
+
+    // The walls act as sources on the values next to them
+    double source = 0.0;
+    for (std::size_t i = 0; i < nx; ++i)
+    {
+        for (std::size_t j = 0; j < ny; ++j)
+        {
+            double f = fine.rhs[(i + 1) * S + j + 1];
+            f += cx * (double(i == 0) * this->b[0] +
+                       double(i == nx - 1) * this->b[1]);
+            f += cy * (double(j == 0) * this->b[2] +
+                       double(j == ny - 1) * this->b[3]);
+            source += f * f;
+        }
+    }
+
+    this->n_cycles = 0;
+    if (source == 0.0)
+    {
+        fine.phi.assign(fine.phi.size(), 0.0);
+    }
+    while (source > 0.0)
+    {
+        const double residual = this->_residual(0, nt);
+        if (residual <= this->tolerance * this->tolerance * source)
+        {
+            break;
+        }
+        if (this->n_cycles == this->max_cycles)
+        {
+            err = 1;
+            break;
+        }
+
+        this->_v_cycle(0, nt);
+        if (this->singular)
+        {
+            this->_remove_mean(0, fine.phi);
+        }
+        ++this->n_cycles;
+    }
+
+    // E = -grad(phi), with the ghosts holding the walls
+    this->_fill_ghosts(0, fine.phi, true);
+
+    const real_t ex_fac = -0.5 / fine.dx;
+    const real_t ey_fac = -0.5 / fine.dy;
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t i = 0; i < nx; ++i)
+    {
+        const double* p = &fine.phi[(i + 1) * S + 1];
+        real_t* ex = &E_x1.gridded_data(i, 0);
+        real_t* ey = &E_x2.gridded_data(i, 0);
+
+        #pragma omp simd
+        for (std::size_t j = 0; j < ny; ++j)
+        {
+            ex[j] = ex_fac * (p[j + S] - p[j - S]);
+            ey[j] = ey_fac * (p[j + 1] - p[j - 1]);
+        }
+    }
+
+    // Summed in a fixed order so it does not depend on the number of threads
+    U = 0.0;
+    for (std::size_t i = 0; i < nx; ++i)
+    {
+        for (std::size_t j = 0; j < ny; ++j)
+        {
+            U += fine.rhs[(i + 1) * S + j + 1] * fine.phi[(i + 1) * S + j + 1];
+        }
+    }
+    U *= double(nx) * double(ny);
+
+    return err;
+}
+
+/**
+ * @brief Checks whether the solver is for a grid geometry
+ *
+ * @param Nx Number of grid points in x1
+ * @param Ny Number of grid points in x2
+ * @param dx Spatial grid step in x1
+ * @param dy Spatial grid step in x2
+ * @return true If it is
+ * @return false Otherwise
+ */
+bool Multigrid::Poisson_2D::matches(const std::size_t Nx, const std::size_t Ny,
+                                    const double dx, const double dy) const
+{
+    return this->Nx == Nx && this->Ny == Ny &&
+           this->dx == dx && this->dy == dy;
+}
+//-----------------------------------------
+
+
+/**********************************************************
+PRIVATE CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Sets the ghost cells of a grid of level l. Periodic sides copy the
+ *        other side. The ghosts of wall sides are either only their constant
+ *        part b, which is how the smoother and the residual use them, or
+ *        their whole value, to take differences across the wall.
+ *
+ * @param l The level of the grid
+ * @param v The values of the grid, with their ghosts
+ * @param walls Whether to set the whole ghost values of the walls
+ */
+void Multigrid::Poisson_2D::_fill_ghosts(const std::size_t l,
+                                         std::vector<double>& v,
+                                         const bool walls) const
+{
+    const Level& level = this->levels[l];
+    const std::size_t nx = level.nx, ny = level.ny;
+    const std::size_t S = ny + 2;
+
+    // Only the finest grid has the values of the walls; the coarse grids
+    // hold corrections, which are zero on the walls
+    const double w = walls ? 1.0 : 0.0;
+    const double c = (l == 0) ? 1.0 : 0.0;
+
+    for (std::size_t j = 1; j <= ny; ++j)
+    {
+        if (this->periodic_x1)
+        {
+            v[j] = v[nx * S + j];
+            v[(nx + 1) * S + j] = v[S + j];
+        }
+        else
+        {
+            v[j] = w * this->s[0] * v[S + j] + c * this->b[0];
+            v[(nx + 1) * S + j] = w * this->s[1] * v[nx * S + j] +
+                                  c * this->b[1];
+        }
+    }
+
+    // Along the ghost rows too, which sets the corners
+    for (std::size_t i = 0; i <= nx + 1; ++i)
+    {
+        double* row = &v[i * S];
+        if (this->periodic_x2)
+        {
+            row[0] = row[ny];
+            row[ny + 1] = row[1];
+        }
+        else
+        {
+            row[0] = w * this->s[2] * row[1] + c * this->b[2];
+            row[ny + 1] = w * this->s[3] * row[ny] + c * this->b[3];
+        }
+    }
+}
+
+/**
+ * @brief Does one red-black Gauss-Seidel sweep of a grid: the values with
+ *        i + j even, then the others. Each value only depends on values of
+ *        the other colour, so the rows of a colour can be done in parallel.
+ *        The part of a wall ghost that depends on the value next to it is
+ *        folded into the diagonal, so walls are solved exactly.
+ *
+ * @param l The level of the grid
+ * @param nt Number of threads
+ */
+void Multigrid::Poisson_2D::_relax(const std::size_t l, const int nt)
+{
+    Level& level = this->levels[l];
+    const std::size_t nx = level.nx, ny = level.ny;
+    const std::size_t S = ny + 2;
+    const double cx = 1.0 / (level.dx * level.dx);
+    const double cy = 1.0 / (level.dy * level.dy);
+
+    for (std::size_t colour = 0; colour < 2; ++colour)
+    {
+        this->_fill_ghosts(l, level.phi, false);
+
+        #pragma omp parallel for num_threads(nt) schedule(static)
+        for (std::size_t i = 0; i < nx; ++i)
+        {
+            double* p = &level.phi[(i + 1) * S + 1];
+            const double* f = &level.rhs[(i + 1) * S + 1];
+            const double diag_i = 2.0 * (cx + cy) -
+                                  cx * (double(i == 0) * this->s[0] +
+                                        double(i == nx - 1) * this->s[1]);
+
+            for (std::size_t j = (i + colour) % 2; j < ny; j += 2)
+            {
+                const double diag = diag_i -
+                                    cy * (double(j == 0) * this->s[2] +
+                                          double(j == ny - 1) * this->s[3]);
+                p[j] = (f[j] + cx * (p[j - S] + p[j + S]) +
+                        cy * (p[j - 1] + p[j + 1])) / diag;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes the residual rhs + laplacian(phi) of a grid
+ *
+ * @param l The level of the grid
+ * @param nt Number of threads
+ * @return double The sum of the squares of the residual
+ */
+double Multigrid::Poisson_2D::_residual(const std::size_t l, const int nt)
+{
+    Level& level = this->levels[l];
+    const std::size_t nx = level.nx, ny = level.ny;
+    const std::size_t S = ny + 2;
+    const double cx = 1.0 / (level.dx * level.dx);
+    const double cy = 1.0 / (level.dy * level.dy);
+
+    this->_fill_ghosts(l, level.phi, false);
+
+    double sum = 0.0;
+    #pragma omp parallel for num_threads(nt) schedule(static) reduction(+:sum)
+    for (std::size_t i = 0; i < nx; ++i)
+    {
+        const double* p = &level.phi[(i + 1) * S + 1];
+        const double* f = &level.rhs[(i + 1) * S + 1];
+        double* r = &level.res[(i + 1) * S + 1];
+        const double diag_i = 2.0 * (cx + cy) -
+                              cx * (double(i == 0) * this->s[0] +
+                                    double(i == nx - 1) * this->s[1]);
+
+        for (std::size_t j = 0; j < ny; ++j)
+        {
+            const double diag = diag_i -
+                                cy * (double(j == 0) * this->s[2] +
+                                      double(j == ny - 1) * this->s[3]);
+            r[j] = f[j] - (diag * p[j] - cx * (p[j - S] + p[j + S]) -
+                           cy * (p[j - 1] + p[j + 1]));
+            sum += r[j] * r[j];
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Averages the residual of grid l over each 2 by 2 block of cells to
+ *        make the source of grid l + 1, whose correction starts at zero
+ *
+ * @param l The level of the fine grid
+ * @param nt Number of threads
+ */
+void Multigrid::Poisson_2D::_restrict(const std::size_t l, const int nt)
+{
+    const Level& fine = this->levels[l];
+    Level& coarse = this->levels[l + 1];
+    const std::size_t S_f = fine.ny + 2, S_c = coarse.ny + 2;
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t I = 0; I < coarse.nx; ++I)
+    {
+        const double* r0 = &fine.res[(2 * I + 1) * S_f + 1];
+        const double* r1 = r0 + S_f;
+        double* f = &coarse.rhs[(I + 1) * S_c + 1];
+
+        for (std::size_t J = 0; J < coarse.ny; ++J)
+        {
+            f[J] = 0.25 * (r0[2 * J] + r0[2 * J + 1] +
+                           r1[2 * J] + r1[2 * J + 1]);
+        }
+    }
+
+    coarse.phi.assign(coarse.phi.size(), 0.0);
+    if (this->singular)
+    {
+        this->_remove_mean(l + 1, coarse.rhs);
+    }
+}
+
+/**
+ * @brief Interpolates the correction of grid l + 1 bilinearly onto grid l and
+ *        adds it. Each fine cell is a quarter of a coarse cell and takes 9/16
+ *        of it, 3/16 of each of its two nearest neighbours and 1/16 of the
+ *        diagonal one.
+ *
+ * @param l The level of the fine grid
+ * @param nt Number of threads
+ */
+void Multigrid::Poisson_2D::_correct(const std::size_t l, const int nt)
+{
+    Level& fine = this->levels[l];
+    Level& coarse = this->levels[l + 1];
+    const std::size_t S_f = fine.ny + 2, S_c = coarse.ny + 2;
+
+    this->_fill_ghosts(l + 1, coarse.phi, true);
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t i = 0; i < fine.nx; ++i)
+    {
+        const double* c0 = &coarse.phi[(i / 2 + 1) * S_c + 1];
+        const double* c1 = (i % 2) ? c0 + S_c : c0 - S_c;
+        double* p = &fine.phi[(i + 1) * S_f + 1];
+
+        for (std::size_t j = 0; j < fine.ny; ++j)
+        {
+            // The nearest coarse neighbour in x2, which may be a ghost
+            const std::ptrdiff_t J = j / 2;
+            const std::ptrdiff_t K = (j % 2) ? J + 1 : J - 1;
+            p[j] += 0.0625 * (9.0 * c0[J] + 3.0 * (c1[J] + c0[K]) + c1[K]);
+        }
+    }
+}
+
+/**
+ * @brief Solves the coarsest grid by relaxing it until its residual is a
+ *        millionth of what it was
+ *
+ * @param l The level of the coarsest grid
+ * @param nt Number of threads
+ */
+void Multigrid::Poisson_2D::_solve_coarsest(const std::size_t l, const int nt)
+{
+    const Level& level = this->levels[l];
+    const double start = this->_residual(l, nt);
+    const std::size_t max_sweeps = 4 * level.nx * level.ny + 16;
+
+    for (std::size_t sweep = 1; sweep <= max_sweeps; ++sweep)
+    {
+        this->_relax(l, nt);
+        if (sweep % 4 == 0 && this->_residual(l, nt) <= 1e-6 * start)
+        {
+            break;
+        }
+    }
+
+    if (this->singular)
+    {
+        this->_remove_mean(l, this->levels[l].phi);
+    }
+}
+
+/**
+ * @brief Does one V-cycle from grid l down to the coarsest and back
+ *
+ * @param l The level to start from
+ * @param nt Number of threads
+ */
+void Multigrid::Poisson_2D::_v_cycle(const std::size_t l, const int nt)
+{
+    if (l + 1 == this->levels.size())
+    {
+        this->_solve_coarsest(l, nt);
+        return;
+    }
+
+    for (std::size_t n = 0; n < this->n_pre; ++n)
+    {
+        this->_relax(l, nt);
+    }
+
+    this->_residual(l, nt);
+    this->_restrict(l, nt);
+    this->_v_cycle(l + 1, nt);
+    this->_correct(l, nt);
+
+    for (std::size_t n = 0; n < this->n_post; ++n)
+    {
+        this->_relax(l, nt);
+    }
+}
+
+/**
+ * @brief Takes the mean out of the values of a grid, summed in a fixed order
+ *
+ * @param l The level of the grid
+ * @param v The values of the grid, with their ghosts
+ */
+void Multigrid::Poisson_2D::_remove_mean(const std::size_t l,
+                                         std::vector<double>& v)
+{
+    const Level& level = this->levels[l];
+    const std::size_t S = level.ny + 2;
+
+    double sum = 0.0;
+    for (std::size_t i = 1; i <= level.nx; ++i)
+    {
+        for (std::size_t j = 1; j <= level.ny; ++j)
+        {
+            sum += v[i * S + j];
+        }
+    }
+
+    const double mean = sum / (double(level.nx) * double(level.ny));
+    for (std::size_t i = 1; i <= level.nx; ++i)
+    {
+        for (std::size_t j = 1; j <= level.ny; ++j)
+        {
+            v[i * S + j] -= mean;
+        }
+    }
+}
+//-----------------------------------------
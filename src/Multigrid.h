@@ -0,0 +1,166 @@
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+#include <vector>
+
+#include "GridObject.h"
+#include "Precision.h"
+#include "Threads.h"
+
+/**
+ * @brief A matrix-free geometric multigrid solver of the Poisson equation
+ *        -laplacian(phi) = rho, for grids whose sides need not be periodic.
+ *        The grid values are taken at the centres of the cells, so a wall is
+ *        half a cell outside the first and last grid points, and the grid
+ *        spans the same length as a periodic one. The discretization is the
+ *        5-point Laplacian of the spectral solve, and E = -grad(phi) is the
+ *        same centred difference, so with periodic boundaries both solvers
+ *        give the same field.
+ *
+ *        The boundaries only apply to the field: Field fills the guard cells
+ *        past a wall with the mirror image of the field, but the particles
+ *        still wrap around the grid, and so does the charge they deposit
+ *        past a wall.
+ *
+ */
+namespace Multigrid
+{
+    const char boundary_err[55] =
+        "Error: a periodic boundary needs the opposite side too";
+
+    enum Boundary_Type
+    {
+        Periodic,
+        Dirichlet,  // the potential on the wall
+        Neumann     // the derivative of the potential out of the wall
+    };
+
+    // Condition on one side of the grid, with its value for Dirichlet and
+    // Neumann sides
+    struct Boundary
+    {
+        Boundary_Type type;
+        double value;
+    };
+
+    // Conditions on the four sides, at the low and high ends of x1 and x2
+    struct Boundaries
+    {
+        Boundary x1_lo, x1_hi, x2_lo, x2_hi;
+    };
+
+    const Boundaries periodic = {{Periodic, 0.0}, {Periodic, 0.0},
+                                 {Periodic, 0.0}, {Periodic, 0.0}};
+
+    // Residual the solve stops at, relative to the source, in the storage
+    // precision
+    const double default_tolerance = PIC_SINGLE_PRECISION ? 1e-6 : 1e-10;
+
+    bool is_periodic(const Multigrid::Boundaries& boundaries);
+
+    /**
+     * @brief Multigrid solver for one grid and set of boundary conditions.
+     *        Each V-cycle smooths with red-black Gauss-Seidel, restricts the
+     *        residual to a grid of half the cells in each direction, and
+     *        interpolates the correction back bilinearly. Grids are halved
+     *        while both sides have an even number of cells; the coarsest is
+     *        relaxed until it is solved, so sizes with many factors of 2
+     *        work best.
+     *
+     *        The potential is kept between solves and is the first guess of
+     *        the next one, so a density that changes little from one step to
+     *        the next needs few cycles. The rows of every pass are shared out
+     *        between n_threads threads.
+     *
+     */
+    class Poisson_2D
+    {
+        private:
+            // One grid of the hierarchy, with a layer of ghost cells around
+            // it: value (i, j) is at (i + 1) * (ny + 2) + j + 1
+            struct Level
+            {
+                std::size_t nx, ny;
+                double dx, dy;
+                std::vector<double> phi, rhs, res;
+            };
+
+            std::size_t Nx, Ny;
+            double dx, dy;
+
+            Multigrid::Boundaries boundaries;
+
+            // Ghost value of a wall side, s times the value next to it plus
+            // b, in the order x1_lo, x1_hi, x2_lo, x2_hi. The corrections of
+            // the coarse grids have b = 0. Periodic sides have s = 0 and copy
+            // the other side instead.
+            double s[4];
+            double b[4];
+            bool periodic_x1, periodic_x2;
+
+            // Whether the potential is only defined up to a constant
+            bool singular;
+
+            std::vector<Level> levels;
+
+            std::size_t n_cycles;
+
+            /**********************************************************
+            PRIVATE CLASS METHODS
+            ***********************************************************/
+            void _fill_ghosts(const std::size_t l, std::vector<double>& v,
+                              const bool walls) const;
+            void _relax(const std::size_t l, const int nt);
+            double _residual(const std::size_t l, const int nt);
+            void _restrict(const std::size_t l, const int nt);
+            void _correct(const std::size_t l, const int nt);
+            void _solve_coarsest(const std::size_t l, const int nt);
+            void _v_cycle(const std::size_t l, const int nt);
+            void _remove_mean(const std::size_t l, std::vector<double>& v);
+            //-----------------------------------------
+
+        public:
+            double tolerance;           // of the residual, relative to the source
+            std::size_t max_cycles;     // solve gives up after this many
+            std::size_t n_pre, n_post;  // smoothing sweeps of each V-cycle
+            std::size_t n_threads;      // 0 uses the OpenMP default
+
+            /**********************************************************
+            CONSTRUCTORS/DESTRUCTORS
+            ***********************************************************/
+            Poisson_2D();
+            Poisson_2D(const std::size_t Nx, const std::size_t Ny,
+                       const double dx, const double dy,
+                       const Multigrid::Boundaries& boundaries);
+            //-----------------------------------------
+
+
+            /**********************************************************
+            CLASS METHODS
+            ***********************************************************/
+            int solve(const GridObject& density,
+                      GridObject& E_x1, GridObject& E_x2, double& U);
+
+            bool matches(const std::size_t Nx, const std::size_t Ny,
+                         const double dx, const double dy) const;
+
+            inline const Multigrid::Boundaries& get_boundaries() const
+            {
+                return this->boundaries;
+            }
+
+            inline std::size_t get_n_levels() const
+            {
+                return this->levels.size();
+            }
+
+            // V-cycles done by the last solve
+            inline std::size_t get_n_cycles() const
+            {
+                return this->n_cycles;
+            }
+            //-----------------------------------------
+    };
+}
+
+#endif
@@ -55,8 +55,10 @@ Particle::Particle(double pos_x, double pos_y, double pos_z, double mom_x, doubl
     this->pos = ThreeVec(pos_x, pos_y, pos_z);
     this->mom = ThreeVec(mom_x, mom_y, mom_z);
     this->weight = weight;
+#if PIC_FIELD_CACHE
     this->local_e_field = ThreeVec();
     this->local_b_field = ThreeVec();
+#endif
 }
 
 /**
@@ -144,6 +146,7 @@ void Particle::print_weight() const
     std::cout << this->get_weight() << std::endl;
 }
 
+#if PIC_FIELD_CACHE
 /**
  * @brief Print the local electric field the particle sees
  *
@@ -181,4 +184,5 @@ void Particle::print_local_b_field_comp(std::size_t i) const
 {
     this->get_local_b_field().print_comp(i);
 }
+#endif
 //-----------------------------------------
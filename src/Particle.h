@@ -5,6 +5,13 @@
 
 #include "ThreeVec.h"
 
+// The per-particle field cache is only needed when the field is mapped to the
+// particles in a separate pass from the push. It is compiled out by default,
+// as in the Makefile, so build every object with PIC_FIELD_CACHE=1 to use it.
+#ifndef PIC_FIELD_CACHE
+#define PIC_FIELD_CACHE 0
+#endif
+
 /**
  * @brief A particle class with all of the attributes a particle can have
  *
@@ -14,8 +21,10 @@ class Particle
     private:
         ThreeVec pos;
         ThreeVec mom;
+#if PIC_FIELD_CACHE
         ThreeVec local_e_field;
         ThreeVec local_b_field;
+#endif
 
         double weight;
 
@@ -92,6 +101,7 @@ class Particle
             return this->weight;
         }
 
+#if PIC_FIELD_CACHE
         /**
          * @brief Get vector containing the local electric field the particle
          *        sees
@@ -135,6 +145,7 @@ class Particle
         {
             return this->local_b_field.get(i);
         }
+#endif
 
 
         // Setter Functions
@@ -220,6 +231,7 @@ class Particle
             this->weight = weight;
         }
 
+#if PIC_FIELD_CACHE
         /**
          * @brief Copy values from a vector to set the local electric field the
          *        particle sees
@@ -299,6 +311,7 @@ class Particle
         {
             this->local_b_field.set_all(x1, x2, x3);
         }
+#endif
 
 
         // Print Functions
@@ -310,11 +323,13 @@ class Particle
 
         void print_weight() const;
 
+#if PIC_FIELD_CACHE
         void print_local_e_field() const;
         void print_local_e_field_comp(std::size_t i) const;
 
         void print_local_b_field() const;
         void print_local_b_field_comp(std::size_t i) const;
+#endif
         //-----------------------------------------
 };
 
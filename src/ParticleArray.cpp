@@ -0,0 +1,273 @@
+#include "ParticleArray.h"
+
+/**********************************************************
+CONSTRUCTORS/DESTRUCTORS
+***********************************************************/
+
+/**
+ * @brief Constructor for ParticleArray object - empty and without a field
+ *        cache
+ *
+ */
+ParticleArray::ParticleArray() : ParticleArray(0)
+{
+}
+
+/**
+ * @brief Constructor for ParticleArray object - the field cache is left
+ *        unallocated
+ *
+ * @param capacity Number of particles to reserve space for
+ */
+ParticleArray::ParticleArray(std::size_t capacity)
+{
+    this->n_par = 0;
+#if PIC_FIELD_CACHE
+    this->field_cache = false;
+#endif
+
+    this->reserve(capacity);
+}
+
+/**
+ * @brief Destructor for ParticleArray object
+ *
+ */
+ParticleArray::~ParticleArray()
+{
+}
+//-----------------------------------------
+
+
+/**********************************************************
+CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Reserves space for a number of particles in every array
+ *
+ * @param capacity Number of particles to reserve space for
+ */
+void ParticleArray::reserve(std::size_t capacity)
+{
+    this->x.reserve(capacity);
+    this->y.reserve(capacity);
+    this->z.reserve(capacity);
+    this->px.reserve(capacity);
+    this->py.reserve(capacity);
+    this->pz.reserve(capacity);
+    this->w.reserve(capacity);
+
+#if PIC_FIELD_CACHE
+    if (this->field_cache)
+    {
+        this->ex.reserve(capacity);
+        this->ey.reserve(capacity);
+        this->ez.reserve(capacity);
+        this->bx.reserve(capacity);
+        this->by.reserve(capacity);
+        this->bz.reserve(capacity);
+    }
+#endif
+}
+
+/**
+ * @brief Moves every attribute array to storage first written by the threads
+ *        that work on it, each taking the blocks of chunk particles a static
+ *        OpenMP schedule gives it (see first_touch). The reordering buffer is
+ *        placed the same way, so that sorting keeps the placement.
+ *
+ * @param chunk Number of particles in a block
+ * @param nt Number of threads
+ */
+void ParticleArray::place(const std::size_t chunk, const int nt)
+{
+    first_touch(this->x, chunk, nt);
+    first_touch(this->y, chunk, nt);
+    first_touch(this->z, chunk, nt);
+    first_touch(this->px, chunk, nt);
+    first_touch(this->py, chunk, nt);
+    first_touch(this->pz, chunk, nt);
+    first_touch(this->w, chunk, nt);
+
+#if PIC_FIELD_CACHE
+    if (this->field_cache)
+    {
+        first_touch(this->ex, chunk, nt);
+        first_touch(this->ey, chunk, nt);
+        first_touch(this->ez, chunk, nt);
+        first_touch(this->bx, chunk, nt);
+        first_touch(this->by, chunk, nt);
+        first_touch(this->bz, chunk, nt);
+    }
+#endif
+
+    // The values of the reordering buffer do not matter
+    this->reorder_scratch.assign(this->x.begin(), this->x.end());
+    first_touch(this->reorder_scratch, chunk, nt);
+}
+
+/**
+ * @brief Appends a new particle to the end of the arrays
+ *
+ * @param x_pos The physical x position of the particle
+ * @param y_pos The physical y position of the particle
+ * @param z_pos The physical z position of the particle
+ * @param x_mom The physical x momentum of the particle
+ * @param y_mom The physical y momentum of the particle
+ * @param z_mom The physical z momentum of the particle
+ * @param weight The weight of the particle
+ */
+void ParticleArray::push_back(double x_pos, double y_pos, double z_pos,
+                              double x_mom, double y_mom, double z_mom,
+                              double weight)
+{
+    this->x.push_back(x_pos);
+    this->y.push_back(y_pos);
+    this->z.push_back(z_pos);
+    this->px.push_back(x_mom);
+    this->py.push_back(y_mom);
+    this->pz.push_back(z_mom);
+    this->w.push_back(weight);
+
+#if PIC_FIELD_CACHE
+    if (this->field_cache)
+    {
+        this->ex.push_back(0.0);
+        this->ey.push_back(0.0);
+        this->ez.push_back(0.0);
+        this->bx.push_back(0.0);
+        this->by.push_back(0.0);
+        this->bz.push_back(0.0);
+    }
+#endif
+
+    ++(this->n_par);
+}
+
+/**
+ * @brief Appends a new particle to the end of the arrays
+ *
+ * @param p The particle to copy the attributes from
+ */
+void ParticleArray::push_back(const Particle& p)
+{
+    this->push_back(p.get_pos_comp(0), p.get_pos_comp(1), p.get_pos_comp(2),
+                    p.get_mom_comp(0), p.get_mom_comp(1), p.get_mom_comp(2),
+                    p.get_weight());
+
+#if PIC_FIELD_CACHE
+    if (this->field_cache)
+    {
+        this->set_local_e_field(this->n_par - 1,
+                                p.get_local_e_field_comp(0),
+                                p.get_local_e_field_comp(1),
+                                p.get_local_e_field_comp(2));
+        this->set_local_b_field(this->n_par - 1,
+                                p.get_local_b_field_comp(0),
+                                p.get_local_b_field_comp(1),
+                                p.get_local_b_field_comp(2));
+    }
+#endif
+}
+
+#if PIC_FIELD_CACHE
+/**
+ * @brief Allocates the per-particle field cache, initialized to 0, if it is
+ *        not already allocated
+ *
+ */
+void ParticleArray::enable_field_cache()
+{
+    if (this->field_cache)
+    {
+        return;
+    }
+
+    this->field_cache = true;
+
+    this->ex.assign(this->n_par, 0.0);
+    this->ey.assign(this->n_par, 0.0);
+    this->ez.assign(this->n_par, 0.0);
+    this->bx.assign(this->n_par, 0.0);
+    this->by.assign(this->n_par, 0.0);
+    this->bz.assign(this->n_par, 0.0);
+}
+#endif
+
+/**
+ * @brief Reorders the particles so that the kth particle afterwards is the
+ *        order[k]th particle from before
+ *
+ * @param order A permutation of the particle indices
+ */
+void ParticleArray::reorder(const std::vector<std::size_t>& order)
+{
+    this->_reorder_array(this->x, order);
+    this->_reorder_array(this->y, order);
+    this->_reorder_array(this->z, order);
+    this->_reorder_array(this->px, order);
+    this->_reorder_array(this->py, order);
+    this->_reorder_array(this->pz, order);
+    this->_reorder_array(this->w, order);
+
+#if PIC_FIELD_CACHE
+    if (this->field_cache)
+    {
+        this->_reorder_array(this->ex, order);
+        this->_reorder_array(this->ey, order);
+        this->_reorder_array(this->ez, order);
+        this->_reorder_array(this->bx, order);
+        this->_reorder_array(this->by, order);
+        this->_reorder_array(this->bz, order);
+    }
+#endif
+}
+
+/**
+ * @brief Gathers the attributes of the ith particle into a Particle object
+ *
+ * @param i Index of the particle
+ * @return Particle A copy of the ith particle
+ */
+Particle ParticleArray::get_particle(std::size_t i) const
+{
+    Particle p(this->get_pos(i), this->get_mom(i), this->w[i]);
+
+#if PIC_FIELD_CACHE
+    if (this->field_cache)
+    {
+        p.set_local_e_field(this->get_local_e_field(i));
+        p.set_local_b_field(this->get_local_b_field(i));
+    }
+#endif
+
+    return p;
+}
+//-----------------------------------------
+
+
+/**********************************************************
+PRIVATE CLASS METHODS
+***********************************************************/
+
+/**
+ * @brief Applies a permutation to a single particle attribute array. The old
+ *        storage is kept as the scratch buffer for the next array.
+ *
+ * @param arr The attribute array to reorder
+ * @param order A permutation of the particle indices
+ */
+void ParticleArray::_reorder_array(cache_aligned_vector<real_t>& arr,
+                                   const std::vector<std::size_t>& order)
+{
+    this->reorder_scratch.resize(this->n_par);
+
+    for (std::size_t k = 0; k < this->n_par; ++k)
+    {
+        this->reorder_scratch[k] = arr[order[k]];
+    }
+
+    arr.swap(this->reorder_scratch);
+}
+//-----------------------------------------
@@ -0,0 +1,221 @@
+#ifndef PARTICLE_ARRAY_H
+#define PARTICLE_ARRAY_H
+
+#include <iostream>
+#include <vector>
+
+#include "Aligned.h"
+#include "Particle.h"
+#include "Precision.h"
+#include "ThreeVec.h"
+
+/**
+ * @brief Structure-of-arrays storage for a collection of particles. Every
+ *        particle attribute lives in its own contiguous array so that the
+ *        particle loops only stream the attributes they actually touch. The
+ *        per-particle field cache is optional: it is only allocated when it
+ *        is enabled, and is compiled out entirely when PIC_FIELD_CACHE is 0.
+ *        The attributes are stored as real_t, which is float in single
+ *        precision builds, in arrays that start on a cache line.
+ *
+ */
+class ParticleArray
+{
+    private:
+        std::size_t n_par;
+#if PIC_FIELD_CACHE
+        bool field_cache;
+#endif
+
+        // Reused buffer for reordering the particles
+        cache_aligned_vector<real_t> reorder_scratch;
+
+
+        /**********************************************************
+        PRIVATE CLASS METHODS
+        ***********************************************************/
+        void _reorder_array(cache_aligned_vector<real_t>& arr,
+                            const std::vector<std::size_t>& order);
+        //-----------------------------------------
+
+    public:
+        // Phase space and weight
+        cache_aligned_vector<real_t> x, y, z;
+        cache_aligned_vector<real_t> px, py, pz;
+        cache_aligned_vector<real_t> w;
+
+#if PIC_FIELD_CACHE
+        // Optional per-particle field cache
+        cache_aligned_vector<real_t> ex, ey, ez;
+        cache_aligned_vector<real_t> bx, by, bz;
+#endif
+
+
+        /**********************************************************
+        CONSTRUCTORS/DESTRUCTORS
+        ***********************************************************/
+        ParticleArray();
+        ParticleArray(std::size_t capacity);
+        ParticleArray(const ParticleArray& copy_obj) = default;
+        ParticleArray(ParticleArray&& move_obj) noexcept = default;
+        ~ParticleArray();
+        //-----------------------------------------
+
+
+        /**********************************************************
+        OPERATOR FUNCTIONS
+        ***********************************************************/
+        ParticleArray& operator=(const ParticleArray& to_copy) = default;
+        ParticleArray& operator=(ParticleArray&& to_move) noexcept = default;
+        //-----------------------------------------
+
+
+        /**********************************************************
+        CLASS METHODS
+        ***********************************************************/
+        void reserve(std::size_t capacity);
+        void place(const std::size_t chunk, const int nt);
+
+        void push_back(double x_pos, double y_pos, double z_pos,
+                       double x_mom, double y_mom, double z_mom,
+                       double weight);
+        void push_back(const Particle& p);
+
+#if PIC_FIELD_CACHE
+        void enable_field_cache();
+
+        /**
+         * @brief Whether or not the per-particle field cache is allocated
+         *
+         * @return true If the field cache is allocated
+         * @return false If the field cache is not allocated
+         */
+        inline bool has_field_cache() const
+        {
+            return this->field_cache;
+        }
+#endif
+
+        /**
+         * @brief Get the number of particles stored
+         *
+         * @return std::size_t The number of particles stored
+         */
+        inline std::size_t size() const
+        {
+            return this->n_par;
+        }
+
+        /**
+         * @brief Get the position of the ith particle
+         *
+         * @param i Index of the particle
+         * @return ThreeVec The position of the particle
+         */
+        inline ThreeVec get_pos(std::size_t i) const
+        {
+            return ThreeVec(this->x[i], this->y[i], this->z[i]);
+        }
+
+        /**
+         * @brief Get the momentum of the ith particle
+         *
+         * @param i Index of the particle
+         * @return ThreeVec The momentum of the particle
+         */
+        inline ThreeVec get_mom(std::size_t i) const
+        {
+            return ThreeVec(this->px[i], this->py[i], this->pz[i]);
+        }
+
+#if PIC_FIELD_CACHE
+        /**
+         * @brief Get the local electric field of the ith particle
+         *
+         * @param i Index of the particle
+         * @return ThreeVec The local electric field of the particle
+         */
+        inline ThreeVec get_local_e_field(std::size_t i) const
+        {
+            return ThreeVec(this->ex[i], this->ey[i], this->ez[i]);
+        }
+
+        /**
+         * @brief Get the local magnetic field of the ith particle
+         *
+         * @param i Index of the particle
+         * @return ThreeVec The local magnetic field of the particle
+         */
+        inline ThreeVec get_local_b_field(std::size_t i) const
+        {
+            return ThreeVec(this->bx[i], this->by[i], this->bz[i]);
+        }
+#endif
+
+        /**
+         * @brief Set the position of the ith particle
+         *
+         * @param i Index of the particle
+         * @param pos The new position of the particle
+         */
+        inline void set_pos(std::size_t i, const ThreeVec& pos)
+        {
+            this->x[i] = pos.get_x();
+            this->y[i] = pos.get_y();
+            this->z[i] = pos.get_z();
+        }
+
+        /**
+         * @brief Set the momentum of the ith particle
+         *
+         * @param i Index of the particle
+         * @param mom The new momentum of the particle
+         */
+        inline void set_mom(std::size_t i, const ThreeVec& mom)
+        {
+            this->px[i] = mom.get_x();
+            this->py[i] = mom.get_y();
+            this->pz[i] = mom.get_z();
+        }
+
+#if PIC_FIELD_CACHE
+        /**
+         * @brief Set the local electric field of the ith particle
+         *
+         * @param i Index of the particle
+         * @param x1 First component of the field
+         * @param x2 Second component of the field
+         * @param x3 Third component of the field
+         */
+        inline void set_local_e_field(std::size_t i,
+                                      double x1, double x2, double x3)
+        {
+            this->ex[i] = x1;
+            this->ey[i] = x2;
+            this->ez[i] = x3;
+        }
+
+        /**
+         * @brief Set the local magnetic field of the ith particle
+         *
+         * @param i Index of the particle
+         * @param x1 First component of the field
+         * @param x2 Second component of the field
+         * @param x3 Third component of the field
+         */
+        inline void set_local_b_field(std::size_t i,
+                                      double x1, double x2, double x3)
+        {
+            this->bx[i] = x1;
+            this->by[i] = x2;
+            this->bz[i] = x3;
+        }
+#endif
+
+        void reorder(const std::vector<std::size_t>& order);
+
+        Particle get_particle(std::size_t i) const;
+        //-----------------------------------------
+};
+
+#endif
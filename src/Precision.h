@@ -0,0 +1,23 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+// Build with PIC_SINGLE_PRECISION set to 1 to store the particles, the grids
+// and the FFT data in single precision
+#ifndef PIC_SINGLE_PRECISION
+#define PIC_SINGLE_PRECISION 0
+#endif
+
+/**
+ * @brief Floating point type of the bulk particle, grid and FFT storage.
+ *        Scalars such as the grid spacings and the timestep, and the sums
+ *        behind the interpolation and the energy diagnostics, are always
+ *        double.
+ *
+ */
+#if PIC_SINGLE_PRECISION
+typedef float real_t;
+#else
+typedef double real_t;
+#endif
+
+#endif
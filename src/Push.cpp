@@ -0,0 +1,129 @@
+#include "Push.h"
+
+#include <cmath>
+
+// Compile several versions of a kernel and dispatch between them at load time
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define PUSH_TARGET_CLONES \
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define PUSH_TARGET_CLONES
+#endif
+
+/**
+ * @brief Performs a relativistic Boris push on n particles, updating their
+ *        momenta and then their positions. The fields are the ones already
+ *        interpolated to each particle. A particle without a magnetic field
+ *        gets an exactly zero rotation, so there is no branch and the loop
+ *        vectorizes.
+ *
+ * @param n Number of particles to push
+ * @param x The x positions of the particles, updated in place
+ * @param y The y positions of the particles, updated in place
+ * @param z The z positions of the particles, updated in place
+ * @param px The x momenta of the particles, updated in place
+ * @param py The y momenta of the particles, updated in place
+ * @param pz The z momenta of the particles, updated in place
+ * @param ex The x electric field at each particle
+ * @param ey The y electric field at each particle
+ * @param ez The z electric field at each particle
+ * @param bx The x magnetic field at each particle
+ * @param by The y magnetic field at each particle
+ * @param bz The z magnetic field at each particle
+ * @param Qpar Charge of the particles in units of fundamental charge
+ * @param dt Timestep
+ */
+PUSH_TARGET_CLONES
+void Push::boris(const std::size_t n,
+                 real_t* __restrict x, real_t* __restrict y,
+                 real_t* __restrict z,
+                 real_t* __restrict px, real_t* __restrict py,
+                 real_t* __restrict pz,
+                 const real_t* __restrict ex, const real_t* __restrict ey,
+                 const real_t* __restrict ez,
+                 const real_t* __restrict bx, const real_t* __restrict by,
+                 const real_t* __restrict bz,
+                 const double Qpar, const double dt)
+{
+    // Everything inside the loop is in the storage precision, so a single
+    // precision build pushes twice as many particles per vector
+    const real_t e_kick = Qpar * dt * 0.5;
+    const real_t b_kick = Qpar * dt * 0.5;
+    const real_t dt_r = dt;
+    const real_t one = 1.;
+    const real_t two = 2.;
+    const real_t zero = 0.;
+
+    #pragma omp simd
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        // First half of the electric field acceleration
+        real_t ux = px[k] + ex[k] * e_kick;
+        real_t uy = py[k] + ey[k] * e_kick;
+        real_t uz = pz[k] + ez[k] * e_kick;
+
+        // dt / gamma, with gamma taken after the first half acceleration
+        const real_t dt_gamma = dt_r * std::sqrt(one + (ux * ux + uy * uy +
+                                                        uz * uz));
+
+        // Magnetic rotation
+        const real_t b2 = bx[k] * bx[k] + by[k] * by[k] + bz[k] * bz[k];
+        const real_t inv_b = b2 > zero ? one / std::sqrt(b2) : zero;
+
+        const real_t tx = bx[k] * b_kick;
+        const real_t ty = by[k] * b_kick;
+        const real_t tz = bz[k] * b_kick;
+        const real_t s_fac = two / (one + (tx * tx + ty * ty + tz * tz));
+        const real_t sx = tx * s_fac;
+        const real_t sy = ty * s_fac;
+        const real_t sz = tz * s_fac;
+
+        const real_t vperp_x = ux - (ux * bx[k]) * inv_b;
+        const real_t vperp_y = uy - (uy * by[k]) * inv_b;
+        const real_t vperp_z = uz - (uz * bz[k]) * inv_b;
+
+        const real_t vstar_x = vperp_x + (vperp_y * tz - vperp_z * ty);
+        const real_t vstar_y = vperp_y + (vperp_z * tx - vperp_x * tz);
+        const real_t vstar_z = vperp_z + (vperp_x * ty - vperp_y * tx);
+
+        ux += vstar_y * sz - vstar_z * sy;
+        uy += vstar_z * sx - vstar_x * sz;
+        uz += vstar_x * sy - vstar_y * sx;
+
+        // Second half of the electric field acceleration
+        ux += ex[k] * e_kick;
+        uy += ey[k] * e_kick;
+        uz += ez[k] * e_kick;
+
+        px[k] = ux;
+        py[k] = uy;
+        pz[k] = uz;
+
+        x[k] += ux * dt_gamma;
+        y[k] += uy * dt_gamma;
+        z[k] += uz * dt_gamma;
+    }
+}
+
+/**
+ * @brief Get the instruction set the vectorized kernels run with on this CPU
+ *
+ * @return const char* Name of the instruction set
+ */
+const char* Push::simd_isa()
+{
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return "avx512f";
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return "avx2";
+    }
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
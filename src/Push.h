@@ -0,0 +1,27 @@
+#ifndef PUSH_H
+#define PUSH_H
+
+#include <cstddef>
+
+#include "Precision.h"
+
+/**
+ * @brief Particle push kernels that work directly on structure-of-arrays
+ *        particle data. On x86-64 with GCC the Boris push is compiled for
+ *        AVX-512, AVX2 and baseline SSE2, and the best version the CPU
+ *        supports is picked when the program loads.
+ *
+ */
+namespace Push
+{
+    void boris(const std::size_t n,
+               real_t* x, real_t* y, real_t* z,
+               real_t* px, real_t* py, real_t* pz,
+               const real_t* ex, const real_t* ey, const real_t* ez,
+               const real_t* bx, const real_t* by, const real_t* bz,
+               const double Qpar, const double dt);
+
+    const char* simd_isa();
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+#include <cmath>
+
+#include "Precision.h"
+
+// Shape order used by a species unless it is changed at run time
+#ifndef PIC_SHAPE_ORDER
+#define PIC_SHAPE_ORDER 1
+#endif
+
+/**
+ * @brief B-spline particle shape functions. The order is a template
+ *        parameter, so the weights and the loops over them are unrolled at
+ *        compile time: 0 is nearest grid point (NGP), 1 cloud in cell (CIC),
+ *        2 triangular shaped cloud (TSC), 3 cubic and 4 quartic. Grid point i
+ *        sits at x = i * dx.
+ *
+ */
+namespace Shape
+{
+    const int max_order = 4;
+
+    // Cells past the edge of the grid that a shape of any order reaches, from
+    // a position inside the grid
+    const int guard_cells = 3;
+    const char shape_order_err[40] = "Error: Shape order must be from 0 to 4";
+
+    template <int Order>
+    struct BSpline
+    {
+        // Number of grid points a particle touches in each direction
+        static const int support = Order + 1;
+
+        /**
+         * @brief Computes the weights of the grid points around a position
+         *
+         * @param f Position in units of the grid spacing, not negative
+         * @param first Set to the index of the first grid point touched
+         * @param w Set to the weights of the support grid points from first
+         *          on
+         */
+        static inline void weights(const real_t f, long& first, real_t* w);
+    };
+
+    template <>
+    inline void BSpline<0>::weights(const real_t f, long& first, real_t* w)
+    {
+        first = long(f + 0.5);
+        w[0] = 1.0;
+    }
+
+    template <>
+    inline void BSpline<1>::weights(const real_t f, long& first, real_t* w)
+    {
+        first = long(f);
+        const real_t h = f - real_t(first);
+
+        w[0] = 1. - h;
+        w[1] = h;
+    }
+
+    template <>
+    inline void BSpline<2>::weights(const real_t f, long& first, real_t* w)
+    {
+        const long nearest = long(f + 0.5);
+        const real_t d = f - real_t(nearest);
+
+        first = nearest - 1;
+        w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+        w[1] = 0.75 - d * d;
+        w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+    }
+
+    template <>
+    inline void BSpline<3>::weights(const real_t f, long& first, real_t* w)
+    {
+        const long below = long(f);
+        const real_t h = f - real_t(below);
+        const real_t h2 = h * h, h3 = h2 * h;
+
+        first = below - 1;
+        w[0] = (1. - h) * (1. - h) * (1. - h) / 6.;
+        w[1] = (4. - 6. * h2 + 3. * h3) / 6.;
+        w[2] = (1. + 3. * h + 3. * h2 - 3. * h3) / 6.;
+        w[3] = h3 / 6.;
+    }
+
+    template <>
+    inline void BSpline<4>::weights(const real_t f, long& first, real_t* w)
+    {
+        const long nearest = long(f + 0.5);
+        const real_t d = f - real_t(nearest);
+        const real_t d2 = d * d, d3 = d2 * d, d4 = d2 * d2;
+        const real_t lo = 1. - 2. * d, hi = 1. + 2. * d;
+
+        first = nearest - 2;
+        w[0] = lo * lo * lo * lo / 384.;
+        w[1] = (19. - 44. * d + 24. * d2 + 16. * d3 - 16. * d4) / 96.;
+        w[2] = (115. - 120. * d2 + 48. * d4) / 192.;
+        w[3] = (19. + 44. * d + 24. * d2 - 16. * d3 - 16. * d4) / 96.;
+        w[4] = hi * hi * hi * hi / 384.;
+    }
+}
+
+#endif
@@ -22,6 +22,44 @@ Simulation::Simulation(std::size_t ndump, std::size_t nspec,
 {
     this->err = 0;
 
+    this->use_b_field = false;
+
+    this->n_threads = 0;
+    this->reproducible_deposit = false;
+    this->first_touch = true;
+
+    this->sort_interval = 0;
+    this->adaptive_sort = false;
+
+    this->shape_order = PIC_SHAPE_ORDER;
+
+    this->fft_backend = FFT::default_backend;
+
+    this->field_solver = Field_T::Field_Solver::Spectral;
+    this->boundaries = Multigrid::periodic;
+
+    this->interleaved_fields = false;
+
+    this->tiled = false;
+    this->tile_nx = 8;
+    this->tile_ny = 8;
+
+    this->push_time = 0.0;
+    this->deposit_time = 0.0;
+    this->sort_time = 0.0;
+    this->n_sorts = 0;
+    this->last_sort_time = 0.0;
+    this->cost_after_sort = 0.0;
+    this->excess_cost = 0.0;
+    this->last_step_cost = 0.0;
+    this->cost_before_sort_sum = 0.0;
+    this->cost_after_sort_sum = 0.0;
+    this->n_before_sort = 0;
+    this->step_after_sort = false;
+#if PIC_FIELD_CACHE
+    this->fused_push = true;
+#endif
+
     this->n_iter = 0;
     this->ndump = ndump;
 
@@ -32,6 +70,7 @@ Simulation::Simulation(std::size_t ndump, std::size_t nspec,
     this->dx = L_x / double(Nx);
     this->dy = L_y / double(Ny);
 
+    this->total_dens = GridObject(Nx, Ny);
 
     this->dt = dt;
     this->tmax = tmax;
@@ -72,8 +111,19 @@ CLASS METHODS
 void Simulation::add_species(std::size_t npar, double Qpar,
                              std::function<void(Species &, std::size_t)> init_fcn)
 {
-    this->spec.push_back(Species(npar, this->Nx, this->Ny, Qpar,
-                                 init_fcn));
+    this->spec.emplace_back(npar, this->Nx, this->Ny, Qpar, init_fcn);
+
+    this->spec.back().n_threads = this->n_threads;
+    this->spec.back().reproducible_deposit = this->reproducible_deposit;
+    this->spec.back().shape_order = this->shape_order;
+    this->spec.back().tiled = this->tiled;
+    this->spec.back().tile_nx = this->tile_nx;
+    this->spec.back().tile_ny = this->tile_ny;
+
+    if (this->first_touch)
+    {
+        this->spec.back().place_particles();
+    }
 }
 
 /**
@@ -85,6 +135,13 @@ void Simulation::add_species(std::size_t npar, double Qpar,
 void Simulation::add_e_field(std::function<void(Field &, std::size_t, std::size_t)> init_fcn)
 {
     this->e_field = Field(this->Nx, this->Ny, this->dx, this->dy, init_fcn);
+    this->e_field.n_threads = this->n_threads;
+    this->e_field.set_fft_backend(this->fft_backend);
+    this->e_field.set_solver(this->field_solver, this->boundaries);
+    this->e_field.set_interleaved(this->interleaved_fields);
+
+    // The field solve keeps the guard cells up to date from now on
+    this->e_field.exchange_guards();
 }
 
 /**
@@ -96,6 +153,151 @@ void Simulation::add_e_field(std::function<void(Field &, std::size_t, std::size_
 void Simulation::add_b_field(std::function<void(Field &, std::size_t, std::size_t)> init_fcn)
 {
     this->b_field = Field(this->Nx, this->Ny, this->dx, this->dy, init_fcn);
+    this->b_field.n_threads = this->n_threads;
+    this->b_field.set_fft_backend(this->fft_backend);
+    this->b_field.set_interleaved(this->interleaved_fields);
+    this->b_field.exchange_guards();
+
+    // Skip gathering the magnetic field if it is zero everywhere
+    this->use_b_field = !this->b_field.is_zero();
+}
+
+
+/**
+ * @brief Sets the number of threads used by every species and by the field
+ *        solve in the simulation
+ *
+ * @param n_threads Number of threads to use, 0 for the OpenMP default
+ */
+void Simulation::set_num_threads(std::size_t n_threads)
+{
+    this->n_threads = n_threads;
+
+    for (auto &s : this->spec)
+    {
+        s.n_threads = n_threads;
+    }
+
+    this->e_field.n_threads = n_threads;
+    this->b_field.n_threads = n_threads;
+}
+
+/**
+ * @brief Makes the charge deposit of every species in the simulation bitwise
+ *        identical for any number of threads, or lets it depend on them
+ *
+ * @param reproducible_deposit Whether to deposit in fixed particle blocks
+ */
+void Simulation::set_reproducible_deposit(bool reproducible_deposit)
+{
+    this->reproducible_deposit = reproducible_deposit;
+
+    for (auto &s : this->spec)
+    {
+        s.reproducible_deposit = reproducible_deposit;
+    }
+}
+
+/**
+ * @brief Turns the tiled deposit and gather on or off for every species in
+ *        the simulation
+ *
+ * @param tiled Whether to deposit and gather tile by tile
+ * @param tile_nx Number of cells in a tile in x direction
+ * @param tile_ny Number of cells in a tile in y direction
+ */
+void Simulation::set_tiling(bool tiled, std::size_t tile_nx,
+                            std::size_t tile_ny)
+{
+    this->tiled = tiled;
+    this->tile_nx = tile_nx;
+    this->tile_ny = tile_ny;
+
+    for (auto &s : this->spec)
+    {
+        s.tiled = tiled;
+        s.tile_nx = tile_nx;
+        s.tile_ny = tile_ny;
+    }
+}
+
+/**
+ * @brief Sets the order of the particle shape function used to deposit the
+ *        charge and gather the fields for every species in the simulation
+ *
+ * @param shape_order Order of the shape function, from 0 (NGP) to 4 (quartic)
+ */
+void Simulation::set_shape_order(int shape_order)
+{
+    if (shape_order < 0 || shape_order > Shape::max_order)
+    {
+        throw std::runtime_error(Shape::shape_order_err);
+    }
+
+    this->shape_order = shape_order;
+
+    for (auto &s : this->spec)
+    {
+        s.shape_order = shape_order;
+    }
+}
+
+/**
+ * @brief Sets the library doing the FFTs of the field solve
+ *
+ * @param fft_backend The library to use. It has to have been built in, see
+ *                    FFT::has_backend.
+ */
+void Simulation::set_fft_backend(FFT::FFT_Backend fft_backend)
+{
+    if (!FFT::has_backend(fft_backend))
+    {
+        throw std::runtime_error(FFT::backend_err);
+    }
+
+    this->fft_backend = fft_backend;
+
+    this->e_field.set_fft_backend(fft_backend);
+    this->b_field.set_fft_backend(fft_backend);
+}
+
+/**
+ * @brief Sets the solver of the electric field and the conditions on the
+ *        sides of the grid. Only the field solve and the guard cells the
+ *        gather reads see the conditions: the particles and their deposit
+ *        still wrap around the grid. The field is solved again, so that the
+ *        next step already pushes with it.
+ *
+ * @param field_solver The solver to use
+ * @param boundaries The conditions on the four sides. The spectral solve
+ *                   only does periodic sides.
+ */
+void Simulation::set_field_solver(Field_T::Field_Solver field_solver,
+                                  const Multigrid::Boundaries& boundaries)
+{
+    this->e_field.set_solver(field_solver, boundaries);
+
+    this->field_solver = field_solver;
+    this->boundaries = boundaries;
+
+    // The constructor solved the field with the solver it had then
+    _deposit_charge();
+    _solve_field();
+}
+
+/**
+ * @brief Sets whether the gather reads the components of each field node
+ *        next to each other, for the fields of the simulation and those
+ *        added later
+ *
+ * @param interleaved_fields Whether to interleave the field components
+ */
+void Simulation::set_interleaved_fields(bool interleaved_fields)
+{
+    this->interleaved_fields = interleaved_fields;
+
+    this->e_field.set_interleaved(interleaved_fields);
+    this->b_field.set_interleaved(interleaved_fields);
 }
 
 
@@ -123,31 +325,80 @@ bool Simulation::dump_data()
  */
 void Simulation::iterate()
 {
+    if (this->_sort_due())
+    {
+        _sort_species();
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
     // Already deposited charge and fields on creation, so can immediately push
-    _map_field_to_species();
-    _push_species();
+#if PIC_FIELD_CACHE
+    if (this->fused_push)
+    {
+        _gather_push_species();
+    }
+    else
+    {
+        _map_field_to_species();
+        _push_species();
+    }
+#else
+    _gather_push_species();
+#endif
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
     _deposit_charge();
+
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
     _solve_field();
 
+    this->_update_timing(std::chrono::duration<double>(t1 - t0).count(),
+                         std::chrono::duration<double>(t2 - t1).count());
+
     ++(this->n_iter);
 }
 
 /**
- * @brief Get the sum of all species' densities in simulation
+ * @brief Get the sum of all species' densities in simulation. The sum is
+ *        kept in the simulation and overwritten by the next call.
  *
- * @return GridObject Matrix containing the sum of all species' densities in
- *                    simulation
+ * @return const GridObject& Matrix containing the sum of all species'
+ *                           densities in simulation
  */
-GridObject Simulation::get_total_density()
+const GridObject& Simulation::get_total_density()
 {
-    GridObject total_dens = GridObject(this->Nx, this->Ny);
+    const std::size_t n_spec = this->spec.size();
+    if (n_spec == 0)
+    {
+        this->total_dens.zero();
+        return this->total_dens;
+    }
 
-    for (const auto &s : this->spec)
+    // The species are summed two at a time, so that each pass over the total
+    // reads two densities. With an odd number the first one is copied alone.
+    std::size_t s;
+    if (n_spec % 2)
     {
-        total_dens += s.density_arr;
+        this->total_dens.gridded_data = this->spec[0].density_arr.gridded_data;
+        s = 1;
+    }
+    else
+    {
+        this->total_dens = this->spec[0].density_arr +
+                           this->spec[1].density_arr;
+        s = 2;
     }
 
-    return total_dens;
+    for (; s < n_spec; s += 2)
+    {
+        this->total_dens += this->spec[s].density_arr +
+                            this->spec[s + 1].density_arr;
+    }
+
+    return this->total_dens;
 }
 
 /**
@@ -159,6 +410,41 @@ void Simulation::print_spec_density(std::size_t i) const
 {
     spec.at(i).print_density();
 }
+
+/**
+ * @brief Prints the time spent in the particle passes and in sorting the
+ *        particles. The deposit and gather/push cost of the steps just before
+ *        and just after a sort shows what each sort saves.
+ *
+ */
+void Simulation::print_timing() const
+{
+    std::cout << "Timing over " << this->n_iter << " steps:" << std::endl;
+    std::cout << "  gather/push: " << this->push_time << " s" << std::endl;
+    std::cout << "  deposit:     " << this->deposit_time << " s" << std::endl;
+
+    if (this->n_sorts == 0)
+    {
+        return;
+    }
+
+    std::cout << "  sort:        " << this->sort_time << " s in "
+              << this->n_sorts << " sorts ("
+              << this->sort_time / this->n_sorts << " s per sort)"
+              << std::endl;
+
+    if (this->n_before_sort > 0)
+    {
+        const double before = this->cost_before_sort_sum / this->n_before_sort;
+        const double after = this->cost_after_sort_sum / this->n_sorts;
+
+        std::cout << "  deposit + gather/push per step before a sort: "
+                  << before << " s, after a sort: " << after << " s"
+                  << std::endl;
+        std::cout << "  saved per step by a sort: " << before - after
+                  << " s" << std::endl;
+    }
+}
 //-----------------------------------------
 
 
@@ -166,6 +452,90 @@ void Simulation::print_spec_density(std::size_t i) const
 PRIVATE CLASS METHODS
 ***********************************************************/
 
+/**
+ * @brief Decides whether the particles should be sorted before this step.
+ *        The adaptive mode sorts once the extra deposit and gather/push time
+ *        accumulated since the last sort exceeds the time the sort took. In
+ *        tiled mode without either setting the particles are sorted every
+ *        step.
+ *
+ * @return true If the particles should be sorted
+ * @return false If the particles should not be sorted
+ */
+bool Simulation::_sort_due() const
+{
+    if (this->adaptive_sort)
+    {
+        return this->n_sorts == 0 || this->excess_cost >= this->last_sort_time;
+    }
+
+    if (this->sort_interval == 0)
+    {
+        // The tiles are only kept up to date by sorting
+        return this->tiled;
+    }
+
+    return !(this->n_iter % this->sort_interval);
+}
+
+/**
+ * @brief Sorts the particles of all species by grid cell
+ *
+ */
+void Simulation::_sort_species()
+{
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    for (auto &s : this->spec)
+    {
+        s.sort_particles(this->dx, this->dy,
+                         this->L_x, this->L_y,
+                         this->Nx, this->Ny);
+    }
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    this->last_sort_time = std::chrono::duration<double>(t1 - t0).count();
+    this->sort_time += this->last_sort_time;
+    ++(this->n_sorts);
+
+    if (this->n_iter > 0)
+    {
+        this->cost_before_sort_sum += this->last_step_cost;
+        ++(this->n_before_sort);
+    }
+
+    this->step_after_sort = true;
+}
+
+/**
+ * @brief Accumulates the time spent in the particle passes of a step
+ *
+ * @param push Time spent in the gather/push this step
+ * @param deposit Time spent in the deposit this step
+ */
+void Simulation::_update_timing(const double push, const double deposit)
+{
+    const double cost = push + deposit;
+
+    this->push_time += push;
+    this->deposit_time += deposit;
+
+    if (this->step_after_sort)
+    {
+        this->cost_after_sort = cost;
+        this->cost_after_sort_sum += cost;
+        this->excess_cost = 0.0;
+        this->step_after_sort = false;
+    }
+    else if (cost > this->cost_after_sort)
+    {
+        this->excess_cost += cost - this->cost_after_sort;
+    }
+
+    this->last_step_cost = cost;
+}
+
 /**
  * @brief Deposits all species' particle charge onto grid
  *
@@ -186,11 +556,11 @@ void Simulation::_deposit_charge()
  */
 void Simulation::_solve_field()
 {
-    const GridObject total_dens = get_total_density();
-
-    this->err = this->e_field.solve_field(total_dens, this->dx, this->dy);
+    this->err = this->e_field.solve_field(get_total_density(),
+                                          this->dx, this->dy);
 }
 
+#if PIC_FIELD_CACHE
 /**
  * @brief Weights the current fields to the particles for all species
  *
@@ -203,6 +573,13 @@ void Simulation::_map_field_to_species()
                             this->dx,  this->dy,
                             this->L_x, this->L_y,
                             this->Nx,  this->Ny);
+        if (this->use_b_field)
+        {
+            s.map_field_to_part(this->b_field, Field_T::Magnetic,
+                                this->dx,  this->dy,
+                                this->L_x, this->L_y,
+                                this->Nx,  this->Ny);
+        }
     }
 }
 
@@ -219,4 +596,22 @@ void Simulation::_push_species()
                          this->dx, this->dy);
     }
 }
+#endif
+
+/**
+ * @brief Interpolates the fields to the particles and pushes them in a single
+ *        pass for all species
+ *
+ */
+void Simulation::_gather_push_species()
+{
+    for (auto &s : this->spec)
+    {
+        s.gather_push_particles(this->e_field, this->b_field,
+                                this->use_b_field,
+                                this->L_x, this->L_y,
+                                this->dt,
+                                this->dx, this->dy);
+    }
+}
 //-----------------------------------------
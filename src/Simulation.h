@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <functional>
+#include <chrono>
 
 #include "GridObject.h"
 #include "Species.h"
@@ -17,6 +18,20 @@ class Simulation
     private:
         int err;
 
+        bool use_b_field;
+
+        // Timing of the particle passes, used to report and adapt the sorting
+        double push_time, deposit_time, sort_time;
+        std::size_t n_sorts;
+        double last_sort_time;
+        double cost_after_sort, excess_cost, last_step_cost;
+        double cost_before_sort_sum, cost_after_sort_sum;
+        std::size_t n_before_sort;
+        bool step_after_sort;
+
+        // Sum of the species' densities, reused every step
+        GridObject total_dens;
+
 
         /**********************************************************
         PRIVATE CLASS METHODS
@@ -25,8 +40,15 @@ class Simulation
 
         void _deposit_charge();
         void _solve_field();
+#if PIC_FIELD_CACHE
         void _map_field_to_species();
         void _push_species();
+#endif
+        void _gather_push_species();
+
+        bool _sort_due() const;
+        void _sort_species();
+        void _update_timing(const double push, const double deposit);
         //-----------------------------------------
 
     public:
@@ -53,6 +75,44 @@ class Simulation
         Field e_field;
         Field b_field;
 
+        // Parallel settings, applied to each species as it is added
+        std::size_t n_threads;      // 0 uses the OpenMP default
+        bool reproducible_deposit;  // bitwise identical for any n_threads
+        bool first_touch;           // place the particles on their threads
+
+        // Particle sorting
+        std::size_t sort_interval;  // sort every sort_interval steps, 0 never
+        bool adaptive_sort;         // sort whenever it is estimated to pay off
+
+        // Order of the particle shape function, applied to each species as it
+        // is added
+        int shape_order;
+
+        // Library doing the FFTs of the field solve, applied to each field as
+        // it is added
+        FFT::FFT_Backend fft_backend;
+
+        // Solver of the electric field and the conditions on the sides of
+        // the grid, applied to the electric field as it is added
+        Field_T::Field_Solver field_solver;
+        Multigrid::Boundaries boundaries;
+
+        // Store the components of each field node next to each other for the
+        // gather, applied to each field as it is added
+        bool interleaved_fields;
+
+        // Tiled deposit and gather, applied to each species as it is added.
+        // The tiles come from the particle sort, so without a sort_interval
+        // or adaptive_sort the particles are sorted every step.
+        bool tiled;
+        std::size_t tile_nx, tile_ny;  // tile size in cells
+
+#if PIC_FIELD_CACHE
+        // Interpolate the fields inside the push rather than storing them on
+        // the particles in a separate pass
+        bool fused_push;
+#endif
+
 
         /**********************************************************
         CONSTRUCTORS/DESTRUCTORS
@@ -73,11 +133,21 @@ class Simulation
         void add_e_field(std::function<void(Field&, std::size_t, std::size_t)> init_fcn);
         void add_b_field(std::function<void(Field&, std::size_t, std::size_t)> init_fcn);
 
+        void set_num_threads(std::size_t n_threads);
+        void set_reproducible_deposit(bool reproducible_deposit);
+        void set_tiling(bool tiled, std::size_t tile_nx, std::size_t tile_ny);
+        void set_shape_order(int shape_order);
+        void set_fft_backend(FFT::FFT_Backend fft_backend);
+        void set_field_solver(Field_T::Field_Solver field_solver,
+                              const Multigrid::Boundaries& boundaries);
+        void set_interleaved_fields(bool interleaved_fields);
+
         bool dump_data();
         void iterate();
-        GridObject get_total_density();
+        const GridObject& get_total_density();
 
         void print_spec_density(std::size_t i) const;
+        void print_timing() const;
         //-----------------------------------------
 };
 
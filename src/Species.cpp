@@ -1,14 +1,41 @@
 #include "Species.h"
 
+// Calls the member function template fcn instantiated for the shape order of
+// the species, with the arguments args
+#define SHAPE_DISPATCH(fcn, args)                                \
+    switch (this->shape_order)                                   \
+    {                                                            \
+        case 0: this->fcn<0> args; break;                        \
+        case 1: this->fcn<1> args; break;                        \
+        case 2: this->fcn<2> args; break;                        \
+        case 3: this->fcn<3> args; break;                        \
+        case 4: this->fcn<4> args; break;                        \
+        default: throw std::runtime_error(Shape::shape_order_err); \
+    }
+
+// Returns the member function template fcn instantiated for the shape order
+// order and the grid dimensions Dims
+#define SHAPE_KERNEL(fcn, Dims)                                  \
+    switch (order)                                               \
+    {                                                            \
+        case 0: return &Species::fcn<0, Dims>;                   \
+        case 1: return &Species::fcn<1, Dims>;                   \
+        case 2: return &Species::fcn<2, Dims>;                   \
+        case 3: return &Species::fcn<3, Dims>;                   \
+        case 4: return &Species::fcn<4, Dims>;                   \
+        default: throw std::runtime_error(Shape::shape_order_err); \
+    }
+
 /**********************************************************
 CONSTRUCTORS/DESTRUCTORS
 ***********************************************************/
 
 /**
- * @brief Constructor for Species object
+ * @brief Constructor for Species object - an empty species on an empty grid,
+ *        with the same settings as the other constructors
  *
  */
-Species::Species()
+Species::Species() : Species(0, 0, 0, 0.0)
 {
 }
 
@@ -23,12 +50,27 @@ Species::Species()
 Species::Species(std::size_t Npar, std::size_t Nx, std::size_t Ny, double Qpar)
 {
     this->Npar = Npar;
-    this->parts.reserve(Npar);
+    this->parts = ParticleArray(Npar);
 
     this->density_arr = GridObject(Nx, Ny);
 
     this->Qpar = Qpar;
 
+    this->n_threads = 0;
+    this->reproducible_deposit = false;
+    this->n_deposit_blocks = 16;
+
+    this->shape_order = PIC_SHAPE_ORDER;
+
+    this->tiled = false;
+    this->tile_nx = 8;
+    this->tile_ny = 8;
+    this->sorted_tile_nx = 0;
+    this->sorted_tile_ny = 0;
+
+    this->guard_cells = true;
+    this->fixed_grids = true;
+
     // this->total_KE = 0.0;
 }
 
@@ -46,12 +88,27 @@ Species::Species(std::size_t Npar, std::size_t Nx, std::size_t Ny, double Qpar,
                  std::function<void(Species &, std::size_t)> init_fcn)
 {
     this->Npar = Npar;
-    this->parts.reserve(Npar);
+    this->parts = ParticleArray(Npar);
 
     this->density_arr = GridObject(Nx, Ny);
 
     this->Qpar = Qpar;
 
+    this->n_threads = 0;
+    this->reproducible_deposit = false;
+    this->n_deposit_blocks = 16;
+
+    this->shape_order = PIC_SHAPE_ORDER;
+
+    this->tiled = false;
+    this->tile_nx = 8;
+    this->tile_ny = 8;
+    this->sorted_tile_nx = 0;
+    this->sorted_tile_ny = 0;
+
+    this->guard_cells = true;
+    this->fixed_grids = true;
+
     // this->total_KE = 0.0;
 
     init_species(init_fcn);
@@ -86,9 +143,9 @@ void Species::add_particle(double x_pos, double y_pos, double z_pos,
                            double x_mom, double y_mom, double z_mom,
                            double Wpar)
 {
-    this->add_particle(Particle(x_pos, y_pos, z_pos,
-                                x_mom, y_mom, z_mom,
-                                Wpar));
+    this->parts.push_back(x_pos, y_pos, z_pos,
+                          x_mom, y_mom, z_mom,
+                          Wpar);
 }
 
 /**
@@ -100,7 +157,9 @@ void Species::add_particle(double x_pos, double y_pos, double z_pos,
  */
 void Species::add_particle(const ThreeVec& pos, const ThreeVec& mom, double Wpar)
 {
-    this->add_particle(Particle(pos, mom, Wpar));
+    this->parts.push_back(pos.get_x(), pos.get_y(), pos.get_z(),
+                          mom.get_x(), mom.get_y(), mom.get_z(),
+                          Wpar);
 }
 
 /**
@@ -116,7 +175,11 @@ void Species::add_particle(const Particle& p)
 
 
 /**
- * @brief Deposits and interpolates the species charge onto the grid
+ * @brief Deposits and interpolates the species charge onto the grid. With
+ *        more than one thread, each block of particles is scattered into its
+ *        own private copy of the grid and the copies are then summed in
+ *        parallel over the grid cells. In tiled mode every tile is deposited
+ *        into its own small window of the grid instead.
  *
  * @param dx Spatial grid step in x direction
  * @param dy Spatial grid step in y direction
@@ -130,44 +193,68 @@ int Species::deposit_charge(const double dx, const double dy,
                             const double L_x, const double L_y,
                             const std::size_t Nx, const std::size_t Ny)
 {
-    // Initialize
-    this->density_arr.zero();
+    if (this->tiled)
+    {
+        return this->_deposit_tiled(dx, dy, L_x, L_y, Nx, Ny);
+    }
 
-    const double x_min = 0.0, y_min = 0.0;
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t n_par = this->parts.size();
 
-    for (const auto &p : this->parts)
+    // A reproducible deposit always uses the same particle blocks and the same
+    // reduction order, no matter how many threads work on them
+    const std::size_t n_blocks = this->reproducible_deposit ?
+                                 this->n_deposit_blocks : std::size_t(nt);
+
+    if (n_blocks <= 1)
     {
-        double par_weight = p.get_weight() / dx / dy; // normalization factor
-        double x_pos = p.get_pos().get_x();
-        double y_pos = p.get_pos().get_y();
+        this->density_arr.zero();
+        this->_deposit_range(this->density_arr, 0, n_par, dx, dy, L_x, L_y);
+        return 0;
+    }
 
-        // This is because I have chosen to start my boundary at -dx/2
-        if (x_pos < 0.0)
-        {
-            x_pos += L_x;
-        }
-        if (y_pos < 0.0)
+    if (this->deposit_scratch.size() != n_blocks)
+    {
+        this->deposit_scratch.assign(n_blocks, GridObject());
+    }
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t b = 0; b < n_blocks; ++b)
+    {
+        // Each private grid is made by the thread that deposits into it, so
+        // that its pages are local to that thread
+        GridObject& block_dens = this->deposit_scratch[b];
+        if (block_dens.Nx != int(Nx) || block_dens.Ny != int(Ny))
         {
-            y_pos += L_y;
+            block_dens = GridObject(Nx, Ny);
         }
+        block_dens.zero();
+        this->_deposit_range(block_dens,
+                             (b * n_par) / n_blocks,
+                             ((b + 1) * n_par) / n_blocks,
+                             dx, dy, L_x, L_y);
+    }
 
-        double fi = (x_pos - x_min) / dx; // shape function normalization here
-        std::size_t i = fi;
-        double hx = fi - double(i);
-
-        double fj = (y_pos - y_min) / dy; // shape function normalization here
-        std::size_t j  = fj;
-        double hy = fj - double(j);
+    // Sum the private grids in a fixed order for every cell
+    const std::size_t n_cells = this->density_arr.gridded_data.get_size();
+    DataStorage_2D& dens = this->density_arr.gridded_data;
 
-        density_arr.comp_add_to(i,   j,   (1.-hx) * (1.-hy) * par_weight);
-        density_arr.comp_add_to(i+1, j,   hx      * (1.-hy) * par_weight);
-        density_arr.comp_add_to(i,   j+1, (1.-hx) * hy      * par_weight);
-        density_arr.comp_add_to(i+1, j+1, hx      * hy      * par_weight);
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t c = 0; c < n_cells; ++c)
+    {
+        double sum = 0.0;
+        for (std::size_t b = 0; b < n_blocks; ++b)
+        {
+            sum += this->deposit_scratch[b].gridded_data[c];
+        }
+        dens[c] = sum;
     }
+
     return 0;
 }
 
 
+#if PIC_FIELD_CACHE
 /**
  * @brief Interpolates the field values from the grid to the particle position
  *
@@ -187,62 +274,29 @@ int Species::map_field_to_part(const Field& f,
                                const double L_x, const double L_y,
                                const std::size_t Nx, const std::size_t Ny)
 {
-    const double x_min = 0.0, y_min = 0.0;
-
-    for (auto &p : this->parts)
-    {
-        double loc_f_x1 = 0.0;
-        double loc_f_x2 = 0.0;
-        double loc_f_x3 = 0.0;
+    this->parts.enable_field_cache();
 
-        double x_pos = p.get_pos().get_x();
-        double y_pos = p.get_pos().get_y();
+    const std::size_t n_par = this->parts.size();
 
-        // This is because I have chosen to start my boundary at -dx/2
-        if (x_pos < 0.0)
-        {
-            x_pos += L_x;
-        }
-        if (y_pos < 0.0)
-        {
-            y_pos += L_y;
-        }
-
-        double fi = (x_pos - x_min) / dx; // shape function normalization here
-        std::size_t i = fi;
-        double hx = fi - double(i);
-
-        double fj = (y_pos - y_min) / dy; // shape function normalization here
-        std::size_t j = fj;
-        double hy = fj - double(j);
-
-        loc_f_x1 += (1.-hx) * (1.-hy) * f.f1.get_comp(i, j);
-        loc_f_x1 += hx      * (1.-hy) * f.f1.get_comp(i+1, j);
-        loc_f_x1 += (1.-hx) * hy      * f.f1.get_comp(i, j+1);
-        loc_f_x1 += hx      * hy      * f.f1.get_comp(i+1, j+1);
-
-        loc_f_x2 += (1.-hx) * (1.-hy) * f.f2.get_comp(i, j);
-        loc_f_x2 += hx      * (1.-hy) * f.f2.get_comp(i+1, j);
-        loc_f_x2 += (1.-hx) * hy      * f.f2.get_comp(i, j+1);
-        loc_f_x2 += hx      * hy      * f.f2.get_comp(i+1, j+1);
+    const GridDims::Layout layout = this->_gather_layout(f);
+    const Gather_Kernel::type gather =
+        this->_select_kernel<Gather_Kernel>(layout);
 
-        loc_f_x3 += (1.-hx) * (1.-hy) * f.f3.get_comp(i, j);
-        loc_f_x3 += hx      * (1.-hy) * f.f3.get_comp(i+1, j);
-        loc_f_x3 += (1.-hx) * hy      * f.f3.get_comp(i, j+1);
-        loc_f_x3 += hx      * hy      * f.f3.get_comp(i+1, j+1);
-
-        switch (field_to_map)
-        {
-            case Field_T::Electric:
-                p.set_local_e_field(loc_f_x1, loc_f_x2, loc_f_x3);
-                break;
-            case Field_T::Magnetic:
-                p.set_local_b_field(loc_f_x1, loc_f_x2, loc_f_x3);
-                break;
-            default:
-                throw std::runtime_error(Field_T::Field_T_err);
-                break;
-        }
+    switch (field_to_map)
+    {
+        case Field_T::Electric:
+            (this->*gather)(f, layout, 0, n_par, dx, dy, L_x, L_y,
+                            this->parts.ex.data(), this->parts.ey.data(),
+                            this->parts.ez.data());
+            break;
+        case Field_T::Magnetic:
+            (this->*gather)(f, layout, 0, n_par, dx, dy, L_x, L_y,
+                            this->parts.bx.data(), this->parts.by.data(),
+                            this->parts.bz.data());
+            break;
+        default:
+            throw std::runtime_error(Field_T::Field_T_err);
+            break;
     }
 
     return 0;
@@ -250,7 +304,8 @@ int Species::map_field_to_part(const Field& f,
 
 
 /**
- * @brief Performs a Boris push on all of the particles in the species
+ * @brief Performs a Boris push on all of the particles in the species using
+ *        the fields previously mapped to the particles
  *
  * @param L_x Physical length of system in x direction
  * @param L_y Physical length of system in y direction
@@ -267,49 +322,120 @@ int Species::push_particles(const double L_x, const double L_y,
     // double KE = 0.0;
     // this->total_KE = 0.0;
 
-    for (auto &p : this->parts)
-    {
-        ThreeVec pos = p.get_pos();
-        ThreeVec mom = p.get_mom();
+    this->parts.enable_field_cache();
 
-        mom += p.get_local_e_field() * (this->Qpar * dt * 0.5);
+    const std::size_t n_par = this->parts.size();
 
-        double mom2 = mom.square();
-        double gamma = 1. / sqrt(1. + mom2);
+    Push::boris(n_par,
+                this->parts.x.data(), this->parts.y.data(),
+                this->parts.z.data(),
+                this->parts.px.data(), this->parts.py.data(),
+                this->parts.pz.data(),
+                this->parts.ex.data(), this->parts.ey.data(),
+                this->parts.ez.data(),
+                this->parts.bx.data(), this->parts.by.data(),
+                this->parts.bz.data(),
+                this->Qpar, dt);
 
-        double b2 = p.get_local_b_field().square();
+    for (std::size_t p = 0; p < n_par; ++p)
+    {
+        this->_apply_bc(this->parts.x[p], this->parts.y[p], L_x, L_y, dx, dy);
 
-        if (b2) // test if non-zero
-        {
-            ThreeVec t = p.get_local_b_field() * this->Qpar * dt * 0.5;
-            ThreeVec s = t * (2. / (1. + t.square()));
+        // For total kinetic energy diagnostic
+        // KE *= mom.mag();
+        // this->total_KE += KE;
+    }
 
-            ThreeVec vperp = mom - ((mom.element_multiply(p.get_local_b_field())) / sqrt(b2));
-            ThreeVec vstar = vperp + (vperp^t);
+    // For total kinetic energy diagnostic
+    // this->total_KE *= (L_sys / (2.0 * double(this->npar)));
 
-            mom += vstar^s;
-        }
+    return 0;
+}
+#endif
 
-        mom += p.get_local_e_field() * (this->Qpar * dt * 0.5);
 
-        pos += mom * (dt / gamma);
+/**
+ * @brief Interpolates the fields to each particle and performs a Boris push
+ *        in a single pass over the particles, without storing the local
+ *        fields. In tiled mode the fields are read from a small copy of the
+ *        grid around each tile.
+ *
+ * @param e_field Electric field to push the particles with
+ * @param b_field Magnetic field to push the particles with
+ * @param use_b_field Whether to gather b_field. If false, the particles only
+ *                    see the electric field
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param dt Timestep
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @return int Returns an error code or 0 if successful
+ */
+int Species::gather_push_particles(const Field& e_field, const Field& b_field,
+                                   const bool use_b_field,
+                                   const double L_x, const double L_y,
+                                   const double dt,
+                                   const double dx, const double dy)
+{
+    if (this->tiled)
+    {
+        return this->_gather_push_tiled(e_field, b_field, use_b_field,
+                                        L_x, L_y, dt, dx, dy);
+    }
+
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t n_par = this->parts.size();
+
+    // The fields of a chunk of particles are gathered first, so that the push
+    // itself runs over contiguous arrays. The magnetic field stays zero if it
+    // is not gathered. The chunks are shared out with the static schedule
+    // that place_particles lays the particles out for.
+    const std::size_t stride = Species::push_chunk;
+    const std::size_t n_chunks = (n_par + stride - 1) / stride;
+
+    const GridDims::Layout e_layout = this->_gather_layout(e_field);
+    const GridDims::Layout b_layout = this->_gather_layout(b_field);
+    const Gather_Kernel::type e_gather =
+        this->_select_kernel<Gather_Kernel>(e_layout);
+    const Gather_Kernel::type b_gather =
+        this->_select_kernel<Gather_Kernel>(b_layout);
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t c = 0; c < n_chunks; ++c)
+    {
+        real_t fields[6 * stride] = {};
+        real_t* e_loc = fields;
+        real_t* b_loc = fields + 3 * stride;
 
-        this->_apply_bc(pos, L_x, L_y, dx, dy);
+        const std::size_t begin = c * stride;
+        const std::size_t n = std::min(stride, n_par - begin);
 
-        p.set_mom(mom);
-        p.set_pos(pos);
+        (this->*e_gather)(e_field, e_layout, begin, n, dx, dy, L_x, L_y,
+                          e_loc, e_loc + stride, e_loc + 2 * stride);
+        if (use_b_field)
+        {
+            (this->*b_gather)(b_field, b_layout, begin, n, dx, dy, L_x, L_y,
+                              b_loc, b_loc + stride, b_loc + 2 * stride);
+        }
 
-        // For total kinetic energy diagnostic
-        // KE *= mom.mag();
-        // this->total_KE += KE;
+        this->_push_chunk(begin, n, fields, L_x, L_y, dt, dx, dy);
     }
 
-    // For total kinetic energy diagnostic
-    // this->total_KE *= (L_sys / (2.0 * double(this->npar)));
-
     return 0;
 }
 
+/**
+ * @brief Lays the particles out in memory for n_threads threads: the pages of
+ *        each chunk of particles are first written by the thread that pushes
+ *        it. On a NUMA machine each thread then streams over particles in its
+ *        own memory. Sorting keeps the placement.
+ *
+ */
+void Species::place_particles()
+{
+    this->parts.place(Species::push_chunk, Threads::resolve(this->n_threads));
+}
+
 /**
  * @brief Applies the boundary condition for every particle in the species
  *
@@ -321,12 +447,144 @@ int Species::push_particles(const double L_x, const double L_y,
 void Species::apply_bc(const double L_x, const double L_y,
                        const double dx, const double dy)
 {
-    for (auto &p : this->parts)
+    const std::size_t n_par = this->parts.size();
+
+    for (std::size_t p = 0; p < n_par; ++p)
+    {
+        this->_apply_bc(this->parts.x[p], this->parts.y[p], L_x, L_y, dx, dy);
+    }
+}
+
+/**
+ * @brief Sorts the particles by the grid cell they are in, so that particles
+ *        that are close together on the grid are also close together in
+ *        memory. Particles only move about a cell per step, so if most of them
+ *        are still in the cell they were sorted into last time, only the ones
+ *        that left their cell are sorted and merged back in. Otherwise a full
+ *        counting sort is done. In tiled mode the cells are ordered tile by
+ *        tile, which also bins the particles by tile.
+ *
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @return true If the incremental sort was used
+ * @return false If a full counting sort was done
+ */
+bool Species::sort_particles(const double dx, const double dy,
+                             const double L_x, const double L_y,
+                             const std::size_t Nx, const std::size_t Ny)
+{
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t n_par = this->parts.size();
+    const std::size_t n_cells = Nx * Ny;
+
+    this->sort_keys.resize(n_par);
+    this->sort_order.resize(n_par);
+    this->sort_movers.reserve(n_par / 4 + 1);
+
+    #pragma omp parallel for num_threads(nt) schedule(static)
+    for (std::size_t p = 0; p < n_par; ++p)
+    {
+        this->sort_keys[p] = this->_cell_index(this->parts.x[p],
+                                               this->parts.y[p],
+                                               dx, dy, L_x, L_y, Nx, Ny);
+    }
+
+    // The incremental path needs the cell boundaries from the last sort, with
+    // the cells numbered the same way
+    const std::size_t tnx = this->_tile_size(Nx, true);
+    const std::size_t tny = this->_tile_size(Ny, false);
+    bool incremental = (this->cell_offsets.size() == n_cells + 1 &&
+                        this->cell_offsets[n_cells] == n_par &&
+                        this->sorted_tile_nx == tnx &&
+                        this->sorted_tile_ny == tny);
+
+    if (incremental)
+    {
+        // Not worth it if a large fraction of the particles changed cells.
+        // The movers never outgrow their reserved space, so a sort in steady
+        // state does not allocate.
+        const std::size_t max_movers = n_par / 4;
+        this->sort_movers.clear();
+
+        // Particles still in their old cell are already in sorted order
+        std::size_t n_stay = 0;
+        std::size_t c = 0;
+        for (std::size_t p = 0; p < n_par; ++p)
+        {
+            while (this->cell_offsets[c + 1] <= p)
+            {
+                ++c;
+            }
+
+            if (this->sort_keys[p] == c)
+            {
+                this->sort_order[n_stay++] = p;
+            }
+            else
+            {
+                this->sort_movers.push_back(p);
+                if (this->sort_movers.size() > max_movers)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (this->sort_movers.size() > max_movers)
+        {
+            incremental = false;
+        }
+        else
+        {
+            const std::vector<std::size_t>& keys = this->sort_keys;
+            auto by_key = [&keys](std::size_t a, std::size_t b)
+            {
+                return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+            };
+
+            std::sort(this->sort_movers.begin(), this->sort_movers.end(),
+                      by_key);
+
+            this->sort_merged.resize(n_par);
+            std::merge(this->sort_order.begin(),
+                       this->sort_order.begin() + n_stay,
+                       this->sort_movers.begin(), this->sort_movers.end(),
+                       this->sort_merged.begin(), by_key);
+            this->sort_order.swap(this->sort_merged);
+        }
+    }
+
+    // Cell counts give the new cell boundaries, and the full sort needs them
+    this->cell_offsets.assign(n_cells + 1, 0);
+    for (std::size_t p = 0; p < n_par; ++p)
+    {
+        ++(this->cell_offsets[this->sort_keys[p] + 1]);
+    }
+    for (std::size_t c = 0; c < n_cells; ++c)
+    {
+        this->cell_offsets[c + 1] += this->cell_offsets[c];
+    }
+
+    if (!incremental)
     {
-        ThreeVec pos = p.get_pos();
-        this->_apply_bc(pos, L_x, L_y, dx, dy);
-        p.set_pos(pos);
+        this->sort_merged.assign(this->cell_offsets.begin(),
+                                 this->cell_offsets.end() - 1);
+        for (std::size_t p = 0; p < n_par; ++p)
+        {
+            this->sort_order[(this->sort_merged[this->sort_keys[p]])++] = p;
+        }
     }
+
+    this->parts.reorder(this->sort_order);
+
+    this->sorted_tile_nx = tnx;
+    this->sorted_tile_ny = tny;
+
+    return incremental;
 }
 
 /**
@@ -337,11 +595,11 @@ void Species::apply_bc(const double L_x, const double L_y,
  */
 DataStorage_1D Species::get_x_phasespace()
 {
-    DataStorage_1D to_ret(this->Npar);
+    DataStorage_1D to_ret(this->parts.size());
 
-    for (std::size_t i = 0; i < this->Npar; ++i)
+    for (std::size_t i = 0; i < this->parts.size(); ++i)
     {
-        to_ret[i] = this->parts[i].get_pos().get_x();
+        to_ret[i] = this->parts.x[i];
     }
 
     return to_ret;
@@ -355,11 +613,11 @@ DataStorage_1D Species::get_x_phasespace()
  */
 DataStorage_1D Species::get_y_phasespace()
 {
-    DataStorage_1D to_ret(this->Npar);
+    DataStorage_1D to_ret(this->parts.size());
 
-    for (std::size_t i = 0; i < this->Npar; ++i)
+    for (std::size_t i = 0; i < this->parts.size(); ++i)
     {
-        to_ret[i] = this->parts[i].get_pos().get_y();
+        to_ret[i] = this->parts.y[i];
     }
 
     return to_ret;
@@ -373,11 +631,11 @@ DataStorage_1D Species::get_y_phasespace()
  */
 DataStorage_1D Species::get_px_phasespace()
 {
-    DataStorage_1D to_ret(this->Npar);
+    DataStorage_1D to_ret(this->parts.size());
 
-    for (std::size_t i = 0; i < this->Npar; ++i)
+    for (std::size_t i = 0; i < this->parts.size(); ++i)
     {
-        to_ret[i] = this->parts[i].get_mom().get_x();
+        to_ret[i] = this->parts.px[i];
     }
 
     return to_ret;
@@ -391,24 +649,30 @@ DataStorage_1D Species::get_px_phasespace()
  */
 DataStorage_1D Species::get_py_phasespace()
 {
-    DataStorage_1D to_ret(this->Npar);
+    DataStorage_1D to_ret(this->parts.size());
 
-    for (std::size_t i = 0; i < this->Npar; ++i)
+    for (std::size_t i = 0; i < this->parts.size(); ++i)
     {
-        to_ret[i] = this->parts[i].get_mom().get_y();
+        to_ret[i] = this->parts.py[i];
     }
 
     return to_ret;
 }
 
 
+#if PIC_FIELD_CACHE
 std::vector<double> Species::get_local_E(std::size_t i)
 {
-    std::vector<double> to_ret = std::vector<double>(this->Npar);
+    std::vector<double> to_ret = std::vector<double>(this->parts.size());
+
+    if (!this->parts.has_field_cache())
+    {
+        return to_ret;
+    }
 
-    for (std::size_t i = 0; i < this->Npar; ++i)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        to_ret[i] = this->parts[i].get_local_e_field().get(i);
+        to_ret[p] = this->parts.get_local_e_field(p).get(i);
     }
 
     return to_ret;
@@ -416,15 +680,21 @@ std::vector<double> Species::get_local_E(std::size_t i)
 
 std::vector<double> Species::get_local_B(std::size_t i)
 {
-    std::vector<double> to_ret = std::vector<double>(this->Npar);
+    std::vector<double> to_ret = std::vector<double>(this->parts.size());
 
-    for (std::size_t i = 0; i < this->Npar; ++i)
+    if (!this->parts.has_field_cache())
     {
-        to_ret[i] = (this->parts[i].get_local_b_field()).get(i);
+        return to_ret;
+    }
+
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
+    {
+        to_ret[p] = this->parts.get_local_b_field(p).get(i);
     }
 
     return to_ret;
 }
+#endif
 
 /**
  * @brief Prints the positions of all the particles in the species
@@ -432,9 +702,9 @@ std::vector<double> Species::get_local_B(std::size_t i)
  */
 void Species::print_pos() const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_pos();
+        this->parts.get_particle(p).print_pos();
     }
 }
 
@@ -446,9 +716,9 @@ void Species::print_pos() const
  */
 void Species::print_pos_comp(std::size_t i) const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_pos_comp(i);
+        this->parts.get_particle(p).print_pos_comp(i);
     }
 }
 
@@ -458,9 +728,9 @@ void Species::print_pos_comp(std::size_t i) const
  */
 void Species::print_mom() const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_mom();
+        this->parts.get_particle(p).print_mom();
     }
 }
 
@@ -472,9 +742,9 @@ void Species::print_mom() const
  */
 void Species::print_mom_comp(std::size_t i) const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_mom_comp(i);
+        this->parts.get_particle(p).print_mom_comp(i);
     }
 }
 
@@ -484,21 +754,22 @@ void Species::print_mom_comp(std::size_t i) const
  */
 void Species::print_weight() const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_weight();
+        this->parts.get_particle(p).print_weight();
     }
 }
 
+#if PIC_FIELD_CACHE
 /**
  * @brief Prints the local electric field for all the particles in the species
  *
  */
 void Species::print_local_e_field() const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_local_e_field();
+        this->parts.get_particle(p).print_local_e_field();
     }
 }
 
@@ -510,9 +781,9 @@ void Species::print_local_e_field() const
  */
 void Species::print_local_e_field_comp(std::size_t i) const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_local_e_field_comp(i);
+        this->parts.get_particle(p).print_local_e_field_comp(i);
     }
 }
 
@@ -522,9 +793,9 @@ void Species::print_local_e_field_comp(std::size_t i) const
  */
 void Species::print_local_b_field() const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_local_b_field();
+        this->parts.get_particle(p).print_local_b_field();
     }
 }
 
@@ -536,11 +807,12 @@ void Species::print_local_b_field() const
  */
 void Species::print_local_b_field_comp(std::size_t i) const
 {
-    for (auto &p : this->parts)
+    for (std::size_t p = 0; p < this->parts.size(); ++p)
     {
-        p.print_local_b_field_comp(i);
+        this->parts.get_particle(p).print_local_b_field_comp(i);
     }
 }
+#endif
 
 /**
  * @brief Prints the density distribution for this species
@@ -563,44 +835,1237 @@ void Species::init_species(std::function<void(Species &, std::size_t)> init_fcn)
 }
 
 /**
- * @brief Currently applies periodic boundary conditions in x and y directions
- *        for the species
+ * @brief Get a position in units of the grid spacing, so that grid point i
+ *        is at i
  *
- * @param pos A vector containing all position components of the particle
+ * @param x_pos The physical x position
+ * @param y_pos The physical y position
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
  * @param L_x Physical length of system in x direction
  * @param L_y Physical length of system in y direction
+ * @param fi Set to the x position in grid units, only negative for positions
+ *           more than one system length below the grid
+ * @param fj Set to the y position in grid units, likewise
+ */
+inline void Species::_grid_coords(real_t x_pos, real_t y_pos,
+                                  const double dx, const double dy,
+                                  const double L_x, const double L_y,
+                                  real_t& fi, real_t& fj) const
+{
+    const real_t x_min = 0.0, y_min = 0.0;
+
+    // This is because I have chosen to start my boundary at -dx/2
+    if (x_pos < 0)
+    {
+        x_pos += real_t(L_x);
+    }
+    if (y_pos < 0)
+    {
+        y_pos += real_t(L_y);
+    }
+
+    fi = (x_pos - x_min) / real_t(dx); // shape function normalization here
+    fj = (y_pos - y_min) / real_t(dy); // shape function normalization here
+}
+
+/**
+ * @brief Get the index of the grid cell a position falls in. The cells are
+ *        numbered tile by tile, and in the same order as the grid data is
+ *        stored within a tile. Without tiling the whole grid is one tile.
+ *
+ * @param x_pos The physical x position
+ * @param y_pos The physical y position
  * @param dx Spatial grid step in x direction
  * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @return std::size_t The cell index
  */
-void Species::_apply_bc(ThreeVec& pos,
-                       const double L_x, const double L_y,
-                       const double dx, const double dy)
+inline std::size_t Species::_cell_index(double x_pos, double y_pos,
+                                        const double dx, const double dy,
+                                        const double L_x, const double L_y,
+                                        const std::size_t Nx,
+                                        const std::size_t Ny) const
+{
+    real_t fi, fj;
+    this->_grid_coords(x_pos, y_pos, dx, dy, L_x, L_y, fi, fj);
+
+    // The push keeps the particles inside the box, but before the first step
+    // they can be anywhere the initial conditions put them
+    const std::size_t i = wrap_index(long(floor(fi)), Nx);
+    const std::size_t j = wrap_index(long(floor(fj)), Ny);
+
+    const std::size_t tnx = this->_tile_size(Nx, true);
+    const std::size_t tny = this->_tile_size(Ny, false);
+    const std::size_t n_tx = std::max(Nx / tnx, std::size_t(1));
+    const std::size_t n_ty = std::max(Ny / tny, std::size_t(1));
+    const std::size_t tx = std::min(i / tnx, n_tx - 1);
+    const std::size_t ty = std::min(j / tny, n_ty - 1);
+
+    std::size_t sx, wx, sy, wy;
+    this->_tile_extent(tx, tnx, Nx, sx, wx);
+    this->_tile_extent(ty, tny, Ny, sy, wy);
+
+    // All the tiles left of this one, then the tiles below it in its column
+    return sx * Ny + wx * sy + (i - sx) * wy + (j - sy);
+}
+
+/**
+ * @brief Get the tile size in one direction, which is the whole grid when
+ *        tiling is off
+ *
+ * @param N Number of grid spaces in that direction
+ * @param x_dir Whether the direction is x
+ * @return std::size_t The nominal number of cells in a tile
+ */
+inline std::size_t Species::_tile_size(const std::size_t N,
+                                       const bool x_dir) const
+{
+    if (!this->tiled)
+    {
+        return N;
+    }
+
+    return x_dir ? this->tile_nx : this->tile_ny;
+}
+
+/**
+ * @brief Get the cells covered by a tile in one direction. The last tile
+ *        takes whatever is left over, so no tile is narrower than tile_n
+ *        unless the grid is.
+ *
+ * @param t Index of the tile
+ * @param tile_n Nominal number of cells in a tile
+ * @param N Number of grid spaces in that direction
+ * @param start Set to the index of the first cell of the tile
+ * @param width Set to the number of cells in the tile
+ */
+inline void Species::_tile_extent(const std::size_t t,
+                                  const std::size_t tile_n,
+                                  const std::size_t N,
+                                  std::size_t& start, std::size_t& width) const
+{
+    const std::size_t n_tiles = std::max(N / tile_n, std::size_t(1));
+
+    start = t * tile_n;
+    width = (t == n_tiles - 1) ? N - start : tile_n;
+}
+
+/**
+ * @brief Whether the last sort binned the current particles into the current
+ *        tiles
+ *
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @return true If the tile particle ranges can be used
+ * @return false If the particles need to be sorted first
+ */
+bool Species::_tiles_binned(const std::size_t Nx, const std::size_t Ny) const
+{
+    return this->cell_offsets.size() == Nx * Ny + 1 &&
+           this->cell_offsets[Nx * Ny] == this->parts.size() &&
+           this->sorted_tile_nx == this->_tile_size(Nx, true) &&
+           this->sorted_tile_ny == this->_tile_size(Ny, false);
+}
+
+/**
+ * @brief Get the range of particles binned into a tile by the last sort
+ *
+ * @param tx x index of the tile
+ * @param ty y index of the tile
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @param begin Set to the index of the first particle in the tile
+ * @param end Set to one past the index of the last particle in the tile
+ */
+void Species::_tile_particles(const std::size_t tx, const std::size_t ty,
+                              const std::size_t Nx, const std::size_t Ny,
+                              std::size_t& begin, std::size_t& end) const
+{
+    std::size_t sx, wx, sy, wy;
+    this->_tile_extent(tx, this->_tile_size(Nx, true), Nx, sx, wx);
+    this->_tile_extent(ty, this->_tile_size(Ny, false), Ny, sy, wy);
+
+    const std::size_t first_cell = sx * Ny + wx * sy;
+    begin = this->cell_offsets[first_cell];
+    end = this->cell_offsets[first_cell + wx * wy];
+}
+
+/**
+ * @brief Sorts the particles into tiles if they have not been binned with
+ *        the current tile size yet. The tiles are only as current as the last
+ *        sort, so particles may have drifted out of them since.
+ *
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ */
+void Species::_bin_tiles(const double dx, const double dy,
+                         const double L_x, const double L_y,
+                         const std::size_t Nx, const std::size_t Ny)
+{
+    if (this->tile_nx < 2 * Species::tile_guard ||
+        this->tile_ny < 2 * Species::tile_guard)
+    {
+        throw std::runtime_error("Error: Tiles must be at least 6 cells wide");
+    }
+
+    if (!this->_tiles_binned(Nx, Ny))
+    {
+        this->sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+    }
+}
+
+/**
+ * @brief Tiles that share a colour are at least one tile apart, also across
+ *        the periodic boundary, so their windows never overlap. An odd number
+ *        of tiles needs a third colour for the last one.
+ *
+ * @param t Index of the tile in one direction
+ * @param n_tiles Number of tiles in that direction
+ * @return std::size_t The colour of the tile in that direction
+ */
+static inline std::size_t tile_color(const std::size_t t,
+                                     const std::size_t n_tiles)
+{
+    if (n_tiles % 2 && n_tiles > 1 && t == n_tiles - 1)
+    {
+        return 2;
+    }
+
+    return t % 2;
+}
+
+/**
+ * @brief Get the index within a tile window of the first grid point of a
+ *        particle's shape, where the window starts guard cells before the
+ *        tile. Looks across the periodic boundary if the shape is not in the
+ *        window directly.
+ *
+ * @param first Index of the first grid point of the shape on the grid
+ * @param start Index of the first cell of the tile
+ * @param win Number of cells in the window
+ * @param support Number of grid points the shape covers
+ * @param guard Number of guard cells on each side of the tile
+ * @param N Number of grid spaces in that direction, or 0 to never look
+ *          across the boundary
+ * @return long The index in the window, or -1 if the shape does not fit
+ *              inside the window
+ */
+static inline long window_index(const long first, const std::size_t start,
+                                const long win, const int support,
+                                const std::size_t guard, const std::size_t N)
+{
+    long li = first - long(start) + long(guard);
+
+    if (li < 0)
+    {
+        li += long(N);
+    }
+    else if (li + support > win)
+    {
+        li -= long(N);
+    }
+
+    if (li < 0 || li + support > win)
+    {
+        return -1;
+    }
+
+    return li;
+}
+
+/**
+ * @brief Deposits the charge tile by tile. Each tile scatters its particles
+ *        into a local window of the grid, which is small enough to stay in
+ *        cache, and then adds the window onto the grid in one go. Tiles are
+ *        handed out to the threads one colour at a time so that no two threads
+ *        add onto the same part of the grid. Particles that have left the
+ *        window of their tile since the last sort are deposited directly onto
+ *        the grid afterwards. The result does not depend on the number of
+ *        threads.
+ *
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @return int Returns an error code or 0 if successful
+ */
+int Species::_deposit_tiled(const double dx, const double dy,
+                            const double L_x, const double L_y,
+                            const std::size_t Nx, const std::size_t Ny)
 {
-    double x1 = pos.get_x();
-    double y1 = pos.get_y();
+    this->_bin_tiles(dx, dy, L_x, L_y, Nx, Ny);
+
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t g = Species::tile_guard;
+    const std::size_t n_tx = std::max(Nx / this->tile_nx, std::size_t(1));
+    const std::size_t n_ty = std::max(Ny / this->tile_ny, std::size_t(1));
+
+    DataStorage_2D& dens = this->density_arr.gridded_data;
+
+    this->tile_windows.resize(nt);
+    this->tile_strays.resize(n_tx * n_ty);
+    this->density_arr.zero();
+
+    for (std::size_t color = 0; color < 9; ++color)
+    {
+        this->tile_batch.clear();
+        for (std::size_t t = 0; t < n_tx * n_ty; ++t)
+        {
+            if (tile_color(t / n_ty, n_tx) * 3 + tile_color(t % n_ty, n_ty) ==
+                color)
+            {
+                this->tile_batch.push_back(t);
+            }
+        }
+
+        #pragma omp parallel for num_threads(nt) schedule(dynamic)
+        for (std::size_t b = 0; b < this->tile_batch.size(); ++b)
+        {
+            const std::size_t t = this->tile_batch[b];
+
+            std::size_t sx, wx, sy, wy, begin, end;
+            this->_tile_extent(t / n_ty, this->tile_nx, Nx, sx, wx);
+            this->_tile_extent(t % n_ty, this->tile_ny, Ny, sy, wy);
+            this->_tile_particles(t / n_ty, t % n_ty, Nx, Ny, begin, end);
+
+            const long win_x = wx + 2 * g, win_y = wy + 2 * g;
+            std::vector<real_t>& win = this->tile_windows[Threads::thread_id()];
+            win.assign(win_x * win_y, 0.0);
+
+            std::vector<std::size_t>& strays = this->tile_strays[t];
+            strays.clear();
+
+            SHAPE_DISPATCH(_deposit_window,
+                           (begin, end, sx, sy, win_x, win_y, Nx, Ny,
+                            dx, dy, L_x, L_y, win.data(), strays));
+
+            for (long a = 0; a < win_x; ++a)
+            {
+                const std::size_t gi = wrap_index(long(sx) + a - long(g), Nx);
+                for (long c = 0; c < win_y; ++c)
+                {
+                    const std::size_t gj = wrap_index(long(sy) + c - long(g),
+                                                      Ny);
+                    dens(gi, gj) += win[a * win_y + c];
+                }
+            }
+        }
+    }
 
+    // The strays share one pass over the guard cells
+    if (this->guard_cells)
+    {
+        this->density_arr.zero_guards(Shape::guard_cells);
+    }
+
+    const GridDims::Layout layout = this->_deposit_layout(this->density_arr);
+    const Deposit_Kernel::type deposit =
+        this->_select_kernel<Deposit_Kernel>(layout);
+
+    for (std::size_t t = 0; t < n_tx * n_ty; ++t)
+    {
+        for (std::size_t p : this->tile_strays[t])
+        {
+            (this->*deposit)(this->density_arr, layout, p, p + 1,
+                             dx, dy, L_x, L_y);
+        }
+    }
+
+    if (this->guard_cells)
+    {
+        this->density_arr.fold_guards();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Copies the part of a field covered by a tile window, reading it
+ *        from the same layout as the untiled gather: the interleaved nodes or
+ *        the guard cells of the components, which hold the images behind any
+ *        walls, or else the field itself wrapped around the periodic
+ *        boundaries
+ *
+ * @param f The field to copy from
+ * @param layout Layout of the field, from _gather_layout
+ * @param sx Index of the first x cell of the tile
+ * @param wx Number of x cells in the tile
+ * @param sy Index of the first y cell of the tile
+ * @param wy Number of y cells in the tile
+ * @param win Window to copy into, holding the three components one after
+ *            another, each stored in the same order as the grid
+ */
+void Species::_load_window(const Field& f, const GridDims::Layout& layout,
+                           const std::size_t sx, const std::size_t wx,
+                           const std::size_t sy, const std::size_t wy,
+                           real_t* win) const
+{
+    const long g = Species::tile_guard;
+    const std::size_t Nx = f.f1.Nx, Ny = f.f1.Ny;
+    const long win_x = wx + 2 * g, win_y = wy + 2 * g;
+    const long win_size = win_x * win_y;
+    const GridObject* comps[3] = {&f.f1, &f.f2, &f.f3};
+
+    for (long a = 0; a < win_x; ++a)
+    {
+        const long i = long(sx) + a - g;
+        for (long c = 0; c < win_y; ++c)
+        {
+            const long j = long(sy) + c - g;
+            real_t* w = win + a * win_y + c;
+            if (layout.node_stride != 0)
+            {
+                const real_t* nd = f.node(i, j);
+                for (int k = 0; k < 3; ++k)
+                {
+                    w[k * win_size] = nd[k];
+                }
+            }
+            else if (layout.guard_stride != 0)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    w[k * win_size] = comps[k]->guarded(i, j);
+                }
+            }
+            else
+            {
+                const std::size_t gi = wrap_index(i, Nx);
+                const std::size_t gj = wrap_index(j, Ny);
+                for (int k = 0; k < 3; ++k)
+                {
+                    w[k * win_size] = comps[k]->gridded_data(gi, gj);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Gathers the fields and pushes the particles tile by tile. Each tile
+ *        first copies the fields around it into a local window, and the tiles
+ *        are shared out among the threads. Particles that have left the
+ *        window of their tile since the last sort read the full fields.
+ *
+ * @param e_field Electric field to push the particles with
+ * @param b_field Magnetic field to push the particles with
+ * @param use_b_field Whether to gather b_field
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param dt Timestep
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @return int Returns an error code or 0 if successful
+ */
+int Species::_gather_push_tiled(const Field& e_field, const Field& b_field,
+                                const bool use_b_field,
+                                const double L_x, const double L_y,
+                                const double dt,
+                                const double dx, const double dy)
+{
+    const std::size_t Nx = e_field.f1.Nx, Ny = e_field.f1.Ny;
+
+    this->_bin_tiles(dx, dy, L_x, L_y, Nx, Ny);
+
+    const int nt = Threads::resolve(this->n_threads);
+    const std::size_t g = Species::tile_guard;
+    const std::size_t n_tx = std::max(Nx / this->tile_nx, std::size_t(1));
+    const std::size_t n_ty = std::max(Ny / this->tile_ny, std::size_t(1));
+
+    this->tile_windows.resize(nt);
+
+    const GridDims::Layout e_layout = this->_gather_layout(e_field);
+    const GridDims::Layout b_layout = this->_gather_layout(b_field);
+
+    #pragma omp parallel for num_threads(nt) schedule(dynamic)
+    for (std::size_t t = 0; t < n_tx * n_ty; ++t)
+    {
+        std::size_t sx, wx, sy, wy, begin, end;
+        this->_tile_extent(t / n_ty, this->tile_nx, Nx, sx, wx);
+        this->_tile_extent(t % n_ty, this->tile_ny, Ny, sy, wy);
+        this->_tile_particles(t / n_ty, t % n_ty, Nx, Ny, begin, end);
+
+        const long win_x = wx + 2 * g, win_y = wy + 2 * g;
+        const long win_size = win_x * win_y;
+        std::vector<real_t>& win = this->tile_windows[Threads::thread_id()];
+        win.resize(6 * win_size);
+
+        const std::size_t stride = Species::push_chunk;
+        real_t fields[6 * stride] = {};
+        real_t* e_loc = fields;
+        real_t* b_loc = fields + 3 * stride;
+
+        real_t* e_win = win.data();
+        real_t* b_win = win.data() + 3 * win_size;
+        this->_load_window(e_field, e_layout, sx, wx, sy, wy, e_win);
+        if (use_b_field)
+        {
+            this->_load_window(b_field, b_layout, sx, wx, sy, wy, b_win);
+        }
+
+        for (std::size_t c = begin; c < end; c += stride)
+        {
+            const std::size_t n = std::min(stride, end - c);
+
+            SHAPE_DISPATCH(_gather_window,
+                           (e_field, e_layout, e_win, c, n, sx, sy,
+                            win_x, win_y,
+                            dx, dy, L_x, L_y,
+                            e_loc, e_loc + stride, e_loc + 2 * stride));
+            if (use_b_field)
+            {
+                SHAPE_DISPATCH(_gather_window,
+                               (b_field, b_layout, b_win, c, n, sx, sy,
+                                win_x, win_y,
+                                dx, dy, L_x, L_y,
+                                b_loc, b_loc + stride, b_loc + 2 * stride));
+            }
+
+            this->_push_chunk(c, n, fields, L_x, L_y, dt, dx, dy);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Deposits the charge of a contiguous range of particles onto a grid,
+ *        adding to what is already stored there. With guard_cells the charge
+ *        goes to the guard cells of the grid first, which are then folded
+ *        onto it.
+ *
+ * @param grid Grid to deposit the charge onto
+ * @param begin Index of the first particle to deposit
+ * @param end One past the index of the last particle to deposit
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ */
+void Species::_deposit_range(GridObject& grid,
+                             const std::size_t begin, const std::size_t end,
+                             const double dx, const double dy,
+                             const double L_x, const double L_y) const
+{
+    if (this->guard_cells)
+    {
+        grid.zero_guards(Shape::guard_cells);
+    }
+
+    const GridDims::Layout layout = this->_deposit_layout(grid);
+    const Deposit_Kernel::type deposit =
+        this->_select_kernel<Deposit_Kernel>(layout);
+    (this->*deposit)(grid, layout, begin, end, dx, dy, L_x, L_y);
+
+    if (this->guard_cells)
+    {
+        grid.fold_guards();
+    }
+}
+
+/**
+ * @brief Get the layout the deposit kernel works on: the guard cells of the
+ *        grid with guard_cells, which must have been zeroed, or the grid
+ *        itself with its indices wrapped
+ *
+ * @param grid Grid to deposit the charge onto
+ * @return GridDims::Layout The layout of the grid
+ */
+inline GridDims::Layout Species::_deposit_layout(const GridObject& grid) const
+{
+    GridDims::Layout layout(grid.Nx, grid.Ny);
+
+    if (this->guard_cells)
+    {
+        layout.guard_stride = grid.get_guard_stride();
+    }
+
+    return layout;
+}
+
+/**
+ * @brief Get the layout the gather kernel reads a field from: its
+ *        interleaved nodes or the guard cells of its components if they have
+ *        been exchanged, or else the field itself with its indices wrapped
+ *
+ * @param f Field to interpolate
+ * @return GridDims::Layout The layout of the field
+ */
+inline GridDims::Layout Species::_gather_layout(const Field& f) const
+{
+    GridDims::Layout layout(f.f1.Nx, f.f1.Ny);
+
+    if (!this->guard_cells || !f.has_guards())
+    {
+        return layout;
+    }
+
+    // The components are read with one stride, so they must share it
+    const std::size_t stride = f.f1.get_guard_stride();
+    if (f.is_interleaved())
+    {
+        layout.node_stride = f.get_node_stride();
+    }
+    else if (f.f2.get_guard_stride() == stride &&
+             f.f3.get_guard_stride() == stride)
+    {
+        layout.guard_stride = stride;
+    }
+
+    return layout;
+}
+
+/**
+ * @brief Get the kernel of the shape order of the species for a layout,
+ *        compiled for its grid dimensions if fixed_grids is set and they are
+ *        one of PIC_FIXED_GRIDS
+ *
+ * @tparam Kernel Deposit_Kernel or Gather_Kernel
+ * @param layout The layout the kernel will work on
+ * @return Kernel::type The kernel to call
+ */
+template <typename Kernel>
+inline typename Kernel::type
+Species::_select_kernel(const GridDims::Layout& layout) const
+{
+    if (this->fixed_grids)
+    {
+        return GridDims::select<Kernel>(layout, this->shape_order);
+    }
+
+    return Kernel::template get<GridDims::Dynamic>(this->shape_order);
+}
+
+/**
+ * @brief Get the deposit kernel of a shape order for grid dimensions Dims
+ *
+ * @tparam Dims GridDims::Dynamic or a GridDims::Fixed
+ * @param order Order of the particle shape function
+ * @return type The kernel
+ */
+template <typename Dims>
+Species::Deposit_Kernel::type Species::Deposit_Kernel::get(const int order)
+{
+    SHAPE_KERNEL(_deposit_shape, Dims)
+}
+
+/**
+ * @brief Get the gather kernel of a shape order for grid dimensions Dims
+ *
+ * @tparam Dims GridDims::Dynamic or a GridDims::Fixed
+ * @param order Order of the particle shape function
+ * @return type The kernel
+ */
+template <typename Dims>
+Species::Gather_Kernel::type Species::Gather_Kernel::get(const int order)
+{
+    SHAPE_KERNEL(_gather_range, Dims)
+}
+
+/**
+ * @brief Deposits the charge of a contiguous range of particles onto a grid
+ *        with the shape function of the given order. With a guard stride in
+ *        the layout it deposits into the guard cells of the grid, which the
+ *        caller zeroes before and folds onto the grid after.
+ *
+ * @tparam Order Order of the particle shape function
+ * @tparam Dims Dimensions of the grid, GridDims::Dynamic or a GridDims::Fixed
+ * @param grid Grid to deposit the charge onto
+ * @param layout Layout of the grid
+ * @param begin Index of the first particle to deposit
+ * @param end One past the index of the last particle to deposit
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ */
+template <int Order, typename Dims>
+void Species::_deposit_shape(GridObject& grid, const GridDims::Layout& layout,
+                             const std::size_t begin, const std::size_t end,
+                             const double dx, const double dy,
+                             const double L_x, const double L_y) const
+{
+    typedef Shape::BSpline<Order> S;
+
+    const Dims dims(layout);
+    real_t* dens = grid.gridded_data.get_data();
+
+    // First grid points whose shape still fits inside the guard cells
+    const long g = Shape::guard_cells;
+    const long last_i = long(dims.nx()) + g - S::support;
+    const long last_j = long(dims.ny()) + g - S::support;
+    const bool guarded = (layout.guard_stride != 0);
+    const long stride = dims.guard_stride();
+    real_t* origin = guarded ? &grid.guarded(0, 0) : nullptr;
+
+    const real_t* x = this->parts.x.data();
+    const real_t* y = this->parts.y.data();
+    const real_t* w = this->parts.w.data();
+
+    for (std::size_t p = begin; p < end; ++p)
+    {
+        real_t par_weight = w[p] / dx / dy; // normalization factor
+
+        real_t fi, fj;
+        this->_grid_coords(x[p], y[p], dx, dy, L_x, L_y, fi, fj);
+
+        long i, j;
+        real_t wx[S::support], wy[S::support];
+        S::weights(fi, i, wx);
+        S::weights(fj, j, wy);
+
+        // Only particles that are far outside of the grid, which the push
+        // never leaves, need their indices wrapped
+        if (guarded && i >= -g && i <= last_i && j >= -g && j <= last_j)
+        {
+            for (int a = 0; a < S::support; ++a)
+            {
+                real_t* row = origin + (i + a) * stride + j;
+                for (int b = 0; b < S::support; ++b)
+                {
+                    row[b] += wx[a] * wy[b] * par_weight;
+                }
+            }
+            continue;
+        }
+
+        for (int a = 0; a < S::support; ++a)
+        {
+            real_t* row = dens + dims.wrap_x(i + a) * dims.ny();
+            for (int b = 0; b < S::support; ++b)
+            {
+                row[dims.wrap_y(j + b)] += wx[a] * wy[b] * par_weight;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Deposits the charge of the particles of a tile into its window.
+ *        Particles whose shape does not fit inside the window are left for
+ *        the caller to deposit onto the grid.
+ *
+ * @tparam Order Order of the particle shape function
+ * @param begin Index of the first particle of the tile
+ * @param end One past the index of the last particle of the tile
+ * @param sx Index of the first x cell of the tile
+ * @param sy Index of the first y cell of the tile
+ * @param win_x Number of x cells in the window
+ * @param win_y Number of y cells in the window
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param win The window to deposit into
+ * @param strays Particles that did not fit are appended to this
+ */
+template <int Order>
+void Species::_deposit_window(const std::size_t begin, const std::size_t end,
+                              const std::size_t sx, const std::size_t sy,
+                              const long win_x, const long win_y,
+                              const std::size_t Nx, const std::size_t Ny,
+                              const double dx, const double dy,
+                              const double L_x, const double L_y,
+                              real_t* win,
+                              std::vector<std::size_t>& strays) const
+{
+    typedef Shape::BSpline<Order> S;
+
+    const real_t* x = this->parts.x.data();
+    const real_t* y = this->parts.y.data();
+    const real_t* w = this->parts.w.data();
+
+    for (std::size_t p = begin; p < end; ++p)
+    {
+        real_t fi, fj;
+        this->_grid_coords(x[p], y[p], dx, dy, L_x, L_y, fi, fj);
+
+        long i, j;
+        real_t wx[S::support], wy[S::support];
+        S::weights(fi, i, wx);
+        S::weights(fj, j, wy);
+
+        const long li = window_index(i, sx, win_x, S::support, tile_guard, Nx);
+        const long lj = window_index(j, sy, win_y, S::support, tile_guard, Ny);
+
+        if (li < 0 || lj < 0)
+        {
+            strays.push_back(p);
+            continue;
+        }
+
+        real_t par_weight = w[p] / dx / dy; // normalization factor
+
+        for (int a = 0; a < S::support; ++a)
+        {
+            real_t* row = win + (li + a) * win_y + lj;
+            for (int b = 0; b < S::support; ++b)
+            {
+                row[b] += wx[a] * wy[b] * par_weight;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Interpolates the three components of a field to a position with the
+ *        shape function of the given order
+ *
+ * @tparam Order Order of the particle shape function
+ * @tparam Dims Dimensions of the grid, GridDims::Dynamic or a GridDims::Fixed
+ * @param f Field to interpolate
+ * @param dims Dimensions of the field
+ * @param x_pos The physical x position to interpolate to
+ * @param y_pos The physical y position to interpolate to
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param loc_f1 Set to the interpolated first field component
+ * @param loc_f2 Set to the interpolated second field component
+ * @param loc_f3 Set to the interpolated third field component
+ */
+template <int Order, typename Dims>
+inline void Species::_interpolate_field(const Field& f, const Dims& dims,
+                                        double x_pos, double y_pos,
+                                        const double dx, const double dy,
+                                        const double L_x, const double L_y,
+                                        real_t& loc_f1, real_t& loc_f2,
+                                        real_t& loc_f3) const
+{
+    typedef Shape::BSpline<Order> S;
+
+    real_t fi, fj;
+    this->_grid_coords(x_pos, y_pos, dx, dy, L_x, L_y, fi, fj);
+
+    long i, j;
+    real_t wx[S::support], wy[S::support];
+    S::weights(fi, i, wx);
+    S::weights(fj, j, wy);
+
+    // Offsets of the rows and of the points within them
+    std::size_t gi[S::support], gj[S::support];
+    for (int a = 0; a < S::support; ++a)
+    {
+        gi[a] = dims.wrap_x(i + a) * dims.ny();
+        gj[a] = dims.wrap_y(j + a);
+    }
+
+    const real_t* f1 = f.f1.gridded_data.get_data();
+    const real_t* f2 = f.f2.gridded_data.get_data();
+    const real_t* f3 = f.f3.gridded_data.get_data();
+
+    real_t loc_f_x1 = 0.0;
+    real_t loc_f_x2 = 0.0;
+    real_t loc_f_x3 = 0.0;
+
+    for (int b = 0; b < S::support; ++b)
+    {
+        for (int a = 0; a < S::support; ++a)
+        {
+            loc_f_x1 += wx[a] * wy[b] * f1[gi[a] + gj[b]];
+            loc_f_x2 += wx[a] * wy[b] * f2[gi[a] + gj[b]];
+            loc_f_x3 += wx[a] * wy[b] * f3[gi[a] + gj[b]];
+        }
+    }
+
+    loc_f1 = loc_f_x1;
+    loc_f2 = loc_f_x2;
+    loc_f3 = loc_f_x3;
+}
+
+/**
+ * @brief Interpolates the three components of a field to a position with the
+ *        shape function of the given order, reading the field from its guard
+ *        cells without wrapping the indices. Positions far outside of the
+ *        grid wrap them instead.
+ *
+ * @tparam Order Order of the particle shape function
+ * @tparam Dims Dimensions of the grid, GridDims::Dynamic or a GridDims::Fixed
+ * @param f Field to interpolate, with its guard cells exchanged
+ * @param dims Dimensions of the field and the stride of its guard cells
+ * @param origins Point (0, 0) of the guard cell copy of each component
+ * @param x_pos The physical x position to interpolate to
+ * @param y_pos The physical y position to interpolate to
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param loc_f1 Set to the interpolated first field component
+ * @param loc_f2 Set to the interpolated second field component
+ * @param loc_f3 Set to the interpolated third field component
+ */
+template <int Order, typename Dims>
+inline void Species::_interpolate_guarded(const Field& f, const Dims& dims,
+                                          const real_t* const* origins,
+                                          double x_pos, double y_pos,
+                                          const double dx, const double dy,
+                                          const double L_x, const double L_y,
+                                          real_t& loc_f1, real_t& loc_f2,
+                                          real_t& loc_f3) const
+{
+    typedef Shape::BSpline<Order> S;
+
+    const long g = Shape::guard_cells;
+
+    real_t fi, fj;
+    this->_grid_coords(x_pos, y_pos, dx, dy, L_x, L_y, fi, fj);
+
+    long i, j;
+    real_t wx[S::support], wy[S::support];
+    S::weights(fi, i, wx);
+    S::weights(fj, j, wy);
+
+    if (i < -g || i > long(dims.nx()) + g - S::support ||
+        j < -g || j > long(dims.ny()) + g - S::support)
+    {
+        this->_interpolate_field<Order>(f, dims, x_pos, y_pos,
+                                        dx, dy, L_x, L_y,
+                                        loc_f1, loc_f2, loc_f3);
+        return;
+    }
+
+    const long stride = dims.guard_stride();
+    const long first = i * stride + j;
+
+    real_t loc_f_x1 = 0.0;
+    real_t loc_f_x2 = 0.0;
+    real_t loc_f_x3 = 0.0;
+
+    for (int b = 0; b < S::support; ++b)
+    {
+        for (int a = 0; a < S::support; ++a)
+        {
+            const long c = first + a * stride + b;
+            loc_f_x1 += wx[a] * wy[b] * origins[0][c];
+            loc_f_x2 += wx[a] * wy[b] * origins[1][c];
+            loc_f_x3 += wx[a] * wy[b] * origins[2][c];
+        }
+    }
+
+    loc_f1 = loc_f_x1;
+    loc_f2 = loc_f_x2;
+    loc_f3 = loc_f_x3;
+}
+
+/**
+ * @brief Interpolates the three components of a field to a position with the
+ *        shape function of the given order, reading them together from the
+ *        interleaved nodes of the field. Positions far outside of the grid
+ *        wrap the indices instead.
+ *
+ * @tparam Order Order of the particle shape function
+ * @tparam Dims Dimensions of the grid, GridDims::Dynamic or a GridDims::Fixed
+ * @param f Field to interpolate, with its interleaved nodes exchanged
+ * @param dims Dimensions of the field and the stride of its nodes
+ * @param origin Node (0, 0) of the field
+ * @param x_pos The physical x position to interpolate to
+ * @param y_pos The physical y position to interpolate to
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param loc_f1 Set to the interpolated first field component
+ * @param loc_f2 Set to the interpolated second field component
+ * @param loc_f3 Set to the interpolated third field component
+ */
+template <int Order, typename Dims>
+inline void Species::_interpolate_nodes(const Field& f, const Dims& dims,
+                                        const real_t* origin,
+                                        double x_pos, double y_pos,
+                                        const double dx, const double dy,
+                                        const double L_x, const double L_y,
+                                        real_t& loc_f1, real_t& loc_f2,
+                                        real_t& loc_f3) const
+{
+    typedef Shape::BSpline<Order> S;
+
+    const long g = Shape::guard_cells;
+
+    real_t fi, fj;
+    this->_grid_coords(x_pos, y_pos, dx, dy, L_x, L_y, fi, fj);
+
+    long i, j;
+    real_t wx[S::support], wy[S::support];
+    S::weights(fi, i, wx);
+    S::weights(fj, j, wy);
+
+    if (i < -g || i > long(dims.nx()) + g - S::support ||
+        j < -g || j > long(dims.ny()) + g - S::support)
+    {
+        this->_interpolate_field<Order>(f, dims, x_pos, y_pos,
+                                        dx, dy, L_x, L_y,
+                                        loc_f1, loc_f2, loc_f3);
+        return;
+    }
+
+    const long w = Field::node_width;
+    const real_t* first = origin + i * dims.node_stride() + j * w;
+
+    // All the components of a node are added at once, padding included
+    real_t loc_f[Field::node_width] = {};
+
+    for (int b = 0; b < S::support; ++b)
+    {
+        for (int a = 0; a < S::support; ++a)
+        {
+            const real_t* n = first + a * dims.node_stride() + b * w;
+            const real_t weight = wx[a] * wy[b];
+            for (std::size_t c = 0; c < Field::node_width; ++c)
+            {
+                loc_f[c] += weight * n[c];
+            }
+        }
+    }
+
+    loc_f1 = loc_f[0];
+    loc_f2 = loc_f[1];
+    loc_f3 = loc_f[2];
+}
+
+/**
+ * @brief Interpolates the three components of a field to a contiguous range
+ *        of particles
+ *
+ * @tparam Order Order of the particle shape function
+ * @tparam Dims Dimensions of the grid, GridDims::Dynamic or a GridDims::Fixed
+ * @param f Field to interpolate
+ * @param layout Layout of the field, from _gather_layout
+ * @param begin Index of the first particle
+ * @param n Number of particles
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param loc_f1 Array to store the first field component of each particle in
+ * @param loc_f2 Array to store the second field component of each particle in
+ * @param loc_f3 Array to store the third field component of each particle in
+ */
+template <int Order, typename Dims>
+void Species::_gather_range(const Field& f, const GridDims::Layout& layout,
+                            const std::size_t begin, const std::size_t n,
+                            const double dx, const double dy,
+                            const double L_x, const double L_y,
+                            real_t* loc_f1, real_t* loc_f2,
+                            real_t* loc_f3) const
+{
+    const Dims dims(layout);
+
+    if (layout.node_stride != 0)
+    {
+        const real_t* origin = f.node(0, 0);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            this->_interpolate_nodes<Order>(f, dims, origin,
+                                            this->parts.x[begin + k],
+                                            this->parts.y[begin + k],
+                                            dx, dy, L_x, L_y,
+                                            loc_f1[k], loc_f2[k], loc_f3[k]);
+        }
+        return;
+    }
+
+    if (layout.guard_stride != 0)
+    {
+        const real_t* origins[3] = {&f.f1.guarded(0, 0), &f.f2.guarded(0, 0),
+                                    &f.f3.guarded(0, 0)};
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            this->_interpolate_guarded<Order>(f, dims, origins,
+                                              this->parts.x[begin + k],
+                                              this->parts.y[begin + k],
+                                              dx, dy, L_x, L_y,
+                                              loc_f1[k], loc_f2[k],
+                                              loc_f3[k]);
+        }
+        return;
+    }
+
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        this->_interpolate_field<Order>(f, dims, this->parts.x[begin + k],
+                                        this->parts.y[begin + k],
+                                        dx, dy, L_x, L_y,
+                                        loc_f1[k], loc_f2[k], loc_f3[k]);
+    }
+}
+
+/**
+ * @brief Interpolates the three components of a field to a contiguous range
+ *        of particles of a tile, reading the field from the tile window.
+ *        Particles whose shape does not fit inside the window read the full
+ *        field instead.
+ *
+ * @tparam Order Order of the particle shape function
+ * @param f Field to interpolate
+ * @param layout Layout of the field, from _gather_layout
+ * @param win The window of f, holding the three components one after another
+ * @param begin Index of the first particle
+ * @param n Number of particles
+ * @param sx Index of the first x cell of the tile
+ * @param sy Index of the first y cell of the tile
+ * @param win_x Number of x cells in the window
+ * @param win_y Number of y cells in the window
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param loc_f1 Array to store the first field component of each particle in
+ * @param loc_f2 Array to store the second field component of each particle in
+ * @param loc_f3 Array to store the third field component of each particle in
+ */
+template <int Order>
+void Species::_gather_window(const Field& f, const GridDims::Layout& layout,
+                             const real_t* win,
+                             const std::size_t begin, const std::size_t n,
+                             const std::size_t sx, const std::size_t sy,
+                             const long win_x, const long win_y,
+                             const double dx, const double dy,
+                             const double L_x, const double L_y,
+                             real_t* loc_f1, real_t* loc_f2,
+                             real_t* loc_f3) const
+{
+    typedef Shape::BSpline<Order> S;
+
+    const long win_size = win_x * win_y;
+
+    // A window read from the guard cells has the images behind the walls
+    // where the periodic copies would be, so shapes never look across
+    const bool guarded = layout.node_stride != 0 || layout.guard_stride != 0;
+    const std::size_t wrap_x = guarded ? 0 : f.f1.Nx;
+    const std::size_t wrap_y = guarded ? 0 : f.f1.Ny;
+
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const double x_pos = this->parts.x[begin + k];
+        const double y_pos = this->parts.y[begin + k];
+
+        real_t fi, fj;
+        this->_grid_coords(x_pos, y_pos, dx, dy, L_x, L_y, fi, fj);
+
+        long i, j;
+        real_t wx[S::support], wy[S::support];
+        S::weights(fi, i, wx);
+        S::weights(fj, j, wy);
+
+        const long li = window_index(i, sx, win_x, S::support,
+                                    tile_guard, wrap_x);
+        const long lj = window_index(j, sy, win_y, S::support,
+                                    tile_guard, wrap_y);
+
+        if (li < 0 || lj < 0)
+        {
+            this->_gather_range<Order, GridDims::Dynamic>(
+                f, layout, begin + k, 1, dx, dy, L_x, L_y,
+                loc_f1 + k, loc_f2 + k, loc_f3 + k);
+            continue;
+        }
+
+        const real_t* cell = win + li * win_y + lj;
+
+        real_t loc_f_x1 = 0.0;
+        real_t loc_f_x2 = 0.0;
+        real_t loc_f_x3 = 0.0;
+
+        for (int b = 0; b < S::support; ++b)
+        {
+            for (int a = 0; a < S::support; ++a)
+            {
+                const long c = a * win_y + b;
+                loc_f_x1 += wx[a] * wy[b] * cell[c];
+                loc_f_x2 += wx[a] * wy[b] * cell[c + win_size];
+                loc_f_x3 += wx[a] * wy[b] * cell[c + 2 * win_size];
+            }
+        }
+
+        loc_f1[k] = loc_f_x1;
+        loc_f2[k] = loc_f_x2;
+        loc_f3[k] = loc_f_x3;
+    }
+}
+
+/**
+ * @brief Pushes a chunk of consecutive particles with the vectorized Boris
+ *        push and applies the boundary conditions to them
+ *
+ * @param begin Index of the first particle in the chunk
+ * @param n Number of particles in the chunk, at most push_chunk
+ * @param fields The fields at each particle, stored as the ex, ey, ez, bx, by
+ *               and bz arrays of push_chunk values one after another
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param dt Timestep
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ */
+void Species::_push_chunk(const std::size_t begin, const std::size_t n,
+                          const real_t* fields,
+                          const double L_x, const double L_y,
+                          const double dt,
+                          const double dx, const double dy)
+{
+    const std::size_t stride = Species::push_chunk;
+
+    Push::boris(n,
+                this->parts.x.data() + begin, this->parts.y.data() + begin,
+                this->parts.z.data() + begin,
+                this->parts.px.data() + begin, this->parts.py.data() + begin,
+                this->parts.pz.data() + begin,
+                fields, fields + stride, fields + 2 * stride,
+                fields + 3 * stride, fields + 4 * stride, fields + 5 * stride,
+                this->Qpar, dt);
+
+    for (std::size_t p = begin; p < begin + n; ++p)
+    {
+        this->_apply_bc(this->parts.x[p], this->parts.y[p], L_x, L_y, dx, dy);
+    }
+}
+
+/**
+ * @brief Currently applies periodic boundary conditions in x and y directions
+ *        for the species
+ *
+ * @param x1 The x position of the particle, updated in place
+ * @param y1 The y position of the particle, updated in place
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param dx Spatial grid step in x direction
+ * @param dy Spatial grid step in y direction
+ */
+inline void Species::_apply_bc(real_t& x1, real_t& y1,
+                               const double L_x, const double L_y,
+                               const double dx, const double dy) const
+{
     // Periodic x boundaries
     while (x1 < -dx / 2.0)
     {
         x1 += L_x;
-        pos.set_x(x1);
     }
     while (x1 >= (L_x - (dx / 2.0)))
     {
         x1 -= L_x;
-        pos.set_x(x1);
     }
 
     // Periodic y boundaries
     while (y1 < -dy / 2.0)
     {
         y1 += L_y;
-        pos.set_y(y1);
     }
     while (y1 >= (L_y - (dy / 2.0)))
     {
         y1 -= L_y;
-        pos.set_y(y1);
     }
 }
 //-----------------------------------------
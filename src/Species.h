@@ -4,17 +4,78 @@
 #include <iostream>
 #include <vector>
 #include <functional>
+#include <algorithm>
 
 #include "GridObject.h"
 #include "DataStorage_1D.h"
 #include "Particle.h"
+#include "ParticleArray.h"
+#include "Push.h"
+#include "Shape.h"
 #include "Field.h"
+#include "GridDims.h"
 #include "ThreeVec.h"
+#include "Threads.h"
 
 class Species
 {
     private:
-        std::vector<Particle> parts;
+        ParticleArray parts;
+
+        // Private density grids used by the threaded deposit
+        std::vector<GridObject> deposit_scratch;
+
+        // Particle sorting: cell_offsets[c] is the index of the first
+        // particle in cell c after the last sort
+        std::vector<std::size_t> cell_offsets;
+        std::vector<std::size_t> sort_keys, sort_order;
+        std::vector<std::size_t> sort_movers, sort_merged;
+
+        // Tiling: the grid is split into tiles of about tile_nx by tile_ny
+        // cells, with the last tile in each direction taking the remainder.
+        // Sorting orders the cells tile by tile, so the particles of a tile
+        // are contiguous. Each tile works on a small local window of the grid
+        // that extends tile_guard cells past the tile on every side, enough
+        // for the widest shape function.
+        static const std::size_t tile_guard = Shape::guard_cells;
+        std::size_t sorted_tile_nx, sorted_tile_ny;  // tile size at last sort
+        std::vector<std::vector<real_t> > tile_windows;  // one per thread
+        std::vector<std::vector<std::size_t> > tile_strays;  // one per tile
+        std::vector<std::size_t> tile_batch;
+
+        // Number of particles whose fields are gathered before each call of
+        // the vectorized push
+        static const std::size_t push_chunk = 64;
+
+        // The deposit and gather kernels of every shape order, compiled for
+        // the grid dimensions Dims. GridDims::select picks the instantiation
+        // for the grid once per call.
+        struct Deposit_Kernel
+        {
+            typedef void (Species::*type)(GridObject&,
+                                          const GridDims::Layout&,
+                                          const std::size_t,
+                                          const std::size_t,
+                                          const double, const double,
+                                          const double, const double) const;
+
+            template <typename Dims>
+            static type get(const int order);
+        };
+
+        struct Gather_Kernel
+        {
+            typedef void (Species::*type)(const Field&,
+                                          const GridDims::Layout&,
+                                          const std::size_t,
+                                          const std::size_t,
+                                          const double, const double,
+                                          const double, const double,
+                                          real_t*, real_t*, real_t*) const;
+
+            template <typename Dims>
+            static type get(const int order);
+        };
 
 
         /**********************************************************
@@ -22,9 +83,115 @@ class Species
         ***********************************************************/
         void init_species(std::function<void(Species &, std::size_t)> init_fcn);
 
-        void _apply_bc(ThreeVec& pos,
+        void _grid_coords(real_t x_pos, real_t y_pos,
+                          const double dx, const double dy,
+                          const double L_x, const double L_y,
+                          real_t& fi, real_t& fj) const;
+        std::size_t _cell_index(double x_pos, double y_pos,
+                                const double dx, const double dy,
+                                const double L_x, const double L_y,
+                                const std::size_t Nx,
+                                const std::size_t Ny) const;
+
+        std::size_t _tile_size(const std::size_t N, const bool x_dir) const;
+        void _tile_extent(const std::size_t t, const std::size_t tile_n,
+                          const std::size_t N,
+                          std::size_t& start, std::size_t& width) const;
+        bool _tiles_binned(const std::size_t Nx, const std::size_t Ny) const;
+        void _tile_particles(const std::size_t tx, const std::size_t ty,
+                             const std::size_t Nx, const std::size_t Ny,
+                             std::size_t& begin, std::size_t& end) const;
+        void _bin_tiles(const double dx, const double dy,
+                        const double L_x, const double L_y,
+                        const std::size_t Nx, const std::size_t Ny);
+        int _deposit_tiled(const double dx, const double dy,
+                           const double L_x, const double L_y,
+                           const std::size_t Nx, const std::size_t Ny);
+        void _load_window(const Field& f, const GridDims::Layout& layout,
+                          const std::size_t sx, const std::size_t wx,
+                          const std::size_t sy, const std::size_t wy,
+                          real_t* win) const;
+        int _gather_push_tiled(const Field& e_field, const Field& b_field,
+                               const bool use_b_field,
+                               const double L_x, const double L_y,
+                               const double dt,
+                               const double dx, const double dy);
+
+        void _deposit_range(GridObject& grid,
+                            const std::size_t begin, const std::size_t end,
+                            const double dx, const double dy,
+                            const double L_x, const double L_y) const;
+
+        GridDims::Layout _deposit_layout(const GridObject& grid) const;
+        GridDims::Layout _gather_layout(const Field& f) const;
+        template <typename Kernel>
+        typename Kernel::type _select_kernel(const GridDims::Layout& layout) const;
+
+        // Shape function kernels, instantiated for every shape order, and
+        // those of the deposit and gather also for every fixed grid size
+        template <int Order, typename Dims>
+        void _deposit_shape(GridObject& grid, const GridDims::Layout& layout,
+                            const std::size_t begin, const std::size_t end,
+                            const double dx, const double dy,
+                            const double L_x, const double L_y) const;
+        template <int Order>
+        void _deposit_window(const std::size_t begin, const std::size_t end,
+                             const std::size_t sx, const std::size_t sy,
+                             const long win_x, const long win_y,
+                             const std::size_t Nx, const std::size_t Ny,
+                             const double dx, const double dy,
+                             const double L_x, const double L_y,
+                             real_t* win,
+                             std::vector<std::size_t>& strays) const;
+        template <int Order, typename Dims>
+        void _interpolate_field(const Field& f, const Dims& dims,
+                                double x_pos, double y_pos,
+                                const double dx, const double dy,
+                                const double L_x, const double L_y,
+                                real_t& loc_f1, real_t& loc_f2,
+                                real_t& loc_f3) const;
+        template <int Order, typename Dims>
+        void _interpolate_guarded(const Field& f, const Dims& dims,
+                                  const real_t* const* origins,
+                                  double x_pos, double y_pos,
+                                  const double dx, const double dy,
+                                  const double L_x, const double L_y,
+                                  real_t& loc_f1, real_t& loc_f2,
+                                  real_t& loc_f3) const;
+        template <int Order, typename Dims>
+        void _interpolate_nodes(const Field& f, const Dims& dims,
+                                const real_t* origin,
+                                double x_pos, double y_pos,
+                                const double dx, const double dy,
+                                const double L_x, const double L_y,
+                                real_t& loc_f1, real_t& loc_f2,
+                                real_t& loc_f3) const;
+        template <int Order, typename Dims>
+        void _gather_range(const Field& f, const GridDims::Layout& layout,
+                           const std::size_t begin, const std::size_t n,
+                           const double dx, const double dy,
+                           const double L_x, const double L_y,
+                           real_t* loc_f1, real_t* loc_f2,
+                           real_t* loc_f3) const;
+        template <int Order>
+        void _gather_window(const Field& f, const GridDims::Layout& layout,
+                            const real_t* win,
+                            const std::size_t begin, const std::size_t n,
+                            const std::size_t sx, const std::size_t sy,
+                            const long win_x, const long win_y,
+                            const double dx, const double dy,
+                            const double L_x, const double L_y,
+                            real_t* loc_f1, real_t* loc_f2,
+                            real_t* loc_f3) const;
+        void _push_chunk(const std::size_t begin, const std::size_t n,
+                         const real_t* fields,
+                         const double L_x, const double L_y,
+                         const double dt,
+                         const double dx, const double dy);
+
+        void _apply_bc(real_t& x1, real_t& y1,
                        const double L_x, const double L_y,
-                       const double dx, const double dy);
+                       const double dx, const double dy) const;
         //-----------------------------------------
 
     public:
@@ -34,6 +201,27 @@ class Species
 
 	      double Qpar;
 
+        // Parallel charge deposition and gather/push
+        std::size_t n_threads;         // 0 uses the OpenMP default
+        bool reproducible_deposit;     // bitwise identical for any n_threads
+        std::size_t n_deposit_blocks;  // particle blocks when reproducible
+
+        // Order of the particle shape function, from 0 (NGP) to 4 (quartic)
+        int shape_order;
+
+        // Tiled deposit and gather
+        bool tiled;
+        std::size_t tile_nx, tile_ny;  // tile size in cells
+
+        // Deposit into guard cells and fold them back once, and gather from
+        // fields whose guard cells have been exchanged, instead of wrapping
+        // every grid index around the periodic boundaries
+        bool guard_cells;
+
+        // Run the deposit and gather kernels compiled for the grid size, if
+        // it is one of PIC_FIXED_GRIDS
+        bool fixed_grids;
+
         // Diagnostics
         // double total_KE;
 
@@ -45,11 +233,21 @@ class Species
         Species(std::size_t Npar, std::size_t Nx, std::size_t Ny, double Qpar);
         Species(std::size_t Npar, std::size_t Nx, std::size_t Ny, double Qpar,
 			    std::function<void(Species &, std::size_t)> init_fcn);
+        Species(const Species& copy_obj) = default;
+        Species(Species&& move_obj) noexcept = default;
 
 	      ~Species();
 	      //-----------------------------------------
 
 
+        /**********************************************************
+        OPERATOR FUNCTIONS
+        ***********************************************************/
+        Species& operator=(const Species& to_copy) = default;
+        Species& operator=(Species&& to_move) noexcept = default;
+        //-----------------------------------------
+
+
         /**********************************************************
         CLASS METHODS
         ***********************************************************/
@@ -63,6 +261,7 @@ class Species
                            const double L_x, const double L_y,
                            const std::size_t Nx, const std::size_t Ny);
 
+#if PIC_FIELD_CACHE
         int map_field_to_part(const Field& f,
                               const Field_T::Field_Type field_to_map,
                               const double dx, const double dy,
@@ -72,16 +271,31 @@ class Species
         int push_particles(const double L_x, const double L_y,
                            const double dt,
                            const double dx, const double dy);
+#endif
+
+        int gather_push_particles(const Field& e_field, const Field& b_field,
+                                  const bool use_b_field,
+                                  const double L_x, const double L_y,
+                                  const double dt,
+                                  const double dx, const double dy);
 
         void apply_bc(const double L_x, const double L_y,
                       const double dx, const double dy);
 
+        void place_particles();
+
+        bool sort_particles(const double dx, const double dy,
+                            const double L_x, const double L_y,
+                            const std::size_t Nx, const std::size_t Ny);
+
         DataStorage_1D get_x_phasespace();
         DataStorage_1D get_y_phasespace();
         DataStorage_1D get_px_phasespace();
         DataStorage_1D get_py_phasespace();
+#if PIC_FIELD_CACHE
         std::vector<double> get_local_E(std::size_t i);
         std::vector<double> get_local_B(std::size_t i);
+#endif
 
         // Print Functions
         void print_pos() const;
@@ -89,10 +303,12 @@ class Species
         void print_mom() const;
         void print_mom_comp(std::size_t i) const;
         void print_weight() const;
+#if PIC_FIELD_CACHE
         void print_local_e_field() const;
         void print_local_e_field_comp(std::size_t i) const;
         void print_local_b_field() const;
         void print_local_b_field_comp(std::size_t i) const;
+#endif
         void print_density() const;
         //-----------------------------------------
 };
@@ -0,0 +1,53 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Small helpers around the OpenMP runtime so that the rest of the code
+ *        builds and runs serially when OpenMP is not available.
+ *
+ */
+namespace Threads
+{
+    /**
+     * @brief Turns a requested thread count into the number of threads to
+     *        actually use
+     *
+     * @param n_threads Requested number of threads, 0 for the OpenMP default
+     * @return int The number of threads to use
+     */
+    inline int resolve(const std::size_t n_threads)
+    {
+#ifdef _OPENMP
+        if (n_threads == 0)
+        {
+            return omp_get_max_threads();
+        }
+        return int(n_threads);
+#else
+        (void)n_threads;
+        return 1;
+#endif
+    }
+
+    /**
+     * @brief Get the index of the calling thread within its parallel region
+     *
+     * @return int The thread index, 0 outside of a parallel region
+     */
+    inline int thread_id()
+    {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+}
+
+#endif
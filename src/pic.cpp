@@ -56,5 +56,7 @@ int main()
 
     io.close_hdf5_files();
 
+    sim.print_timing();
+
     return 0;
 }
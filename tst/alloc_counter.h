@@ -0,0 +1,165 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete with versions that keep count
+// of the allocations, so that a test or benchmark can check that a piece of
+// code does not allocate, or does not hold more memory than it needs to.
+// Include this in exactly one file of a program.
+
+namespace AllocCounter
+{
+    // Every block starts with a header holding its size
+    const std::size_t header = 16;
+
+    struct Counters
+    {
+        std::atomic<std::size_t> n_allocs;    // allocations since reset
+        std::atomic<std::size_t> bytes;       // bytes allocated since reset
+        std::atomic<std::size_t> largest;     // largest allocation since reset
+        std::atomic<std::size_t> live_bytes;  // bytes currently allocated
+        std::atomic<std::size_t> peak_bytes;  // most bytes live since reset
+    };
+
+    inline Counters& counters()
+    {
+        static Counters c;
+        return c;
+    }
+
+    /**
+     * @brief Starts counting afresh from the memory currently allocated
+     *
+     */
+    inline void reset()
+    {
+        counters().n_allocs = 0;
+        counters().bytes = 0;
+        counters().largest = 0;
+        counters().peak_bytes = counters().live_bytes.load();
+    }
+
+    inline std::size_t n_allocs()
+    {
+        return counters().n_allocs;
+    }
+
+    inline std::size_t bytes()
+    {
+        return counters().bytes;
+    }
+
+    inline std::size_t largest()
+    {
+        return counters().largest;
+    }
+
+    inline std::size_t live_bytes()
+    {
+        return counters().live_bytes;
+    }
+
+    inline std::size_t peak_bytes()
+    {
+        return counters().peak_bytes;
+    }
+
+    inline void* allocate(std::size_t size)
+    {
+        char* block = static_cast<char*>(std::malloc(size + header));
+        if (!block)
+        {
+            return nullptr;
+        }
+        *reinterpret_cast<std::size_t*>(block) = size;
+
+        Counters& c = counters();
+        ++c.n_allocs;
+        c.bytes += size;
+
+        std::size_t big = c.largest;
+        while (size > big && !c.largest.compare_exchange_weak(big, size))
+        {
+        }
+
+        std::size_t live = (c.live_bytes += size);
+        std::size_t peak = c.peak_bytes;
+        while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live))
+        {
+        }
+
+        return block + header;
+    }
+
+    inline void release(void* ptr)
+    {
+        if (!ptr)
+        {
+            return;
+        }
+        char* block = static_cast<char*>(ptr) - header;
+        counters().live_bytes -= *reinterpret_cast<std::size_t*>(block);
+        std::free(block);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    void* ptr = AllocCounter::allocate(size);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return AllocCounter::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return AllocCounter::allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    AllocCounter::release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    AllocCounter::release(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    AllocCounter::release(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    AllocCounter::release(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    AllocCounter::release(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    AllocCounter::release(ptr);
+}
+
+#endif
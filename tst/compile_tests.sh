@@ -2,9 +2,22 @@
 
 # export DEPS='DataStorage_1D.o DataStorage_2D.o'
 
+# These tests map fields to the particles, so the objects must be built with
+# the per-particle field cache compiled in: make clean && make FIELD_CACHE=1
+# For objects built with SINGLE_PRECISION=1, run SINGLE_PRECISION=1 ./compile_tests.sh
+# and likewise FFTW=1 for objects built with FFTW=1
+export SINGLE_PRECISION=${SINGLE_PRECISION:-0}
+export FFTW=${FFTW:-0}
+export TFLAGS='-std=c++11 -g -fopenmp -DPIC_FIELD_CACHE=1'
+export TFLAGS=${TFLAGS}' -DPIC_SINGLE_PRECISION='${SINGLE_PRECISION}
+export TFLAGS=${TFLAGS}' -DPIC_FFTW='${FFTW}
+
 export TDEPS='../obj/DataStorage_1D.o ../obj/DataStorage_2D.o'
 export TDEPS=${TDEPS}' ../obj/DataStorage.o ../obj/FFT.o ../obj/Field.o'
+export TDEPS=${TDEPS}' ../obj/FFTWPlan.o ../obj/FFTBackend.o ../obj/GreensFunction.o'
+export TDEPS=${TDEPS}' ../obj/Multigrid.o'
 export TDEPS=${TDEPS}' ../obj/FileIO.o ../obj/GridObject.o ../obj/Particle.o'
+export TDEPS=${TDEPS}' ../obj/ParticleArray.o ../obj/Push.o'
 export TDEPS=${TDEPS}' ../obj/Species.o ../obj/ThreeVec.o'
 # for filename in ../obj/*; do export DEPS=${DEPS}' '$filename; done
 
@@ -15,6 +28,17 @@ export H5_COMPILEFLAGS='-I'${H5_ROOT}'/include'
 export H5_LINKFLAGS='-L'${H5_ROOT}'/lib -lhdf5_cpp -lhdf5 -lz -lm '
 export H5_COMPILEFLAGS=${H5_COMPILEFLAGS}'-L'${SZIP_ROOT}'/lib -lsz'
 
+if [ ${FFTW} = 1 ]; then
+    export FFTW_ROOT=$(brew --prefix fftw)
+    if [ ${SINGLE_PRECISION} = 1 ]; then
+        export FFTW_LIBS='-lfftw3f_omp -lfftw3f'
+    else
+        export FFTW_LIBS='-lfftw3_omp -lfftw3'
+    fi
+    export H5_COMPILEFLAGS=${H5_COMPILEFLAGS}' -I'${FFTW_ROOT}'/include'
+    export H5_LINKFLAGS=${H5_LINKFLAGS}' -L'${FFTW_ROOT}'/lib '${FFTW_LIBS}
+fi
+
 export INCLUDE=${H5_COMPILEFLAGS}
 export LDLIBS=${H5_LINKFLAGS}
 
@@ -22,6 +46,36 @@ echo $TDEPS
 echo $INCLUDE
 echo $LDLIBS
 
-g++ -std=c++11 -g test_field_2.cpp -o bin/test_field_2.exe $TDEPS $LDLIBS
-g++ -std=c++11 -g test_field_to_particle.cpp -o bin/test_field_to_particle.exe $TDEPS $LDLIBS
-g++ -std=c++11 -g test_push.cpp -o bin/test_push.exe $TDEPS $LDLIBS
\ No newline at end of file
+g++ $TFLAGS test_field_2.cpp -o bin/test_field_2.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_field_to_particle.cpp -o bin/test_field_to_particle.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_push.cpp -o bin/test_push.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_gather_push.cpp -o bin/test_gather_push.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_deposit_threads.cpp -o bin/test_deposit_threads.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_sort.cpp -o bin/test_sort.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_tiles.cpp -o bin/test_tiles.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_push_simd.cpp -o bin/test_push_simd.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_shapes.cpp -o bin/test_shapes.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fft_r2c.cpp -o bin/test_fft_r2c.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fft_plan.cpp -o bin/test_fft_plan.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fft_threads.cpp -o bin/test_fft_threads.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fft_backends.cpp -o bin/test_fft_backends.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fft_sizes.cpp -o bin/test_fft_sizes.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_greens_function.cpp -o bin/test_greens_function.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fft_simd.cpp -o bin/test_fft_simd.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_multigrid.cpp -o bin/test_multigrid.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_guard_cells.cpp -o bin/test_guard_cells.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_field_layout.cpp -o bin/test_field_layout.exe $TDEPS $LDLIBS
+# The expressions are evaluated in the test itself, so it is optimized like the
+# objects for its timing to mean anything
+g++ $TFLAGS -O3 test_expressions.cpp -o bin/test_expressions.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_memory.cpp -o bin/test_memory.exe $TDEPS $LDLIBS
+g++ $TFLAGS test_fixed_grids.cpp -o bin/test_fixed_grids.exe $TDEPS $LDLIBS
+
+# These run the example problems, so they also link the simulation. See
+# test_precision.cpp for comparing a single precision build against double.
+g++ $TFLAGS -DPROBLEM='"../src/two_stream.h"' test_precision.cpp -o bin/test_precision_two_stream.exe $TDEPS ../obj/Simulation.o $LDLIBS
+g++ $TFLAGS -DPROBLEM='"../src/cold_wave.h"' test_precision.cpp -o bin/test_precision_cold_wave.exe $TDEPS ../obj/Simulation.o $LDLIBS
+g++ $TFLAGS test_moves.cpp -o bin/test_moves.exe $TDEPS ../obj/Simulation.o $LDLIBS
+g++ $TFLAGS test_walls.cpp -o bin/test_walls.exe $TDEPS ../obj/Simulation.o $LDLIBS
+g++ $TFLAGS -DPROBLEM='"../src/two_stream.h"' test_alloc_free.cpp -o bin/test_alloc_free_two_stream.exe $TDEPS ../obj/Simulation.o $LDLIBS
+g++ $TFLAGS -DPROBLEM='"../src/cold_wave.h"' test_alloc_free.cpp -o bin/test_alloc_free_cold_wave.exe $TDEPS ../obj/Simulation.o $LDLIBS
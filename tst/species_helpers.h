@@ -0,0 +1,112 @@
+#ifndef SPECIES_HELPERS_H
+#define SPECIES_HELPERS_H
+
+#include <math.h>    // for fabs, sin
+#include <stdlib.h>  // for rand, srand
+
+#include "../src/Species.h"
+
+// Set ups and comparisons shared by the tests that run the deposit and the
+// gather/push on random particles in a smooth field.
+
+/**
+ * @brief Adds Npar particles at random positions in the box, with random
+ *        momenta in x and y and weights cycling through 1 to n_weights
+ *
+ * @param spec Species to add the particles to
+ * @param Npar Number of particles to add
+ * @param L_x Physical length of system in x direction
+ * @param L_y Physical length of system in y direction
+ * @param seed Seed of rand, so that two species can get the same particles
+ * @param max_mom Largest x and y momentum, 0 for particles at rest
+ * @param n_weights Number of different weights
+ */
+inline void fill_species(Species& spec, std::size_t Npar,
+                         double L_x, double L_y, unsigned seed,
+                         double max_mom = 2.0, std::size_t n_weights = 5)
+{
+    srand(seed);
+    for (std::size_t i = 0; i < Npar; ++i)
+    {
+        double x_pos = L_x * rand() / double(RAND_MAX) * 0.999;
+        double y_pos = L_y * rand() / double(RAND_MAX) * 0.999;
+        double x_mom = 2.0 * max_mom * (rand() / double(RAND_MAX) - 0.5);
+        double y_mom = 2.0 * max_mom * (rand() / double(RAND_MAX) - 0.5);
+        spec.add_particle(x_pos, y_pos, 0, x_mom, y_mom, 0,
+                          1.0 + (i % n_weights));
+    }
+}
+
+/**
+ * @brief Sets every component of a field to a smooth function of the grid
+ *        point
+ *
+ * @param f Field to set
+ * @param Nx Number of grid spaces in x direction
+ * @param Ny Number of grid spaces in y direction
+ * @param phase Shifts the functions, to give two fields different values
+ */
+inline void fill_field(Field& f, std::size_t Nx, std::size_t Ny,
+                       double phase = 0.0)
+{
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            f.f1.set_comp(i, j, sin(0.3 * i + 0.1 * j + phase));
+            f.f2.set_comp(i, j, sin(0.2 * i - 0.4 * j + phase));
+            f.f3.set_comp(i, j, 0.1 * sin(0.5 * j + phase));
+        }
+    }
+}
+
+/**
+ * @brief Checks whether two values agree to within TOL relative to their
+ *        size
+ *
+ * @param a First value
+ * @param b Second value
+ * @param TOL Difference allowed relative to the values, 0 for equal
+ * @return true If the values agree
+ * @return false If they differ by more, or either is not a number
+ */
+inline bool close(double a, double b, double TOL)
+{
+    return fabs(a - b) <= TOL * (1.0 + fabs(a) + fabs(b));
+}
+
+/**
+ * @brief Checks whether two species hold the same particles in the same
+ *        order
+ *
+ * @param a First species
+ * @param b Second species
+ * @param TOL Difference allowed relative to the values, 0 for bitwise equal
+ * @return true If the positions and momenta in x and y agree
+ * @return false If the number of particles or any of them differ
+ */
+inline bool same_particles(Species& a, Species& b, double TOL = 0.0)
+{
+    DataStorage_1D ax = a.get_x_phasespace(), bx = b.get_x_phasespace();
+    DataStorage_1D ay = a.get_y_phasespace(), by = b.get_y_phasespace();
+    DataStorage_1D apx = a.get_px_phasespace(), bpx = b.get_px_phasespace();
+    DataStorage_1D apy = a.get_py_phasespace(), bpy = b.get_py_phasespace();
+
+    if (ax.get_size() != bx.get_size())
+    {
+        return false;
+    }
+
+    for (std::size_t p = 0; p < ax.get_size(); ++p)
+    {
+        if (!close(ax[p], bx[p], TOL) || !close(ay[p], by[p], TOL) ||
+            !close(apx[p], bpx[p], TOL) || !close(apy[p], bpy[p], TOL))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "../src/Simulation.h"
+#include "alloc_counter.h"
+
+// Problem to run, e.g. -DPROBLEM='"../src/cold_wave.h"'
+#ifndef PROBLEM
+#define PROBLEM "../src/two_stream.h"
+#endif
+#include PROBLEM
+
+// testing that a step does not allocate once the simulation has warmed up:
+// the field solve, the FFTs and the particle passes all reuse their scratch.
+// Each mode runs a few steps to size its buffers and is then counted.
+
+const std::size_t n_warm_up = 5;
+const std::size_t n_counted = 20;
+
+bool check_steady_state(Simulation& sim, const char* mode)
+{
+    for (std::size_t step = 0; step < n_warm_up; ++step)
+    {
+        sim.iterate();
+    }
+
+    AllocCounter::reset();
+    for (std::size_t step = 0; step < n_counted; ++step)
+    {
+        sim.iterate();
+    }
+
+    std::cout << mode << ": " << AllocCounter::n_allocs() << " allocations, "
+              << AllocCounter::bytes() << " bytes in " << n_counted
+              << " steps" << std::endl;
+
+    return AllocCounter::n_allocs() == 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    {
+        Simulation sim(ndump, nspec, Nx, Ny, L_x, L_y, dt, tmax);
+        test_passed &= check_steady_state(sim, "default");
+    }
+
+    {
+        Simulation sim(ndump, nspec, Nx, Ny, L_x, L_y, dt, tmax);
+        sim.sort_interval = 4;
+        test_passed &= check_steady_state(sim, "sorted");
+    }
+
+    {
+        Simulation sim(ndump, nspec, Nx, Ny, L_x, L_y, dt, tmax);
+        sim.set_reproducible_deposit(true);
+        test_passed &= check_steady_state(sim, "reproducible deposit");
+    }
+
+    {
+        Simulation sim(ndump, nspec, Nx, Ny, L_x, L_y, dt, tmax);
+        sim.set_tiling(true, 8, 8);
+        test_passed &= check_steady_state(sim, "tiled");
+    }
+
+    if (test_passed)
+    {
+        std::cout << "alloc_free is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "alloc_free failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,86 @@
+#include "species_helpers.h"
+
+// testing the threaded charge deposition of Species against the serial one
+
+const unsigned SEED = 1234;  // of the particles
+
+// The densities are of order 1e4, so single precision sums only agree to a
+// few digits after the decimal point
+const double TOL = PIC_SINGLE_PRECISION ? 1e-1 : 1e-10;
+
+int main(int argc, char **argv)
+{
+    std::size_t Nx = 32, Ny = 16;
+    double L_x = 2.0, L_y = 1.0;
+    double dx = L_x / Nx, dy = L_y / Ny;
+    std::size_t Npar = 20000;
+
+    bool test_passed = true;
+
+    // Serial reference
+    Species serial(Npar, Nx, Ny, 1.0);
+    fill_species(serial, Npar, L_x, L_y, SEED, 0.0, 7);
+    serial.n_threads = 1;
+    serial.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+
+    // Reproducible reference with a single thread
+    Species repro_ref(Npar, Nx, Ny, 1.0);
+    fill_species(repro_ref, Npar, L_x, L_y, SEED, 0.0, 7);
+    repro_ref.n_threads = 1;
+    repro_ref.reproducible_deposit = true;
+    repro_ref.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+
+    for (std::size_t nt = 1; nt <= 5; ++nt)
+    {
+        Species threaded(Npar, Nx, Ny, 1.0);
+        fill_species(threaded, Npar, L_x, L_y, SEED, 0.0, 7);
+        threaded.n_threads = nt;
+        threaded.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+
+        if (!threaded.density_arr.equals(serial.density_arr, TOL))
+        {
+            std::cout << "threaded deposit differs from serial with "
+                      << nt << " threads" << std::endl;
+            test_passed = false;
+        }
+
+        Species repro(Npar, Nx, Ny, 1.0);
+        fill_species(repro, Npar, L_x, L_y, SEED, 0.0, 7);
+        repro.n_threads = nt;
+        repro.reproducible_deposit = true;
+        repro.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+
+        // Has to match bit for bit
+        for (std::size_t xi = 0; xi < Nx; ++xi)
+        {
+            for (std::size_t yj = 0; yj < Ny; ++yj)
+            {
+                if (repro.density_arr.get_comp(xi, yj) !=
+                    repro_ref.density_arr.get_comp(xi, yj))
+                {
+                    std::cout << "reproducible deposit is not bitwise "
+                              << "identical with " << nt << " threads at "
+                              << xi << ", " << yj << std::endl;
+                    test_passed = false;
+                }
+            }
+        }
+    }
+
+    if (!repro_ref.density_arr.equals(serial.density_arr, TOL))
+    {
+        std::cout << "reproducible deposit differs from serial" << std::endl;
+        test_passed = false;
+    }
+
+    if (test_passed)
+    {
+        std::cout << "deposit_threads is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "deposit_threads failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,283 @@
+#include "../src/GridObject.h"
+#include "../src/DataStorage_1D.h"
+#include <chrono>
+#include <stdlib.h>  // for rand, srand
+#include <stdexcept>
+
+// testing the lazily evaluated grid arithmetic against element-by-element
+// loops, for DataStorage_2D, DataStorage_1D and GridObject, that assigning
+// reuses the storage, that grids of different shapes cannot be combined, and
+// timing one fused pass against the by-value operators it replaced
+
+void fill_2d(DataStorage_2D& d)
+{
+    for (std::size_t i = 0; i < d.get_size(); ++i)
+    {
+        d[i] = rand() / double(RAND_MAX) + 0.5;
+    }
+}
+
+bool check_2d()
+{
+    const std::size_t Nx = 13, Ny = 7;
+    DataStorage_2D a(Nx, Ny), b(Nx, Ny), c(Nx, Ny);
+    fill_2d(a);
+    fill_2d(b);
+    fill_2d(c);
+
+    bool passed = true;
+
+    // Construction and assignment from an expression
+    DataStorage_2D d = a + b * c - 2.0;
+    DataStorage_2D e(Nx, Ny);
+    const real_t* e_data = e.get_data();
+    e = (a - b) / c * 3.0;
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            passed &= (d(i, j) == real_t(a(i, j) + b(i, j) * c(i, j) - 2.0));
+            passed &= (e(i, j) ==
+                       real_t((a(i, j) - b(i, j)) / c(i, j) * 3.0));
+        }
+    }
+    passed &= (e.get_data() == e_data);
+
+    // Compound assignment with expressions, and an expression of the grid
+    // being assigned to
+    DataStorage_2D f(a), g(a);
+    f += b * c;
+    f -= c / 4.0;
+    f *= b + 1.0;
+    f /= c + a;
+    f = f * 0.5 + f;
+    for (std::size_t i = 0; i < g.get_size(); ++i)
+    {
+        g[i] += b[i] * c[i];
+        g[i] -= c[i] / 4.0;
+        g[i] *= b[i] + 1.0;
+        g[i] /= c[i] + a[i];
+        g[i] = g[i] * 0.5 + g[i];
+    }
+    passed &= f.equals(g, 1e-300);
+
+    // Assigning a different shape resizes
+    DataStorage_2D h;
+    h = a * c;
+    passed &= (h.get_Nx() == Nx && h.get_Ny() == Ny);
+
+    if (!passed)
+    {
+        std::cout << "DataStorage_2D expressions differ from the loops"
+                  << std::endl;
+    }
+
+    return passed;
+}
+
+bool check_1d()
+{
+    const std::size_t Nx = 37;
+    DataStorage_1D a(Nx), b(Nx);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        a(i) = rand() / double(RAND_MAX);
+        b(i) = rand() / double(RAND_MAX) + 1.0;
+    }
+
+    DataStorage_1D c = a / b + a * b;
+    c -= a - 1.0;
+
+    bool passed = (c.get_Nx() == Nx);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        real_t ref = a(i) / b(i) + a(i) * b(i);
+        ref -= a(i) - 1.0;
+        passed &= (c(i) == ref);
+    }
+
+    if (!passed)
+    {
+        std::cout << "DataStorage_1D expressions differ from the loops"
+                  << std::endl;
+    }
+
+    return passed;
+}
+
+bool check_grid()
+{
+    const std::size_t Nx = 9, Ny = 11;
+    GridObject a(Nx, Ny), b(Nx, Ny), c(Nx, Ny, 2.0);
+    fill_2d(a.gridded_data);
+    fill_2d(b.gridded_data);
+
+    GridObject d = a + b;
+    d += a * c;
+    d -= b / c;
+    GridObject e(Nx, Ny);
+    e = d * 2.0 - a;
+
+    bool passed = (d.Nx == int(Nx) && d.Ny == int(Ny));
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            real_t ref = a.get_comp(i, j) + b.get_comp(i, j);
+            ref += a.get_comp(i, j) * c.get_comp(i, j);
+            ref -= b.get_comp(i, j) / c.get_comp(i, j);
+            passed &= (d.get_comp(i, j) == ref);
+            passed &= (e.get_comp(i, j) == real_t(ref * 2.0 - a.get_comp(i, j)));
+        }
+    }
+
+    if (!passed)
+    {
+        std::cout << "GridObject expressions differ from the loops"
+                  << std::endl;
+    }
+
+    return passed;
+}
+
+// Combining or assigning into grids of different shapes throws
+bool check_shapes()
+{
+    DataStorage_2D a(4, 6), b(6, 4), c(4, 6);
+    GridObject g(4, 6), h(4, 5);
+
+    int n_threw = 0;
+    try
+    {
+        c = a + b;
+    }
+    catch (const std::runtime_error&)
+    {
+        ++n_threw;
+    }
+    try
+    {
+        b += a * c;
+    }
+    catch (const std::runtime_error&)
+    {
+        ++n_threw;
+    }
+    try
+    {
+        g -= h * 2.0;
+    }
+    catch (const std::runtime_error&)
+    {
+        ++n_threw;
+    }
+
+    if (n_threw != 3)
+    {
+        std::cout << "grids of different shapes were combined" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// The operators before expressions: each takes its left operand by value,
+// so every operator copies a grid and then loops over it once more
+DataStorage_2D by_value_add(DataStorage_2D d1, const DataStorage_2D& d2)
+{
+    for (std::size_t i = 0; i < d1.get_size(); ++i)
+    {
+        d1[i] += d2[i];
+    }
+    return d1;
+}
+
+DataStorage_2D by_value_mul(DataStorage_2D d1, const DataStorage_2D& d2)
+{
+    for (std::size_t i = 0; i < d1.get_size(); ++i)
+    {
+        d1[i] *= d2[i];
+    }
+    return d1;
+}
+
+DataStorage_2D by_value_mul(DataStorage_2D d, const double val)
+{
+    for (std::size_t i = 0; i < d.get_size(); ++i)
+    {
+        d[i] *= val;
+    }
+    return d;
+}
+
+// Millions of grid points per second for a + b * c + a * 2.0 evaluated in
+// one pass, and with the by-value operators, which also had no move
+// assignment and so copied the result into d
+bool time_expressions()
+{
+    const std::size_t Nx = 1024, Ny = 1024;
+    const int reps = 20;
+
+    DataStorage_2D a(Nx, Ny), b(Nx, Ny), c(Nx, Ny), d(Nx, Ny), ref(Nx, Ny);
+    fill_2d(a);
+    fill_2d(b);
+    fill_2d(c);
+
+    std::chrono::steady_clock::time_point t0 =
+        std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r)
+    {
+        d = a + b * c + a * 2.0;
+    }
+    std::chrono::steady_clock::time_point t1 =
+        std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r)
+    {
+        const DataStorage_2D sum = by_value_add(by_value_add(a, by_value_mul(b, c)),
+                                                by_value_mul(a, 2.0));
+        ref = sum;
+    }
+    std::chrono::steady_clock::time_point t2 =
+        std::chrono::steady_clock::now();
+
+    const double fused = std::chrono::duration<double>(t1 - t0).count();
+    const double by_value = std::chrono::duration<double>(t2 - t1).count();
+    const double n = double(Nx * Ny) * reps / 1e6;
+    std::cout << "fused " << n / fused << ", by-value operators "
+              << n / by_value << " Mpoints/s (" << by_value / fused << "x)"
+              << std::endl;
+
+    if (!d.equals(ref, 1e-300))
+    {
+        std::cout << "fused expression differs from the by-value operators"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(1414);
+
+    test_passed &= check_2d();
+    test_passed &= check_1d();
+    test_passed &= check_grid();
+    test_passed &= check_shapes();
+
+    test_passed &= time_expressions();
+
+    if (test_passed)
+    {
+        std::cout << "expressions is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "expressions failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,169 @@
+#include "../src/Field.h"
+#include <cstdio>    // for remove
+#include <fstream>
+#include <stdlib.h>  // for rand, srand
+
+// testing that the FFT backends agree: the spectra of the built-in
+// transforms and of FFTW, their inverses and the field solved with each. In a
+// build without FFTW, checks that asking for it is refused.
+
+// Round-off allowed in the storage precision, relative to the largest value
+const double TOL = PIC_SINGLE_PRECISION ? 1e-5 : 1e-12;
+
+double random_value()
+{
+    return 2.0 * (rand() / double(RAND_MAX) - 0.5);
+}
+
+GridObject random_density(const std::size_t Nx, const std::size_t Ny)
+{
+    GridObject dens(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            dens.set_comp(i, j, random_value());
+        }
+    }
+
+    return dens;
+}
+
+#if PIC_FFTW
+bool check_transforms(const std::size_t Nx, const std::size_t Ny,
+                      const std::size_t n_threads)
+{
+    GridObject data = random_density(Nx, Ny);
+
+    FFT::Transform_2D builtin(Nx, Ny, FFT::FFT_Backend::Builtin);
+    FFT::Transform_2D fftw(Nx, Ny, FFT::FFT_Backend::FFTW);
+    builtin.n_threads = n_threads;
+    fftw.n_threads = n_threads;
+
+    GridObject b_re, b_im, f_re, f_im, b_back, f_back;
+    builtin.r2c(data, b_re, b_im);
+    if (fftw.r2c(data, f_re, f_im))
+    {
+        std::cout << Nx << "x" << Ny << " FFTW r2c failed" << std::endl;
+        return false;
+    }
+
+    const double scale = Nx * Ny;
+    if (!f_re.equals(b_re, TOL * scale) || !f_im.equals(b_im, TOL * scale))
+    {
+        std::cout << Nx << "x" << Ny << " spectra of the backends differ"
+                  << " with " << n_threads << " threads" << std::endl;
+        return false;
+    }
+
+    GridObject f_pair_a, f_pair_b;
+    fftw.c2r_pair(f_re, f_im, b_re, b_im, f_pair_a, f_pair_b);
+    if (!f_pair_a.equals(data, TOL) || !f_pair_b.equals(data, TOL))
+    {
+        std::cout << Nx << "x" << Ny << " FFTW c2r_pair does not invert r2c"
+                  << " with " << n_threads << " threads" << std::endl;
+        return false;
+    }
+
+    builtin.c2r(b_re, b_im, b_back);
+    fftw.c2r(f_re, f_im, f_back);
+    if (!f_back.equals(data, TOL) || !b_back.equals(data, TOL))
+    {
+        std::cout << Nx << "x" << Ny << " inverses of the backends differ"
+                  << " with " << n_threads << " threads" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool check_solve(const std::size_t Nx, const std::size_t Ny)
+{
+    const double dx = 1.0 / Nx, dy = 0.5 / Ny;
+    GridObject dens = random_density(Nx, Ny);
+
+    Field builtin(Nx, Ny, dx, dy);
+    builtin.set_fft_backend(FFT::FFT_Backend::Builtin);
+    builtin.solve_field(dens, dx, dy);
+
+    Field fftw(Nx, Ny, dx, dy);
+    fftw.set_fft_backend(FFT::FFT_Backend::FFTW);
+    fftw.solve_field(dens, dx, dy);
+
+    if (!fftw.f1.equals(builtin.f1, TOL) || !fftw.f2.equals(builtin.f2, TOL) ||
+        fabs(fftw.total_U - builtin.total_U) > TOL * fabs(builtin.total_U))
+    {
+        std::cout << Nx << "x" << Ny << " field solves of the backends differ"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(86420);
+
+#if PIC_FFTW
+    const char wisdom[] = "test_fft_backends.wisdom";
+    std::remove(wisdom);
+    FFT::set_fftw_wisdom_file(wisdom);
+#endif
+
+    // Fields use the backend picked by the build
+    Field field(8, 8, 1.0, 1.0);
+    if (field.get_fft_backend() != FFT::default_backend)
+    {
+        std::cout << "field does not use the default backend" << std::endl;
+        test_passed = false;
+    }
+
+#if PIC_FFTW
+    test_passed &= check_transforms(2, 2, 1);
+    test_passed &= check_transforms(16, 64, 1);
+    test_passed &= check_transforms(128, 32, 1);
+    test_passed &= check_transforms(128, 32, 3);
+    test_passed &= check_solve(64, 32);
+    test_passed &= check_solve(256, 256);
+
+    // The plans are remembered for the next run
+    if (!std::ifstream(wisdom).good())
+    {
+        std::cout << "FFTW wisdom was not saved" << std::endl;
+        test_passed = false;
+    }
+    std::remove(wisdom);
+#else
+    bool refused = false;
+    try
+    {
+        field.set_fft_backend(FFT::FFT_Backend::FFTW);
+    }
+    catch (const std::runtime_error&)
+    {
+        refused = true;
+    }
+    if (!refused || FFT::has_backend(FFT::FFT_Backend::FFTW))
+    {
+        std::cout << "FFTW was accepted without being built" << std::endl;
+        test_passed = false;
+    }
+    std::cout << "FFTW is not built in, build with FFTW=1 to compare it"
+              << std::endl;
+#endif
+
+    if (test_passed)
+    {
+        std::cout << "fft_backends is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fft_backends failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,219 @@
+#include "../src/FFT.h"
+#include "alloc_counter.h"
+#include <math.h>    // for fabs, cos, sin
+#include <stdlib.h>  // for rand, srand
+
+// testing FFT::Plan against a direct evaluation of the discrete Fourier
+// transform, for powers of 2, mixed radices and the Bluestein lengths, that
+// lines transformed side by side match lines transformed one by one, and
+// that executing plans does not allocate
+
+// Largest error allowed relative to the largest spectral value, per stage of
+// butterflies, in the storage precision
+const double TOL = PIC_SINGLE_PRECISION ? 1e-7 : 2e-16;
+
+double random_value()
+{
+    return 2.0 * (rand() / double(RAND_MAX) - 0.5);
+}
+
+// Whether N has a prime factor above 7, so that it is done by Bluestein
+bool has_large_prime(std::size_t N)
+{
+    const std::size_t radices[4] = {2, 3, 5, 7};
+    for (std::size_t r = 0; r < 4; ++r)
+    {
+        while (N % radices[r] == 0)
+        {
+            N /= radices[r];
+        }
+    }
+
+    return N > 1;
+}
+
+bool check_against_dft(const std::size_t N, const FFT::FFT_Dir dir)
+{
+    std::vector<real_t> re(N), im(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        re[i] = random_value();
+        im[i] = random_value();
+    }
+
+    // X(k) = sum_n x(n) exp(dir 2 pi i n k / N), and 1/N for the inverse
+    std::vector<long double> dft_re(N, 0.0), dft_im(N, 0.0);
+    const long double pi = 3.141592653589793238462643383279502884L;
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        for (std::size_t n = 0; n < N; ++n)
+        {
+            const long double theta = dir * 2.0L * pi * ((n * k) % N) / N;
+            const long double c = cosl(theta), s = sinl(theta);
+            dft_re[k] += re[n] * c - im[n] * s;
+            dft_im[k] += re[n] * s + im[n] * c;
+        }
+        if (dir == FFT::FFT_Dir::iFFT)
+        {
+            dft_re[k] /= N;
+            dft_im[k] /= N;
+        }
+    }
+
+    const FFT::Plan plan(N, dir);
+    plan.execute(re, im);
+
+    long double max_val = 0.0, max_err = 0.0;
+    for (std::size_t k = 0; k < N; ++k)
+    {
+        max_val = std::max(max_val, fabsl(dft_re[k]) + fabsl(dft_im[k]));
+        max_err = std::max(max_err, fabsl(re[k] - dft_re[k]) +
+                                    fabsl(im[k] - dft_im[k]));
+    }
+
+    // Bluestein lengths go through two transforms of up to 4N
+    const double stages = log2(double(N)) + 1.0 + (has_large_prime(N) ? 6 : 0);
+    if (max_err > TOL * stages * max_val)
+    {
+        std::cout << "length " << N << (dir == FFT::FFT_Dir::FFT ? " FFT" :
+                                        " iFFT")
+                  << " error " << double(max_err / max_val) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool check_lanes(const std::size_t N, const FFT::FFT_Dir dir,
+                 const std::size_t lanes, const std::size_t stride)
+{
+    std::vector<real_t> re(N * stride), im(N * stride);
+    for (std::size_t i = 0; i < N * stride; ++i)
+    {
+        re[i] = random_value();
+        im[i] = random_value();
+    }
+    const std::vector<real_t> re_0 = re, im_0 = im;
+
+    const FFT::Plan plan(N, dir);
+    plan.execute_lanes(re.data(), im.data(), lanes, stride);
+
+    bool passed = true;
+    std::vector<real_t> line_re(N), line_im(N);
+    for (std::size_t l = 0; l < stride; ++l)
+    {
+        for (std::size_t n = 0; n < N; ++n)
+        {
+            line_re[n] = re_0[n * stride + l];
+            line_im[n] = im_0[n * stride + l];
+        }
+        // lines past the lanes are left alone
+        if (l < lanes)
+        {
+            plan.execute(line_re, line_im);
+        }
+
+        double max_val = 0.0, max_err = 0.0;
+        for (std::size_t n = 0; n < N; ++n)
+        {
+            max_val = std::max<double>(max_val,
+                                       fabs(line_re[n]) + fabs(line_im[n]));
+            max_err = std::max<double>(max_err,
+                                       fabs(re[n * stride + l] - line_re[n]) +
+                                       fabs(im[n * stride + l] - line_im[n]));
+        }
+        // the kernels may round differently, as vectors of another width
+        passed &= max_err <= TOL * log2(double(N)) * max_val;
+    }
+
+    if (!passed)
+    {
+        std::cout << "length " << N << " in " << lanes
+                  << " lanes does not match single lines" << std::endl;
+    }
+
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(11235);
+
+    for (std::size_t N = 1; N <= 4096; N *= 2)
+    {
+        test_passed &= check_against_dft(N, FFT::FFT_Dir::FFT);
+        test_passed &= check_against_dft(N, FFT::FFT_Dir::iFFT);
+    }
+
+    // Every length up to 128, then mixed radices with all of 2, 3, 4, 5 and
+    // 7 as factors, and primes and other lengths left to Bluestein
+    for (std::size_t N = 3; N <= 128; ++N)
+    {
+        test_passed &= check_against_dft(N, FFT::FFT_Dir::FFT);
+        test_passed &= check_against_dft(N, FFT::FFT_Dir::iFFT);
+    }
+    const std::size_t lengths[8] = {384, 420, 1000, 2401, 3000, 1009, 2 * 997,
+                                    4096 + 1};
+    for (std::size_t l = 0; l < 8; ++l)
+    {
+        test_passed &= check_against_dft(lengths[l], FFT::FFT_Dir::FFT);
+        test_passed &= check_against_dft(lengths[l], FFT::FFT_Dir::iFFT);
+    }
+
+    const std::size_t lane_lengths[5] = {2, 32, 512, 60, 61};
+    for (std::size_t l = 0; l < 5; ++l)
+    {
+        test_passed &= check_lanes(lane_lengths[l], FFT::FFT_Dir::FFT, 7, 9);
+        test_passed &= check_lanes(lane_lengths[l], FFT::FFT_Dir::iFFT, 16,
+                                   16);
+    }
+
+    // A plan only transforms its own length, and an empty plan nothing
+    std::vector<real_t> re(12), im(12);
+    if (!FFT::Plan(0, FFT::FFT_Dir::FFT).execute(re, im) ||
+        !FFT::Plan(8, FFT::FFT_Dir::FFT).execute(re, im))
+    {
+        std::cout << "plan accepted the wrong length" << std::endl;
+        test_passed = false;
+    }
+
+    // Once the plans and the spectrum exist, transforms do not allocate
+    const std::size_t Nx = 64, Ny = 128;
+    FFT::Plan plan(Nx, FFT::FFT_Dir::FFT);
+    FFT::RealPlan_2D plan_2d(Nx, Ny);
+    GridObject data(Nx, Ny, 1.0), spec_re, spec_im;
+    plan_2d.r2c(data, spec_re, spec_im);
+    std::vector<real_t> line_re(Nx), line_im(Nx);
+
+    // Also the other algorithms, once a line has been transformed
+    FFT::Plan plan_mixed(60, FFT::FFT_Dir::FFT);
+    FFT::Plan plan_bluestein(61, FFT::FFT_Dir::FFT);
+    std::vector<real_t> re_60(60), im_60(60), re_61(61), im_61(61);
+    plan_bluestein.execute(re_61, im_61);
+
+    AllocCounter::reset();
+    plan.execute(line_re, line_im);
+    plan_2d.r2c(data, spec_re, spec_im);
+    plan_2d.c2r(spec_re, spec_im, data);
+    plan_mixed.execute(re_60, im_60);
+    plan_bluestein.execute(re_61, im_61);
+    if (AllocCounter::n_allocs() != 0)
+    {
+        std::cout << "executing plans made " << AllocCounter::n_allocs()
+                  << " allocations" << std::endl;
+        test_passed = false;
+    }
+
+    if (test_passed)
+    {
+        std::cout << "fft_plan is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fft_plan failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,170 @@
+#include "../src/FFT.h"
+#include <math.h>    // for fabs
+#include <stdlib.h>  // for rand, srand
+
+// testing the real to complex FFTs against the complex ones: the half
+// spectrum matches the first half of the complex spectrum, and the inverse
+// gives back the real data, in 1D and in 2D
+
+// Round-off allowed in the storage precision, relative to the data
+const double TOL = PIC_SINGLE_PRECISION ? 1e-5 : 1e-12;
+
+double random_value()
+{
+    return 2.0 * (rand() / double(RAND_MAX) - 0.5);
+}
+
+bool check_1d(const std::size_t N)
+{
+    FFT::RealPlan plan(N);
+
+    std::vector<real_t> data(N), re(N), im(N, 0.0);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        data[i] = random_value();
+        re[i] = data[i];
+    }
+
+    FFT::FFT_1D(re, im, FFT::FFT_Dir::FFT);
+
+    std::vector<real_t> spec_re(N / 2 + 1), spec_im(N / 2 + 1), back(N);
+    plan.r2c(data.data(), spec_re.data(), spec_im.data());
+
+    double scale = N;
+    for (std::size_t k = 0; k <= N / 2; ++k)
+    {
+        if (fabs(spec_re[k] - re[k % N]) > TOL * scale ||
+            fabs(spec_im[k] - im[k % N]) > TOL * scale)
+        {
+            std::cout << "r2c of length " << N << " differs at mode " << k
+                      << std::endl;
+            return false;
+        }
+    }
+
+    plan.c2r(spec_re.data(), spec_im.data(), back.data());
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        if (fabs(back[i] - data[i]) > TOL)
+        {
+            std::cout << "c2r of length " << N << " does not invert r2c"
+                      << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool check_2d(const std::size_t Nx, const std::size_t Ny)
+{
+    FFT::RealPlan_2D plan(Nx, Ny);
+
+    GridObject data(Nx, Ny), re(Nx, Ny), im(Nx, Ny), back(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            data.set_comp(i, j, random_value());
+            re.set_comp(i, j, data.get_comp(i, j));
+        }
+    }
+
+    FFT::FFT_2D(re, im, FFT::FFT_Dir::FFT);
+
+    GridObject spec_re, spec_im;
+    plan.r2c(data, spec_re, spec_im);
+
+    // The spectrum comes out transposed
+    if (spec_re.get_Nx() != Ny / 2 + 1 || spec_re.get_Ny() != Nx)
+    {
+        std::cout << "2D r2c spectrum has the wrong size" << std::endl;
+        return false;
+    }
+
+    double scale = Nx * Ny;
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j <= Ny / 2; ++j)
+        {
+            if (fabs(spec_re.get_comp(j, i) - re.get_comp(i, j)) >
+                    TOL * scale ||
+                fabs(spec_im.get_comp(j, i) - im.get_comp(i, j)) >
+                    TOL * scale)
+            {
+                std::cout << Nx << "x" << Ny << " r2c differs at mode ("
+                          << i << ", " << j << ")" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // A second grid, to be rebuilt together with the first
+    GridObject data_b(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            data_b.set_comp(i, j, random_value());
+        }
+    }
+    GridObject spec_b_re, spec_b_im, back_a, back_b;
+    plan.r2c(data_b, spec_b_re, spec_b_im);
+    plan.c2r_pair(spec_re, spec_im, spec_b_re, spec_b_im, back_a, back_b);
+    if (!back_a.equals(data, TOL) || !back_b.equals(data_b, TOL))
+    {
+        std::cout << Nx << "x" << Ny << " c2r_pair does not invert r2c"
+                  << std::endl;
+        return false;
+    }
+
+    plan.c2r(spec_re, spec_im, back);
+    if (!back.equals(data, TOL))
+    {
+        std::cout << Nx << "x" << Ny << " c2r does not invert r2c"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(13579);
+
+    for (std::size_t N = 2; N <= 1024; N *= 2)
+    {
+        test_passed &= check_1d(N);
+    }
+
+    // Lengths that are not powers of 2, odd ones being transformed whole
+    for (std::size_t N = 1; N <= 40; ++N)
+    {
+        test_passed &= check_1d(N);
+    }
+    test_passed &= check_1d(384);
+    test_passed &= check_1d(375);
+    test_passed &= check_1d(2 * 101);
+
+    test_passed &= check_2d(2, 2);
+    test_passed &= check_2d(16, 8);
+    test_passed &= check_2d(8, 32);
+    test_passed &= check_2d(64, 64);
+    test_passed &= check_2d(12, 45);
+    test_passed &= check_2d(49, 30);
+    test_passed &= check_2d(37, 34);
+
+    if (test_passed)
+    {
+        std::cout << "fft_r2c is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fft_r2c failed its test!\n";
+    }
+
+    return !test_passed;
+}
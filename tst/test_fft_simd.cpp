@@ -0,0 +1,233 @@
+#include "../src/FFT.h"
+#include <chrono>
+#include <math.h>    // for fabs, cos, sin, log2
+#include <stdlib.h>  // for rand, srand
+#include <vector>
+
+// testing the radix-4 power of 2 transforms, one line at a time and in
+// vector lanes, against the radix-2 transform they replaced, and timing all
+// three for lengths 64 to 8192 on one core
+
+const double TOL = PIC_SINGLE_PRECISION ? 1e-6 : 1e-14;
+
+// Number of lines transformed side by side
+const std::size_t LANES = 16;
+
+// The radix-2 transform the radix-4 butterflies replaced
+class Radix2
+{
+    private:
+        std::size_t N;
+        std::vector<std::size_t> swaps;
+        std::vector<real_t> w_re, w_im;
+
+    public:
+        Radix2(const std::size_t N)
+        {
+            this->N = N;
+
+            std::size_t j = 0;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                if (i < j)
+                {
+                    this->swaps.push_back(i);
+                    this->swaps.push_back(j);
+                }
+
+                std::size_t m = N >> 1;
+                while (m >= 1 && (j & m))
+                {
+                    j ^= m;
+                    m >>= 1;
+                }
+                j |= m;
+            }
+
+            this->w_re.resize(N);
+            this->w_im.resize(N);
+            for (std::size_t h = 1; h < N; h <<= 1)
+            {
+                for (std::size_t k = 0; k < h; ++k)
+                {
+                    const double theta = M_PI * double(k) / double(h);
+                    this->w_re[h + k] = cos(theta);
+                    this->w_im[h + k] = sin(theta);
+                }
+            }
+        }
+
+        void execute(real_t* re, real_t* im) const
+        {
+            for (std::size_t s = 0; s < this->swaps.size(); s += 2)
+            {
+                std::swap(re[this->swaps[s]], re[this->swaps[s + 1]]);
+                std::swap(im[this->swaps[s]], im[this->swaps[s + 1]]);
+            }
+
+            for (std::size_t h = 1; h < this->N; h <<= 1)
+            {
+                const real_t* wr = &this->w_re[h];
+                const real_t* wi = &this->w_im[h];
+
+                for (std::size_t i = 0; i < this->N; i += 2 * h)
+                {
+                    real_t* a_re = re + i;
+                    real_t* a_im = im + i;
+                    real_t* b_re = re + i + h;
+                    real_t* b_im = im + i + h;
+
+                    for (std::size_t k = 0; k < h; ++k)
+                    {
+                        const real_t tempr = wr[k] * b_re[k] - wi[k] * b_im[k];
+                        const real_t tempi = wr[k] * b_im[k] + wi[k] * b_re[k];
+                        b_re[k] = a_re[k] - tempr;
+                        b_im[k] = a_im[k] - tempi;
+                        a_re[k] += tempr;
+                        a_im[k] += tempi;
+                    }
+                }
+            }
+        }
+};
+
+double random_value()
+{
+    return 2.0 * (rand() / double(RAND_MAX) - 0.5);
+}
+
+// Largest difference of two sets of lines, relative to their largest value
+double max_diff(const std::vector<real_t>& re_a, const std::vector<real_t>& im_a,
+                const std::vector<real_t>& re_b, const std::vector<real_t>& im_b)
+{
+    double max_val = 0.0, max_err = 0.0;
+    for (std::size_t i = 0; i < re_a.size(); ++i)
+    {
+        max_val = std::max<double>(max_val, fabs(re_a[i]) + fabs(im_a[i]));
+        max_err = std::max<double>(max_err, fabs(re_a[i] - re_b[i]) +
+                                            fabs(im_a[i] - im_b[i]));
+    }
+
+    return max_err / max_val;
+}
+
+// Seconds per line of running f on LANES lines, repeated to take a while
+template <typename F>
+double time_per_line(const std::size_t N, F f)
+{
+    const int reps = std::max(1, int(2e7 / (N * LANES * log2(double(N)))));
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r)
+    {
+        f();
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(t1 - t0).count() / (reps * LANES);
+}
+
+bool check_length(const std::size_t N)
+{
+    // LANES lines one after the other, and the same lines side by side
+    std::vector<real_t> re(N * LANES), im(N * LANES);
+    std::vector<real_t> re_t(N * LANES), im_t(N * LANES);
+    for (std::size_t l = 0; l < LANES; ++l)
+    {
+        for (std::size_t n = 0; n < N; ++n)
+        {
+            re[l * N + n] = re_t[n * LANES + l] = random_value();
+            im[l * N + n] = im_t[n * LANES + l] = random_value();
+        }
+    }
+    std::vector<real_t> re_2 = re, im_2 = im, re_4 = re, im_4 = im;
+
+    const Radix2 radix_2(N);
+    const FFT::Plan plan(N, FFT::FFT_Dir::FFT);
+
+    // Errors after one transform, before timing repeats them
+    for (std::size_t l = 0; l < LANES; ++l)
+    {
+        radix_2.execute(&re_2[l * N], &im_2[l * N]);
+        plan.execute(&re_4[l * N], &im_4[l * N]);
+    }
+    const std::vector<real_t> re_t0 = re_t, im_t0 = im_t;
+    plan.execute_lanes(re_t.data(), im_t.data(), LANES, LANES);
+
+    std::vector<real_t> re_l(N * LANES), im_l(N * LANES);
+    for (std::size_t l = 0; l < LANES; ++l)
+    {
+        for (std::size_t n = 0; n < N; ++n)
+        {
+            re_l[l * N + n] = re_t[n * LANES + l];
+            im_l[l * N + n] = im_t[n * LANES + l];
+        }
+    }
+
+    const double tol = TOL * log2(double(N));
+    bool passed = max_diff(re_2, im_2, re_4, im_4) <= tol &&
+                  max_diff(re_2, im_2, re_l, im_l) <= tol;
+    if (!passed)
+    {
+        std::cout << "length " << N << " differs from radix-2" << std::endl;
+    }
+
+    // The transforms are unnormalized, so every repeat starts again from
+    // the same lines. The copy costs the same in all three.
+    const double t_2 = time_per_line(N, [&]()
+    {
+        re_2 = re;
+        im_2 = im;
+        for (std::size_t l = 0; l < LANES; ++l)
+        {
+            radix_2.execute(&re_2[l * N], &im_2[l * N]);
+        }
+    });
+    const double t_4 = time_per_line(N, [&]()
+    {
+        re_4 = re;
+        im_4 = im;
+        for (std::size_t l = 0; l < LANES; ++l)
+        {
+            plan.execute(&re_4[l * N], &im_4[l * N]);
+        }
+    });
+    const double t_l = time_per_line(N, [&]()
+    {
+        re_t = re_t0;
+        im_t = im_t0;
+        plan.execute_lanes(re_t.data(), im_t.data(), LANES, LANES);
+    });
+
+    // 5 N log2(N) is the usual count for a complex transform of length N
+    const double flops = 5.0 * N * log2(double(N));
+    std::cout << "N = " << N << ": radix-2 " << flops / t_2 / 1e9
+              << ", radix-4 " << flops / t_4 / 1e9
+              << ", radix-4 lanes " << flops / t_l / 1e9
+              << " GFLOP/s" << std::endl;
+
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(5813);
+
+    for (std::size_t N = 64; N <= 8192; N *= 2)
+    {
+        test_passed &= check_length(N);
+    }
+
+    if (test_passed)
+    {
+        std::cout << "fft_simd is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fft_simd failed its test!\n";
+    }
+
+    return !test_passed;
+}
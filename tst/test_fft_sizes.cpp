@@ -0,0 +1,119 @@
+#include "../src/Field.h"
+#include <math.h>    // for fabs, sin, cos
+
+// testing grids whose sizes are not powers of 2: the wavenumbers of odd and
+// even sizes, and the field solved for a density of one Fourier mode against
+// its exact discrete solution. The sizes cover the mixed radices and the
+// Bluestein lengths.
+
+// Round-off allowed in the storage precision, relative to the largest value
+const double TOL = PIC_SINGLE_PRECISION ? 1e-5 : 1e-11;
+
+bool check_k_vec(const std::size_t N, const double dx)
+{
+    std::vector<double> k = FFT::get_k_vec(N, dx);
+
+    // Mode i and mode i - N are the same on the grid; the one nearest zero is
+    // used, and -N/2 rather than N/2
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        const double m = (2 * i < N) ? double(i) : double(i) - double(N);
+        const double expected = 2.0 * M_PI * m / (N * dx);
+        if (fabs(k[i] - expected) > 1e-12 * M_PI / dx)
+        {
+            std::cout << "k of mode " << i << " of " << N << " is " << k[i]
+                      << " instead of " << expected << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool check_solve(const std::size_t Nx, const std::size_t Ny,
+                 const std::size_t m, const std::size_t n)
+{
+    const double dx = 0.1, dy = 0.07;
+
+    // density cos(theta), theta = 2 pi (m i / Nx + n j / Ny)
+    GridObject dens(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            const double theta = 2.0 * M_PI * (double(m * i) / Nx +
+                                               double(n * j) / Ny);
+            dens.set_comp(i, j, cos(theta));
+        }
+    }
+
+    Field field(Nx, Ny, dx, dy);
+    field.solve_field(dens, dx, dy);
+
+    // E = kappa / K^2 sin(theta), with the wavenumbers of the finite
+    // differences of the solver
+    const double kx = 2.0 * M_PI * m / (Nx * dx);
+    const double ky = 2.0 * M_PI * n / (Ny * dy);
+    const double Kx = kx * FFT::sinc(kx * dx / 2.0);
+    const double Ky = ky * FFT::sinc(ky * dy / 2.0);
+    const double K2 = Kx * Kx + Ky * Ky;
+    const double kappa_x = kx * FFT::sinc(kx * dx);
+    const double kappa_y = ky * FFT::sinc(ky * dy);
+
+    double max_err = 0.0, max_val = 0.0;
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            const double theta = 2.0 * M_PI * (double(m * i) / Nx +
+                                               double(n * j) / Ny);
+            const double ex = kappa_x / K2 * sin(theta);
+            const double ey = kappa_y / K2 * sin(theta);
+            max_val = std::max(max_val, fabs(ex) + fabs(ey));
+            max_err = std::max(max_err,
+                               fabs(field.f1.get_comp(i, j) - ex) +
+                               fabs(field.f2.get_comp(i, j) - ey));
+        }
+    }
+
+    // Both halves of cos(theta) have |rho_hat| = Nx Ny / 2
+    const double U = 0.25 * Nx * Ny * Nx * Ny / K2;
+
+    if (max_err > TOL * max_val || fabs(field.total_U - U) > TOL * U)
+    {
+        std::cout << Nx << "x" << Ny << " field of mode (" << m << ", " << n
+                  << ") is off by " << max_err / max_val << ", energy "
+                  << field.total_U << " instead of " << U << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    for (std::size_t N = 1; N <= 20; ++N)
+    {
+        test_passed &= check_k_vec(N, 0.3);
+    }
+
+    // mixed radices, odd sizes and sizes done by Bluestein
+    test_passed &= check_solve(48, 45, 5, 7);
+    test_passed &= check_solve(49, 30, 3, 1);
+    test_passed &= check_solve(37, 34, 2, 16);
+    test_passed &= check_solve(384, 375, 10, 0);
+    test_passed &= check_solve(101, 64, 0, 9);
+
+    if (test_passed)
+    {
+        std::cout << "fft_sizes is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fft_sizes failed its test!\n";
+    }
+
+    return !test_passed;
+}
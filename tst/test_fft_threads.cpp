@@ -0,0 +1,163 @@
+#include "../src/Field.h"
+#include <chrono>
+#include <stdlib.h>  // for rand, srand
+
+// testing the threaded 2D transforms and field solve against the serial
+// ones: every line is transformed by one thread, and the energy is summed in
+// a fixed order, so the results have to match bit for bit. Also reports the
+// speedup of the field solve on a 1024^2 grid.
+
+double random_value()
+{
+    return 2.0 * (rand() / double(RAND_MAX) - 0.5);
+}
+
+bool bitwise_equal(const GridObject& a, const GridObject& b)
+{
+    if (a.get_Nx() != b.get_Nx() || a.get_Ny() != b.get_Ny())
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.gridded_data.get_size(); ++i)
+    {
+        if (a.gridded_data[i] != b.gridded_data[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+GridObject random_density(const std::size_t Nx, const std::size_t Ny)
+{
+    GridObject dens(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            dens.set_comp(i, j, random_value());
+        }
+    }
+
+    return dens;
+}
+
+bool check_transforms(const std::size_t Nx, const std::size_t Ny)
+{
+    GridObject data = random_density(Nx, Ny);
+
+    FFT::RealPlan_2D serial(Nx, Ny);
+    serial.n_threads = 1;
+    GridObject ref_re, ref_im, ref_back;
+    serial.r2c(data, ref_re, ref_im);
+    GridObject spec_re = ref_re, spec_im = ref_im;
+    serial.c2r(spec_re, spec_im, ref_back);
+
+    bool passed = true;
+    for (std::size_t nt = 2; nt <= 16; ++nt)
+    {
+        FFT::RealPlan_2D threaded(Nx, Ny);
+        threaded.n_threads = nt;
+        GridObject re, im, back;
+        threaded.r2c(data, re, im);
+        bool same = bitwise_equal(re, ref_re) && bitwise_equal(im, ref_im);
+        threaded.c2r(re, im, back);
+        same &= bitwise_equal(back, ref_back);
+
+        if (!same)
+        {
+            std::cout << Nx << "x" << Ny << " transforms differ with " << nt
+                      << " threads" << std::endl;
+            passed = false;
+        }
+    }
+
+    return passed;
+}
+
+bool check_solve(const std::size_t Nx, const std::size_t Ny)
+{
+    const double dx = 1.0 / Nx, dy = 0.5 / Ny;
+    GridObject dens = random_density(Nx, Ny);
+
+    Field serial(Nx, Ny, dx, dy);
+    serial.n_threads = 1;
+    serial.solve_field(dens, dx, dy);
+
+    bool passed = true;
+    for (std::size_t nt = 2; nt <= 16; nt *= 2)
+    {
+        Field threaded(Nx, Ny, dx, dy);
+        threaded.n_threads = nt;
+        threaded.solve_field(dens, dx, dy);
+
+        if (!bitwise_equal(threaded.f1, serial.f1) ||
+            !bitwise_equal(threaded.f2, serial.f2) ||
+            threaded.total_U != serial.total_U)
+        {
+            std::cout << Nx << "x" << Ny << " field solve differs with " << nt
+                      << " threads" << std::endl;
+            passed = false;
+        }
+    }
+
+    return passed;
+}
+
+void report_speedup(const std::size_t N, const std::size_t n_solves)
+{
+    const double dx = 1.0 / N;
+    GridObject dens = random_density(N, N);
+    double serial_time = 0.0;
+
+    for (std::size_t nt = 1; nt <= 16; nt *= 2)
+    {
+        Field f(N, N, dx, dx);
+        f.n_threads = nt;
+        f.solve_field(dens, dx, dx);
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t s = 0; s < n_solves; ++s)
+        {
+            f.solve_field(dens, dx, dx);
+        }
+        std::chrono::duration<double> time =
+            std::chrono::steady_clock::now() - start;
+
+        const double per_solve = time.count() / n_solves;
+        if (nt == 1)
+        {
+            serial_time = per_solve;
+        }
+        std::cout << N << "^2 solve with " << nt << " threads: " << per_solve
+                  << " s, speedup " << serial_time / per_solve << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(97531);
+
+    test_passed &= check_transforms(2, 2);
+    test_passed &= check_transforms(16, 64);
+    test_passed &= check_transforms(128, 32);
+    test_passed &= check_solve(64, 32);
+    test_passed &= check_solve(256, 256);
+
+    report_speedup(1024, 5);
+
+    if (test_passed)
+    {
+        std::cout << "fft_threads is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fft_threads failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,187 @@
+#include "species_helpers.h"
+#include <chrono>
+#include <math.h>    // for sin
+
+// testing the gather from interleaved field nodes against the gather from
+// one grid per component, that the field solve and set_interleaved keep the
+// nodes up to date, and timing both layouts on unsorted and sorted particles
+
+const unsigned SEED = 2236;  // of the particles
+
+// Whether every node, guard cells included, holds the three components
+bool nodes_match(const Field& f)
+{
+    const long g = Shape::guard_cells;
+    const long Nx = f.f1.Nx, Ny = f.f1.Ny;
+
+    if (!f.has_guards())
+    {
+        return false;
+    }
+
+    for (long i = -g; i < Nx + g; ++i)
+    {
+        for (long j = -g; j < Ny + g; ++j)
+        {
+            const std::size_t gi = wrap_index(i, Nx), gj = wrap_index(j, Ny);
+            const real_t* n = f.node(i, j);
+            if (n[0] != f.f1.get_comp(gi, gj) ||
+                n[1] != f.f2.get_comp(gi, gj) ||
+                n[2] != f.f3.get_comp(gi, gj) || n[3] != 0.0)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Gather/push with both layouts over a few steps, for every shape order
+bool check_order(const int order)
+{
+    const std::size_t Nx = 40, Ny = 28;
+    const double L_x = 4.0, L_y = 2.0;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 20000;
+    const double dt = 0.2;
+
+    Field e_planar(Nx, Ny, dx, dy), b_planar(Nx, Ny, dx, dy);
+    fill_field(e_planar, Nx, Ny);
+    fill_field(b_planar, Nx, Ny);
+    e_planar.exchange_guards();
+    b_planar.exchange_guards();
+
+    Field e_nodes(e_planar), b_nodes(b_planar);
+    e_nodes.set_interleaved(true);
+    b_nodes.set_interleaved(true);
+
+    Species planar(Npar, Nx, Ny, 1.0), nodes(Npar, Nx, Ny, 1.0);
+    fill_species(planar, Npar, L_x, L_y, SEED);
+    fill_species(nodes, Npar, L_x, L_y, SEED);
+    planar.shape_order = nodes.shape_order = order;
+
+    bool passed = nodes_match(e_nodes) && nodes_match(b_nodes);
+    for (int step = 0; step < 3; ++step)
+    {
+        planar.gather_push_particles(e_planar, b_planar, true,
+                                     L_x, L_y, dt, dx, dy);
+        nodes.gather_push_particles(e_nodes, b_nodes, true,
+                                    L_x, L_y, dt, dx, dy);
+        passed &= same_particles(planar, nodes);
+    }
+
+    if (!passed)
+    {
+        std::cout << "shape order " << order << " differs between the "
+                  << "interleaved and planar fields" << std::endl;
+    }
+
+    return passed;
+}
+
+// The solve writes the planar grids, and refreshes the nodes from them
+bool check_solve()
+{
+    const std::size_t Nx = 32, Ny = 24;
+    const double dx = 0.1, dy = 0.1;
+
+    GridObject dens(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            dens.set_comp(i, j, sin(0.4 * i) + sin(0.7 * j));
+        }
+    }
+
+    Field field(Nx, Ny, dx, dy);
+    field.set_interleaved(true);
+    field.exchange_guards();
+    field.solve_field(dens, dx, dy);
+
+    if (!nodes_match(field))
+    {
+        std::cout << "field solve did not refresh the nodes" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Millions of particles per second gathered (E and B) and pushed on one
+// thread with each layout
+void time_layouts(const bool sorted)
+{
+    const std::size_t Nx = 256, Ny = 256;
+    const double L_x = 25.6, L_y = 25.6;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 1000000;
+    const int reps = 5;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    fill_field(b_field, Nx, Ny);
+    e_field.exchange_guards();
+    b_field.exchange_guards();
+
+    Species spec(Npar, Nx, Ny, 1.0);
+    fill_species(spec, Npar, L_x, L_y, SEED);
+    spec.n_threads = 1;
+    if (sorted)
+    {
+        spec.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+    }
+
+    std::cout << (sorted ? "sorted" : "unsorted") << ":";
+    for (int order = 1; order <= 3; order += 2)
+    {
+        spec.shape_order = order;
+        for (int interleave = 0; interleave <= 1; ++interleave)
+        {
+            e_field.set_interleaved(interleave);
+            b_field.set_interleaved(interleave);
+
+            std::chrono::steady_clock::time_point t0 =
+                std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r)
+            {
+                spec.gather_push_particles(e_field, b_field, true,
+                                           L_x, L_y, 0.0, dx, dy);
+            }
+            std::chrono::steady_clock::time_point t1 =
+                std::chrono::steady_clock::now();
+
+            std::cout << " order " << order
+                      << (interleave ? " interleaved " : " planar ")
+                      << double(Npar) * reps / 1e6 /
+                         std::chrono::duration<double>(t1 - t0).count();
+        }
+    }
+    std::cout << " Mpart/s" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    for (int order = 0; order <= Shape::max_order; ++order)
+    {
+        test_passed &= check_order(order);
+    }
+    test_passed &= check_solve();
+
+    time_layouts(false);
+    time_layouts(true);
+
+    if (test_passed)
+    {
+        std::cout << "field_layout is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "field_layout failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,215 @@
+#include "species_helpers.h"
+#include <chrono>
+
+// testing the deposit and gather kernels compiled for a fixed grid size
+// against those for sizes known at run time, which must agree bitwise for
+// every shape order and field layout, the masked periodic wraps, and which
+// layouts the fixed kernels accept. Also times both kernels. The grids of 64
+// and 512 points a side are in the default PIC_FIXED_GRIDS.
+
+const unsigned SEED = 2718;  // of the particles
+
+// Particles as in the other tests, and a few far outside of the box, whose
+// indices are wrapped
+void fill_species_outside(Species& spec, std::size_t Npar,
+                          double L_x, double L_y)
+{
+    fill_species(spec, Npar, L_x, L_y, SEED);
+    spec.add_particle(2.3 * L_x, 0.5 * L_y, 0, 0, 0, 0, 1.0);
+    spec.add_particle(0.5 * L_x, 3.7 * L_y, 0, 0, 0, 0, 1.0);
+}
+
+bool same_density(const Species& a, const Species& b)
+{
+    const DataStorage_2D& da = a.density_arr.gridded_data;
+    const DataStorage_2D& db = b.density_arr.gridded_data;
+
+    for (std::size_t c = 0; c < da.get_size(); ++c)
+    {
+        if (da[c] != db[c])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The masks wrap like wrap_index, and the fixed kernels only accept layouts
+// with their dimensions and strides
+bool check_dims()
+{
+    bool passed = true;
+
+    for (long k = -300; k <= 300; ++k)
+    {
+        passed &= (GridDims::wrap<64>(k) == wrap_index(k, 64));
+        passed &= (GridDims::wrap<48>(k) == wrap_index(k, 48));
+        passed &= (GridDims::wrap<1>(k) == 0);
+    }
+
+    typedef GridDims::Fixed<64, 64> Fixed_64;
+
+    Field f(64, 64, 0.1, 0.1);
+    f.exchange_guards();
+    GridDims::Layout layout(64, 64);
+    passed &= Fixed_64::matches(layout);
+    layout.guard_stride = f.f1.get_guard_stride();
+    passed &= Fixed_64::matches(layout);
+    f.set_interleaved(true);
+    layout.node_stride = f.get_node_stride();
+    passed &= Fixed_64::matches(layout);
+
+    GridObject wide(64, 64);
+    wide.exchange_guards(4 * Shape::guard_cells);
+    layout.guard_stride = wide.get_guard_stride();
+    passed &= !Fixed_64::matches(layout);
+    passed &= !Fixed_64::matches(GridDims::Layout(64, 32));
+    passed &= !Fixed_64::matches(GridDims::Layout(32, 64));
+
+    if (!passed)
+    {
+        std::cout << "fixed grid dimensions wrap or match wrongly"
+                  << std::endl;
+    }
+
+    return passed;
+}
+
+// Deposit and gather/push with the fixed and the run time kernels over a few
+// steps, with the indices wrapped (layout 0), through the guard cells (1)
+// and through the interleaved nodes (2)
+bool check_order(const int order, const int layout)
+{
+    const std::size_t Nx = 64, Ny = 64;
+    const double L_x = 3.2, L_y = 6.4;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 20000;
+    const double dt = 0.2;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    fill_field(b_field, Nx, Ny);
+    if (layout > 0)
+    {
+        e_field.exchange_guards();
+        b_field.exchange_guards();
+    }
+    e_field.set_interleaved(layout == 2);
+    b_field.set_interleaved(layout == 2);
+
+    Species fixed(Npar, Nx, Ny, 1.0), dynamic(Npar, Nx, Ny, 1.0);
+    fill_species_outside(fixed, Npar, L_x, L_y);
+    fill_species_outside(dynamic, Npar, L_x, L_y);
+    fixed.shape_order = dynamic.shape_order = order;
+    fixed.guard_cells = dynamic.guard_cells = (layout > 0);
+    dynamic.fixed_grids = false;
+
+    bool passed = true;
+    for (int step = 0; step < 3; ++step)
+    {
+        fixed.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+        dynamic.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+        passed &= same_density(fixed, dynamic);
+
+        fixed.gather_push_particles(e_field, b_field, true,
+                                    L_x, L_y, dt, dx, dy);
+        dynamic.gather_push_particles(e_field, b_field, true,
+                                      L_x, L_y, dt, dx, dy);
+        passed &= same_particles(fixed, dynamic);
+    }
+
+    if (!passed)
+    {
+        std::cout << "shape order " << order << " with layout " << layout
+                  << " differs on the fixed grid" << std::endl;
+    }
+
+    return passed;
+}
+
+// Millions of particles per second deposited, and gathered and pushed, on
+// one thread with the run time and the fixed kernels
+void time_order(const int order)
+{
+    const std::size_t Nx = 512, Ny = 512;
+    const double L_x = 51.2, L_y = 51.2;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 1000000;
+    const int reps = 5;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    e_field.exchange_guards();
+
+    Species spec(Npar, Nx, Ny, 1.0);
+    fill_species_outside(spec, Npar, L_x, L_y);
+    spec.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+    spec.shape_order = order;
+    spec.n_threads = 1;
+
+    std::cout << "shape order " << order << ":";
+    for (int guards = 0; guards <= 1; ++guards)
+    {
+        spec.guard_cells = guards;
+        std::cout << (guards ? " guard cells" : " wrapped");
+
+        for (int fixed = 0; fixed <= 1; ++fixed)
+        {
+            spec.fixed_grids = fixed;
+
+            std::chrono::steady_clock::time_point t0 =
+                std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r)
+            {
+                spec.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+            }
+            std::chrono::steady_clock::time_point t1 =
+                std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r)
+            {
+                spec.gather_push_particles(e_field, b_field, false,
+                                           L_x, L_y, 0.0, dx, dy);
+            }
+            std::chrono::steady_clock::time_point t2 =
+                std::chrono::steady_clock::now();
+
+            const double n = double(Npar) * reps / 1e6;
+            std::cout << (fixed ? ", fixed " : " run time ")
+                      << n / std::chrono::duration<double>(t1 - t0).count()
+                      << "/"
+                      << n / std::chrono::duration<double>(t2 - t1).count();
+        }
+        std::cout << (guards ? "" : ";");
+    }
+    std::cout << " Mpart/s deposit/gather+push" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    test_passed &= check_dims();
+
+    for (int order = 0; order <= Shape::max_order; ++order)
+    {
+        for (int layout = 0; layout <= 2; ++layout)
+        {
+            test_passed &= check_order(order, layout);
+        }
+    }
+
+    time_order(1);
+    time_order(3);
+
+    if (test_passed)
+    {
+        std::cout << "fixed_grids is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "fixed_grids failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,80 @@
+#include "species_helpers.h"
+
+// testing the fused gather/push against mapping the fields to the particles
+// and pushing them in two passes
+
+const unsigned SEED = 1357;  // of the particles
+
+const double TOL = PIC_SINGLE_PRECISION ? 1e-4 : 1e-12;
+
+int main(int argc, char **argv)
+{
+    std::size_t Nx = 32, Ny = 24;
+    double L_x = 4.0, L_y = 2.0;
+    double dx = L_x / Nx, dy = L_y / Ny;
+    std::size_t Npar = 20000;
+    double dt = 0.1;
+
+    bool test_passed = true;
+
+    Field e_field(Nx, Ny, dx, dy);
+    Field b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny, 0.0);
+    fill_field(b_field, Nx, Ny, 1.0);
+
+    for (int use_b = 0; use_b <= 1; ++use_b)
+    {
+        // Without guard cells first, then reading through them
+        for (int guards = 0; guards <= 1; ++guards)
+        {
+            if (guards)
+            {
+                e_field.exchange_guards();
+                b_field.exchange_guards();
+            }
+
+            Species two_pass(Npar, Nx, Ny, -1.0);
+            fill_species(two_pass, Npar, L_x, L_y, SEED, 2.0, 1);
+
+            Species fused(Npar, Nx, Ny, -1.0);
+            fill_species(fused, Npar, L_x, L_y, SEED, 2.0, 1);
+
+            for (int step = 0; step < 5; ++step)
+            {
+                two_pass.map_field_to_part(e_field, Field_T::Electric,
+                                           dx, dy, L_x, L_y, Nx, Ny);
+                if (use_b)
+                {
+                    two_pass.map_field_to_part(b_field, Field_T::Magnetic,
+                                               dx, dy, L_x, L_y, Nx, Ny);
+                }
+                two_pass.push_particles(L_x, L_y, dt, dx, dy);
+
+                fused.gather_push_particles(e_field, b_field, use_b,
+                                            L_x, L_y, dt, dx, dy);
+
+                if (!same_particles(two_pass, fused, TOL))
+                {
+                    std::cout << "fused gather/push differs from map + push"
+                              << (use_b ? " with" : " without")
+                              << " a magnetic field"
+                              << (guards ? " and guard cells" : "")
+                              << " at step " << step << std::endl;
+                    test_passed = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (test_passed)
+    {
+        std::cout << "gather_push is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "gather_push failed its test!\n";
+    }
+
+    return !test_passed;
+}
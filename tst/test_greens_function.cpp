@@ -0,0 +1,82 @@
+#include "../src/Field.h"
+#include <math.h>    // for fabs
+
+// testing that the Green's function tables are shared by every user of the
+// same grid geometry and only by them, and that fields of different
+// geometries solved one after the other each use their own
+
+GridObject mode_density(const std::size_t Nx, const std::size_t Ny)
+{
+    GridObject dens(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            dens.set_comp(i, j, cos(2.0 * M_PI * (double(i) / Nx +
+                                                  2.0 * j / Ny)));
+        }
+    }
+
+    return dens;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    std::shared_ptr<const GreensFunction_2D> a =
+        GreensFunction_2D::get(32, 16, 0.1, 0.2);
+    std::shared_ptr<const GreensFunction_2D> b =
+        GreensFunction_2D::get(32, 16, 0.1, 0.2);
+    std::shared_ptr<const GreensFunction_2D> c =
+        GreensFunction_2D::get(32, 16, 0.1, 0.3);
+
+    if (a != b || a == c || !c->matches(32, 16, 0.1, 0.3))
+    {
+        std::cout << "tables are not shared by geometry" << std::endl;
+        test_passed = false;
+    }
+
+    // The k = 0 mode has no potential
+    if (a->green_row(0)[0] != 0.0 || a->green_row(0)[1] <= 0.0)
+    {
+        std::cout << "Green's function is wrong at k = 0" << std::endl;
+        test_passed = false;
+    }
+
+    // Fields of two geometries, each solved twice in turn, give the same
+    // result every time, bit for bit
+    const GridObject dens_1 = mode_density(32, 16);
+    const GridObject dens_2 = mode_density(16, 32);
+    Field field_1(32, 16, 0.1, 0.2), field_2(16, 32, 0.1, 0.2);
+    Field copy_1(field_1);
+
+    field_1.solve_field(dens_1, 0.1, 0.2);
+    field_2.solve_field(dens_2, 0.1, 0.2);
+    const GridObject ex_1 = field_1.f1, ex_2 = field_2.f1;
+    const double U_1 = field_1.total_U;
+
+    copy_1.solve_field(dens_1, 0.1, 0.2);
+    field_2.total_U = 0.0;
+    field_2.solve_field(dens_2, 0.1, 0.2);
+    // equals needs differences below its tolerance, so one far below any
+    // round-off
+    const double exact = 1e-300;
+    if (!copy_1.f1.equals(ex_1, exact) || !field_2.f1.equals(ex_2, exact) ||
+        copy_1.total_U != U_1)
+    {
+        std::cout << "fields sharing tables do not agree" << std::endl;
+        test_passed = false;
+    }
+
+    if (test_passed)
+    {
+        std::cout << "greens_function is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "greens_function failed its test!\n";
+    }
+
+    return !test_passed;
+}
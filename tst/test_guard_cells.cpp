@@ -0,0 +1,190 @@
+#include "species_helpers.h"
+#include <chrono>
+
+// testing the guard cells of the grid, and the deposit and gather through
+// them against wrapping every index, for every shape order, and timing the
+// deposit and gather both ways
+
+const unsigned SEED = 1618;  // of the particles
+
+// The densities are of order 1e4, so single precision sums only agree to a
+// few digits after the decimal point
+const double TOL = PIC_SINGLE_PRECISION ? 1e-1 : 1e-10;
+
+// Exchanging fills every guard cell with its periodic image, and folding
+// adds every cell back onto its image, also on grids narrower than the guard
+bool check_grid(const std::size_t Nx, const std::size_t Ny)
+{
+    const long g = Shape::guard_cells;
+    bool passed = true;
+
+    GridObject grid(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            grid.set_comp(i, j, 10.0 * i + j);
+        }
+    }
+
+    grid.exchange_guards(g);
+    for (long i = -g; i < long(Nx) + g; ++i)
+    {
+        for (long j = -g; j < long(Ny) + g; ++j)
+        {
+            passed &= grid.guarded(i, j) ==
+                      grid.get_comp(wrap_index(i, Nx), wrap_index(j, Ny));
+        }
+    }
+
+    // Every cell of the guarded grid holds 1, so each grid point gains the
+    // number of its images
+    GridObject folded(Nx, Ny), images(Nx, Ny);
+    folded.zero_guards(g);
+    for (long i = -g; i < long(Nx) + g; ++i)
+    {
+        for (long j = -g; j < long(Ny) + g; ++j)
+        {
+            folded.guarded(i, j) = 1.0;
+            images.comp_add_to(wrap_index(i, Nx), wrap_index(j, Ny), 1.0);
+        }
+    }
+    folded.fold_guards();
+    passed &= folded.equals(images, 1e-12);
+
+    if (!passed)
+    {
+        std::cout << "guard cells of a " << Nx << "x" << Ny
+                  << " grid are wrong" << std::endl;
+    }
+
+    return passed;
+}
+
+// Deposit and gather/push with and without guard cells over a few steps
+bool check_order(const int order, const std::size_t nt)
+{
+    const std::size_t Nx = 40, Ny = 28;
+    const double L_x = 4.0, L_y = 2.0;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 20000;
+    const double dt = 0.2;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    fill_field(b_field, Nx, Ny);
+    Field e_guarded(e_field), b_guarded(b_field);
+    e_guarded.exchange_guards();
+    b_guarded.exchange_guards();
+
+    Species wrapped(Npar, Nx, Ny, 1.0), guarded(Npar, Nx, Ny, 1.0);
+    fill_species(wrapped, Npar, L_x, L_y, SEED);
+    fill_species(guarded, Npar, L_x, L_y, SEED);
+    wrapped.shape_order = guarded.shape_order = order;
+    wrapped.n_threads = guarded.n_threads = nt;
+    wrapped.guard_cells = false;
+
+    bool passed = true;
+    for (int step = 0; step < 3; ++step)
+    {
+        wrapped.gather_push_particles(e_field, b_field, true,
+                                      L_x, L_y, dt, dx, dy);
+        guarded.gather_push_particles(e_guarded, b_guarded, true,
+                                      L_x, L_y, dt, dx, dy);
+        passed &= same_particles(wrapped, guarded);
+
+        wrapped.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+        guarded.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+        passed &= guarded.density_arr.equals(wrapped.density_arr, TOL);
+    }
+
+    if (!passed)
+    {
+        std::cout << "shape order " << order << " with " << nt
+                  << " threads differs through the guard cells" << std::endl;
+    }
+
+    return passed;
+}
+
+// Millions of particles per second deposited, and gathered and pushed, on
+// one thread
+void time_order(const int order)
+{
+    const std::size_t Nx = 128, Ny = 128;
+    const double L_x = 12.8, L_y = 12.8;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 500000;
+    const int reps = 5;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    e_field.exchange_guards();
+
+    Species spec(Npar, Nx, Ny, 1.0);
+    fill_species(spec, Npar, L_x, L_y, SEED);
+    spec.shape_order = order;
+    spec.n_threads = 1;
+
+    std::cout << "shape order " << order << ":";
+    for (int guards = 0; guards <= 1; ++guards)
+    {
+        spec.guard_cells = guards;
+
+        std::chrono::steady_clock::time_point t0 =
+            std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r)
+        {
+            spec.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+        }
+        std::chrono::steady_clock::time_point t1 =
+            std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r)
+        {
+            spec.gather_push_particles(e_field, b_field, false,
+                                       L_x, L_y, 0.0, dx, dy);
+        }
+        std::chrono::steady_clock::time_point t2 =
+            std::chrono::steady_clock::now();
+
+        const double n = double(Npar) * reps / 1e6;
+        std::cout << (guards ? " guard cells" : " wrapped") << " deposit "
+                  << n / std::chrono::duration<double>(t1 - t0).count()
+                  << ", gather/push "
+                  << n / std::chrono::duration<double>(t2 - t1).count()
+                  << " Mpart/s" << (guards ? "" : ";");
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    test_passed &= check_grid(7, 5);
+    test_passed &= check_grid(2, 1);
+
+    for (int order = 0; order <= Shape::max_order; ++order)
+    {
+        for (std::size_t nt = 1; nt <= 2; ++nt)
+        {
+            test_passed &= check_order(order, nt);
+        }
+    }
+
+    for (int order = 0; order <= Shape::max_order; ++order)
+    {
+        time_order(order);
+    }
+
+    if (test_passed)
+    {
+        std::cout << "guard_cells is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "guard_cells failed its test!\n";
+    }
+
+    return !test_passed;
+}
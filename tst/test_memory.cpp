@@ -0,0 +1,193 @@
+#include "species_helpers.h"
+#include <chrono>
+#include <stdint.h>  // for uintptr_t
+
+// testing the memory layout: that the grids and the particles start on a
+// cache line, that the rows of the guard cell and interleaved copies are
+// padded to an odd number of cache lines, that placing the particles on their
+// threads keeps them, and that the threaded gather/push matches one thread.
+// Also times the gather/push with the particles placed and not.
+
+const unsigned SEED = 4669;  // of the particles
+
+bool aligned(const void* p, const std::size_t alignment)
+{
+    return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+// Rows start on a cache line and are an odd number of cache lines apart
+bool padded_rows(const real_t* row, const real_t* next_row)
+{
+    const std::size_t bytes = (next_row - row) * sizeof(real_t);
+    return aligned(row, cache_line) && bytes % cache_line == 0 &&
+           (bytes / cache_line) % 2 == 1;
+}
+
+bool check_layout()
+{
+    bool passed = true;
+
+    for (std::size_t n = 1; n <= 1100; ++n)
+    {
+        const std::size_t row = padded_row(n, sizeof(real_t));
+        passed &= (row >= n && (row * sizeof(real_t)) % cache_line == 0 &&
+                   (row * sizeof(real_t) / cache_line) % 2 == 1);
+    }
+
+    // A power of 2 grid, and one whose rows with guard cells are a power of 2
+    const long g = Shape::guard_cells;
+    const std::size_t sizes[2] = {512, 512 - 2 * g};
+    for (std::size_t k = 0; k < 2; ++k)
+    {
+        const std::size_t N = sizes[k];
+        Field f(16, N, 0.1, 0.1);
+        fill_field(f, 16, N);
+        f.exchange_guards();
+        passed &= aligned(f.f1.gridded_data.get_data(), cache_line);
+        passed &= padded_rows(&f.f1.guarded(0, -g), &f.f1.guarded(1, -g));
+
+        f.set_interleaved(true);
+        passed &= padded_rows(f.node(0, -g), f.node(1, -g));
+    }
+
+    ParticleArray parts(1000);
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        parts.push_back(0.001 * i, 0.5, 0, 1.0, 0, 0, 1.0);
+    }
+    parts.place(64, 2);
+    passed &= aligned(parts.x.data(), cache_line) &&
+              aligned(parts.px.data(), cache_line) &&
+              aligned(parts.w.data(), cache_line) &&
+              parts.x[999] == real_t(0.999) && parts.px[500] == 1.0;
+
+#if PIC_HUGE_PAGES
+    cache_aligned_vector<real_t> big(huge_page);
+    passed &= aligned(big.data(), huge_page);
+#endif
+
+    if (!passed)
+    {
+        std::cout << "grids or particles are not laid out on cache lines"
+                  << std::endl;
+    }
+
+    return passed;
+}
+
+// Placing keeps the particles, and the gather/push on nt threads, of placed
+// particles and after a sort, matches one thread
+bool check_threads(const std::size_t nt)
+{
+    const std::size_t Nx = 40, Ny = 28;
+    const double L_x = 4.0, L_y = 2.0;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 20000;
+    const double dt = 0.2;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    fill_field(b_field, Nx, Ny);
+    e_field.exchange_guards();
+    b_field.exchange_guards();
+
+    Species serial(Npar, Nx, Ny, 1.0), threaded(Npar, Nx, Ny, 1.0);
+    fill_species(serial, Npar, L_x, L_y, SEED);
+    fill_species(threaded, Npar, L_x, L_y, SEED);
+    serial.n_threads = 1;
+    threaded.n_threads = nt;
+
+    threaded.place_particles();
+    bool passed = same_particles(serial, threaded);
+
+    for (int step = 0; step < 4; ++step)
+    {
+        if (step == 2)
+        {
+            serial.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+            threaded.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+        }
+        serial.gather_push_particles(e_field, b_field, true,
+                                     L_x, L_y, dt, dx, dy);
+        threaded.gather_push_particles(e_field, b_field, true,
+                                       L_x, L_y, dt, dx, dy);
+        passed &= same_particles(serial, threaded);
+    }
+
+    if (!passed)
+    {
+        std::cout << "gather/push on " << nt << " threads differs from one "
+                  << "thread" << std::endl;
+    }
+
+    return passed;
+}
+
+// Millions of particles per second gathered and pushed on all threads, with
+// the particles written by one thread and placed on their threads
+void time_placement()
+{
+    const std::size_t Nx = 512, Ny = 512;
+    const double L_x = 51.2, L_y = 51.2;
+    const double dx = L_x / Nx, dy = L_y / Ny;
+    const std::size_t Npar = 2000000;
+    const int reps = 5;
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    fill_field(b_field, Nx, Ny);
+    e_field.exchange_guards();
+    b_field.exchange_guards();
+
+    Species spec(Npar, Nx, Ny, 1.0);
+    fill_species(spec, Npar, L_x, L_y, SEED);
+    spec.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+
+    std::cout << Threads::resolve(spec.n_threads) << " threads:";
+    for (int placed = 0; placed <= 1; ++placed)
+    {
+        if (placed)
+        {
+            spec.place_particles();
+        }
+
+        std::chrono::steady_clock::time_point t0 =
+            std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r)
+        {
+            spec.gather_push_particles(e_field, b_field, true,
+                                       L_x, L_y, 0.0, dx, dy);
+        }
+        std::chrono::steady_clock::time_point t1 =
+            std::chrono::steady_clock::now();
+
+        std::cout << (placed ? " placed " : " unplaced ")
+                  << double(Npar) * reps / 1e6 /
+                     std::chrono::duration<double>(t1 - t0).count();
+    }
+    std::cout << " Mpart/s" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    test_passed &= check_layout();
+    for (std::size_t nt = 2; nt <= 3; ++nt)
+    {
+        test_passed &= check_threads(nt);
+    }
+
+    time_placement();
+
+    if (test_passed)
+    {
+        std::cout << "memory is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "memory failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,187 @@
+#include "../src/Simulation.h"
+#include "alloc_counter.h"
+#include <stdlib.h>  // for rand, srand
+#include <type_traits>
+
+// testing that the grid, field and species classes are moved rather than
+// copied: moving them allocates nothing, setting up a simulation never holds
+// a second copy of the particles, and a step does not copy a particle array
+
+const std::size_t Nx = 64, Ny = 32;
+const double L_x = 2.0, L_y = 1.0;
+const std::size_t Npar = 200000;
+
+static_assert(std::is_nothrow_move_constructible<DataStorage_1D>::value &&
+              std::is_nothrow_move_constructible<DataStorage_2D>::value &&
+              std::is_nothrow_move_constructible<GridObject>::value &&
+              std::is_nothrow_move_constructible<ParticleArray>::value &&
+              std::is_nothrow_move_constructible<Field>::value &&
+              std::is_nothrow_move_constructible<Species>::value,
+              "std::vector only moves its elements if they cannot throw");
+
+void fill_species(Species& spec, std::size_t npar)
+{
+    srand(24680);
+    for (std::size_t i = 0; i < npar; ++i)
+    {
+        double x_pos = L_x * rand() / double(RAND_MAX) * 0.999;
+        double y_pos = L_y * rand() / double(RAND_MAX) * 0.999;
+        double x_mom = 0.1 * (rand() / double(RAND_MAX) - 0.5);
+        double y_mom = 0.1 * (rand() / double(RAND_MAX) - 0.5);
+        spec.add_particle(x_pos, y_pos, 0, x_mom, y_mom, 0,
+                          L_x * L_y / npar);
+    }
+}
+
+void zero_field(Field& f, std::size_t N_x, std::size_t N_y)
+{
+    f.f1 = GridObject(N_x, N_y);
+    f.f2 = GridObject(N_x, N_y);
+    f.f3 = GridObject(N_x, N_y);
+}
+
+void Simulation::init_simulation()
+{
+    this->add_species(Npar, -1.0, fill_species);
+    this->add_species(Npar, -1.0, fill_species);
+
+    this->add_e_field(zero_field);
+    this->add_b_field(zero_field);
+}
+
+bool check_no_allocs(const char* what)
+{
+    if (AllocCounter::n_allocs() != 0)
+    {
+        std::cout << what << " made " << AllocCounter::n_allocs()
+                  << " allocations" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    // Moving the storage classes hands over the buffers
+    {
+        DataStorage_1D a(1000);
+        DataStorage_2D b(100, 100);
+        AllocCounter::reset();
+        DataStorage_1D a2(std::move(a));
+        DataStorage_2D b2(std::move(b));
+        a = std::move(a2);
+        b = std::move(b2);
+        test_passed &= check_no_allocs("moving DataStorage");
+        if (a.get_size() != 1000 || a2.get_size() != 0)
+        {
+            std::cout << "moved DataStorage has the wrong size" << std::endl;
+            test_passed = false;
+        }
+    }
+
+    // Default constructed storage is empty, and so are its copies
+    {
+        DataStorage_1D a;
+        DataStorage_2D b;
+        DataStorage_1D a2(a);
+        DataStorage_2D b2(b);
+        if (a.get_size() != 0 || b.get_size() != 0 ||
+            a2.get_size() != 0 || b2.get_size() != 0)
+        {
+            std::cout << "default DataStorage is not empty" << std::endl;
+            test_passed = false;
+        }
+    }
+
+    // A default constructed species has the settings of the others
+    {
+        Species empty, s(Npar, Nx, Ny, 1.0);
+        if (empty.n_threads != s.n_threads ||
+            empty.reproducible_deposit != s.reproducible_deposit ||
+            empty.n_deposit_blocks != s.n_deposit_blocks ||
+            empty.shape_order != s.shape_order || empty.tiled != s.tiled ||
+            empty.tile_nx != s.tile_nx || empty.tile_ny != s.tile_ny ||
+            empty.guard_cells != s.guard_cells ||
+            empty.fixed_grids != s.fixed_grids)
+        {
+            std::cout << "default Species has different settings" << std::endl;
+            test_passed = false;
+        }
+    }
+
+    {
+        GridObject g(Nx, Ny);
+        Field f(Nx, Ny, L_x / Nx, L_y / Ny);
+        AllocCounter::reset();
+        GridObject g2(std::move(g));
+        g = std::move(g2);
+        Field f2(std::move(f));
+        f = std::move(f2);
+        g += f.f1;
+        g -= f.f2;
+        test_passed &= check_no_allocs("moving GridObject and Field");
+    }
+
+    {
+        Species s(Npar, Nx, Ny, 1.0);
+        fill_species(s, Npar);
+        AllocCounter::reset();
+        Species s2(std::move(s));
+        s = std::move(s2);
+        test_passed &= check_no_allocs("moving Species");
+
+        // Asking for a phase space copies one attribute, once
+        AllocCounter::reset();
+        DataStorage_1D x = s.get_x_phasespace();
+        if (AllocCounter::n_allocs() != 1)
+        {
+            std::cout << "get_x_phasespace made " << AllocCounter::n_allocs()
+                      << " allocations" << std::endl;
+            test_passed = false;
+        }
+    }
+
+    // Setting up keeps one copy of the particles. The peak allows for the
+    // field solve, which works on a few temporary grids.
+    AllocCounter::reset();
+    std::size_t start_bytes = AllocCounter::live_bytes();
+    Simulation sim(1, 2, Nx, Ny, L_x, L_y, 0.01, 1.0);
+    std::size_t sim_bytes = AllocCounter::live_bytes() - start_bytes;
+    std::size_t peak_bytes = AllocCounter::peak_bytes() - start_bytes;
+    std::cout << "simulation holds " << sim_bytes << " bytes, peak "
+              << peak_bytes << " while setting up" << std::endl;
+    if (peak_bytes > sim_bytes + sim_bytes / 10)
+    {
+        std::cout << "setting up held a second copy of the particles"
+                  << std::endl;
+        test_passed = false;
+    }
+
+    // A step copies no particle array
+    const std::size_t attribute_bytes = Npar * sizeof(real_t);
+    for (int step = 0; step < 3; ++step)
+    {
+        AllocCounter::reset();
+        sim.iterate();
+        if (AllocCounter::largest() >= attribute_bytes)
+        {
+            std::cout << "a step allocated " << AllocCounter::largest()
+                      << " bytes at once" << std::endl;
+            test_passed = false;
+        }
+    }
+
+    if (test_passed)
+    {
+        std::cout << "moves is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "moves failed its test!\n";
+    }
+
+    return !test_passed;
+}
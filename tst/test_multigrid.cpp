@@ -0,0 +1,369 @@
+#include "species_helpers.h"
+#include <stdexcept>
+
+// testing the multigrid solve: against the spectral solve on a periodic grid,
+// against exact discrete solutions with Dirichlet and Neumann walls and with
+// walls at different potentials, that the potential of the last solve
+// starts the next, that the guard cells past a wall hold the mirror image of
+// the field, that the tiled gather reads them like the untiled one, and that
+// periodic sides have to come in pairs
+
+const unsigned SEED = 3141;  // of the particles
+
+const double TOL = PIC_SINGLE_PRECISION ? 1e-4 : 1e-8;
+
+const Multigrid::Boundary periodic = {Multigrid::Periodic, 0.0};
+const Multigrid::Boundary grounded = {Multigrid::Dirichlet, 0.0};
+const Multigrid::Boundary insulated = {Multigrid::Neumann, 0.0};
+
+// Largest difference of two grids, relative to the largest value of the first
+double max_diff(const GridObject& a, const GridObject& b)
+{
+    double max_val = 0.0, max_err = 0.0;
+    for (int i = 0; i < a.Nx; ++i)
+    {
+        for (int j = 0; j < a.Ny; ++j)
+        {
+            max_val = std::max(max_val, fabs(a.get_comp(i, j)));
+            max_err = std::max(max_err,
+                               fabs(a.get_comp(i, j) - b.get_comp(i, j)));
+        }
+    }
+
+    return max_err / std::max(max_val, 1e-300);
+}
+
+bool check_periodic(const std::size_t Nx, const std::size_t Ny)
+{
+    const double dx = 0.1, dy = 0.13;
+
+    GridObject dens(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            dens.set_comp(i, j, rand() / double(RAND_MAX));
+        }
+    }
+
+    Field spectral(Nx, Ny, dx, dy), multigrid(Nx, Ny, dx, dy);
+    multigrid.set_solver(Field_T::Field_Solver::Multigrid, Multigrid::periodic);
+
+    spectral.solve_field(dens, dx, dy);
+    const int err = multigrid.solve_field(dens, dx, dy);
+
+    if (err || max_diff(spectral.f1, multigrid.f1) > TOL ||
+        max_diff(spectral.f2, multigrid.f2) > TOL ||
+        fabs(spectral.total_U - multigrid.total_U) > TOL * spectral.total_U)
+    {
+        std::cout << Nx << "x" << Ny << " periodic multigrid differs from "
+                  << "the spectral solve" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// A sine of m half waves between two Dirichlet walls, or a cosine of m half
+// waves between two Neumann walls, in x1, times a periodic mode n in x2. The
+// walls are half a cell out, so these are exact discrete solutions, with
+// K^2 of the 5-point Laplacian.
+bool check_walls(const std::size_t Nx, const std::size_t Ny,
+                 const Multigrid::Boundary& wall,
+                 const std::size_t m, const std::size_t n)
+{
+    const double dx = 0.05, dy = 0.08;
+    const bool sine = (wall.type == Multigrid::Dirichlet);
+
+    GridObject dens(Nx, Ny);
+    const double a = M_PI * m / Nx, c = 2.0 * M_PI * n / Ny;
+    const double K2 = (2.0 - 2.0 * cos(a)) / (dx * dx) +
+                      (2.0 - 2.0 * cos(c)) / (dy * dy);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            const double x = a * (i + 0.5);
+            dens.set_comp(i, j, (sine ? sin(x) : cos(x)) * cos(c * j));
+        }
+    }
+
+    // phi = rho / K^2, and E = -grad(phi) by the centred differences of the
+    // solver
+    GridObject ex(Nx, Ny), ey(Nx, Ny);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            const double x = a * (i + 0.5);
+            const double dx_mode = (sine ? cos(x) : -sin(x)) * sin(a) / dx;
+            ex.set_comp(i, j, -dx_mode * cos(c * j) / K2);
+            ey.set_comp(i, j, (sine ? sin(x) : cos(x)) * sin(c * j) *
+                              sin(c) / dy / K2);
+        }
+    }
+
+    const Multigrid::Boundaries walls = {wall, wall, periodic, periodic};
+    Field field(Nx, Ny, dx, dy);
+    field.set_solver(Field_T::Field_Solver::Multigrid, walls);
+    const int err = field.solve_field(dens, dx, dy);
+
+    if (err || max_diff(ex, field.f1) > TOL || max_diff(ey, field.f2) > TOL)
+    {
+        std::cout << Nx << "x" << Ny << (sine ? " Dirichlet" : " Neumann")
+                  << " mode (" << m << ", " << n << ") is off by "
+                  << max_diff(ex, field.f1) << ", " << max_diff(ey, field.f2)
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Without charge, walls at 0 and V with insulating sides give a uniform field
+bool check_capacitor()
+{
+    const std::size_t Nx = 32, Ny = 16;
+    const double dx = 0.1, dy = 0.1, V = 3.0;
+    const Multigrid::Boundaries walls = {grounded, {Multigrid::Dirichlet, V},
+                                         insulated, insulated};
+
+    Field field(Nx, Ny, dx, dy);
+    field.set_solver(Field_T::Field_Solver::Multigrid, walls);
+    const int err = field.solve_field(GridObject(Nx, Ny), dx, dy);
+
+    // Ey is 0, so its error is measured against Ex
+    const GridObject ex(Nx, Ny, -V / (Nx * dx));
+    GridObject ex_plus_ey(ex);
+    ex_plus_ey += field.f2;
+    if (err || max_diff(ex, field.f1) > TOL || max_diff(ex, ex_plus_ey) > TOL)
+    {
+        std::cout << "field between two walls is not uniform, off by "
+                  << max_diff(ex, field.f1) << ", "
+                  << max_diff(ex, ex_plus_ey) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Solving the same density again starts from its own solution
+bool check_warm_start()
+{
+    const std::size_t Nx = 64, Ny = 64;
+    const double dx = 0.1, dy = 0.1;
+    const Multigrid::Boundaries box = {grounded, grounded, grounded, grounded};
+
+    GridObject dens(Nx, Ny), E_x1, E_x2;
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            dens.set_comp(i, j, rand() / double(RAND_MAX));
+        }
+    }
+
+    Multigrid::Poisson_2D poisson(Nx, Ny, dx, dy, box);
+    double U = 0.0;
+    poisson.solve(dens, E_x1, E_x2, U);
+    const std::size_t cold = poisson.get_n_cycles();
+    poisson.solve(dens, E_x1, E_x2, U);
+    const std::size_t warm = poisson.get_n_cycles();
+
+    if (poisson.get_n_levels() != 6 || cold == 0 || cold > 20 || warm != 0)
+    {
+        std::cout << "multigrid took " << cold << " cycles from zero and "
+                  << warm << " from the last solve" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// A field component past the walls of check_wall_guards, from the grid: odd
+// or even about the Dirichlet x1 walls, and about the Neumann x2 walls, whose
+// normal component is 0.5 on the low wall and 0 on the high one. Guard rows
+// are mirrored about the x2 walls after the x1 walls, corners included.
+double wall_value(const Field& f, const int k, const long a, const long c)
+{
+    const GridObject* comps[3] = {&f.f1, &f.f2, &f.f3};
+    const long Nx = f.f1.Nx, Ny = f.f1.Ny;
+
+    if (c < 0 || c >= Ny)
+    {
+        const double inside = wall_value(f, k, a, c < 0 ? -c - 1 : 2 * Ny - 1 - c);
+        const double E_wall = (c < 0) ? 0.5 : 0.0;
+        return (k == 1) ? 2.0 * E_wall - inside : inside;
+    }
+    if (a < 0 || a >= Nx)
+    {
+        const double inside = wall_value(f, k, a < 0 ? -a - 1 : 2 * Nx - 1 - a, c);
+        return (k == 0) ? inside : -inside;
+    }
+
+    return comps[k]->get_comp(a, c);
+}
+
+bool check_wall_guards()
+{
+    const std::size_t Nx = 12, Ny = 10;
+    const long g = Shape::guard_cells;
+    const Multigrid::Boundaries walls = {grounded, {Multigrid::Dirichlet, 2.0},
+                                         {Multigrid::Neumann, 0.5}, insulated};
+
+    Field planar(Nx, Ny, 0.1, 0.1);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            planar.f1.set_comp(i, j, rand() / double(RAND_MAX));
+            planar.f2.set_comp(i, j, rand() / double(RAND_MAX));
+            planar.f3.set_comp(i, j, rand() / double(RAND_MAX));
+        }
+    }
+    planar.exchange_guards();
+
+    // Changing the sides exchanges the guard cells again
+    planar.set_solver(Field_T::Field_Solver::Multigrid, walls);
+    Field nodes(planar);
+    nodes.set_interleaved(true);
+
+    const GridObject* comps[3] = {&planar.f1, &planar.f2, &planar.f3};
+    bool passed = true;
+    for (int k = 0; k < 3; ++k)
+    {
+        for (long a = -g; a < long(Nx) + g; ++a)
+        {
+            for (long c = -g; c < long(Ny) + g; ++c)
+            {
+                const double expected = wall_value(planar, k, a, c);
+                passed &= (fabs(comps[k]->guarded(a, c) - expected) < TOL);
+                passed &= (fabs(nodes.node(a, c)[k] - expected) < TOL);
+            }
+        }
+    }
+
+    if (!passed)
+    {
+        std::cout << "guard cells past the walls are not the mirror image "
+                  << "of the field" << std::endl;
+    }
+
+    return passed;
+}
+
+// The tile windows next to a wall hold its mirror image, as the guard cells
+// do, and not the field at the opposite wall
+bool check_tiled_walls(const bool interleaved, const int order)
+{
+    const std::size_t Nx = 32, Ny = 24, Npar = 5000;
+    const double L_x = 3.2, L_y = 2.4, dx = L_x / Nx, dy = L_y / Ny;
+    const double dt = 0.2;
+    const Multigrid::Boundaries walls = {grounded, {Multigrid::Dirichlet, 2.0},
+                                         {Multigrid::Neumann, 0.5}, insulated};
+
+    Field e_field(Nx, Ny, dx, dy), b_field(Nx, Ny, dx, dy);
+    fill_field(e_field, Nx, Ny);
+    fill_field(b_field, Nx, Ny, 1.0);
+    e_field.set_solver(Field_T::Field_Solver::Multigrid, walls);
+    b_field.set_solver(Field_T::Field_Solver::Multigrid, walls);
+    e_field.exchange_guards();
+    b_field.exchange_guards();
+    e_field.set_interleaved(interleaved);
+    b_field.set_interleaved(interleaved);
+
+    Species plain(Npar, Nx, Ny, 1.0), tiles(Npar, Nx, Ny, 1.0);
+    fill_species(plain, Npar, L_x, L_y, SEED);
+    fill_species(tiles, Npar, L_x, L_y, SEED);
+    plain.shape_order = tiles.shape_order = order;
+    tiles.tiled = true;
+    tiles.tile_nx = tiles.tile_ny = 8;
+
+    // Bin only once, so that later steps have particles outside of the
+    // window of their tile, which read the guard cells directly
+    tiles.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+    plain.tiled = true;
+    plain.tile_nx = plain.tile_ny = 8;
+    plain.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+    plain.tiled = false;
+
+    for (int step = 0; step < 3; ++step)
+    {
+        plain.gather_push_particles(e_field, b_field, true,
+                                    L_x, L_y, dt, dx, dy);
+        tiles.gather_push_particles(e_field, b_field, true,
+                                    L_x, L_y, dt, dx, dy);
+
+        if (!same_particles(plain, tiles))
+        {
+            std::cout << "tiled gather between walls differs from untiled "
+                      << (interleaved ? "with" : "without")
+                      << " interleaved nodes for order " << order
+                      << " at step " << step << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    srand(2718);
+
+    test_passed &= check_periodic(64, 32);
+    test_passed &= check_periodic(48, 40);
+    test_passed &= check_walls(64, 64, grounded, 3, 2);
+    test_passed &= check_walls(40, 24, grounded, 1, 5);
+    test_passed &= check_walls(64, 32, insulated, 4, 1);
+    test_passed &= check_capacitor();
+    test_passed &= check_warm_start();
+    test_passed &= check_wall_guards();
+    for (int order = 1; order <= 3; ++order)
+    {
+        test_passed &= check_tiled_walls(false, order);
+        test_passed &= check_tiled_walls(true, order);
+    }
+
+    // A periodic side needs its opposite, and the spectral solve both pairs
+    const Multigrid::Boundaries half = {periodic, grounded, periodic, periodic};
+    const Multigrid::Boundaries walls = {grounded, grounded,
+                                         periodic, periodic};
+    Field field(16, 16, 0.1, 0.1);
+    bool threw_half = false, threw_spectral = false;
+    try
+    {
+        Multigrid::Poisson_2D poisson(16, 16, 0.1, 0.1, half);
+    }
+    catch (const std::runtime_error&)
+    {
+        threw_half = true;
+    }
+    try
+    {
+        field.set_solver(Field_T::Field_Solver::Spectral, walls);
+    }
+    catch (const std::runtime_error&)
+    {
+        threw_spectral = true;
+    }
+    if (!threw_half || !threw_spectral)
+    {
+        std::cout << "boundaries the solvers cannot do were accepted"
+                  << std::endl;
+        test_passed = false;
+    }
+
+    if (test_passed)
+    {
+        std::cout << "multigrid is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "multigrid failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,121 @@
+#include "../src/Simulation.h"
+#include <fstream>
+#include <math.h>    // for fabs
+#include <vector>
+
+// Problem to run, e.g. -DPROBLEM='"../src/cold_wave.h"'
+#ifndef PROBLEM
+#define PROBLEM "../src/two_stream.h"
+#endif
+#include PROBLEM
+
+// testing a single precision build against the double precision one. The
+// precision is fixed when the objects are built, so this runs in two passes:
+//   build in double precision and run: test_precision.exe history_double.txt
+//   rebuild the objects with make SINGLE_PRECISION=1 and this test with
+//   SINGLE_PRECISION=1 ./compile_tests.sh, and run:
+//     test_precision.exe history_single.txt history_double.txt
+// Each pass writes the field energy of every step to the first file. When a
+// second file is given, the energies are compared against it. Only the first
+// steps are compared, through the linear growth and the first saturation of
+// the two stream instability, after which round-off differences grow until
+// the runs are no longer comparable step by step.
+
+const std::size_t n_compare = 200;
+const double TOL = 1e-3;
+
+double field_energy(const Simulation& sim)
+{
+    double U = 0.0;
+    for (std::size_t i = 0; i < sim.Nx; ++i)
+    {
+        for (std::size_t j = 0; j < sim.Ny; ++j)
+        {
+            double ex = sim.e_field.f1.get_comp(i, j);
+            double ey = sim.e_field.f2.get_comp(i, j);
+            U += ex * ex + ey * ey;
+        }
+    }
+
+    return 0.5 * U * sim.dx * sim.dy;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: " << argv[0]
+                  << " history_out.txt [history_reference.txt]" << std::endl;
+        return 1;
+    }
+
+    bool test_passed = true;
+
+    Simulation sim(ndump, nspec, Nx, Ny, L_x, L_y, dt, tmax);
+
+    const std::size_t n_steps = std::min(std::size_t(tmax / dt), n_compare);
+    std::vector<double> history(n_steps);
+    for (std::size_t step = 0; step < n_steps; ++step)
+    {
+        sim.iterate();
+        history[step] = field_energy(sim);
+    }
+
+    std::ofstream out(argv[1]);
+    out.precision(17);
+    for (std::size_t step = 0; step < n_steps; ++step)
+    {
+        out << history[step] << "\n";
+    }
+    out.close();
+
+    std::cout << "running in " << (PIC_SINGLE_PRECISION ? "single" : "double")
+              << " precision" << std::endl;
+
+    if (argc > 2)
+    {
+        std::ifstream in(argv[2]);
+        std::vector<double> reference;
+        double val;
+        while (in >> val)
+        {
+            reference.push_back(val);
+        }
+
+        if (reference.size() != n_steps)
+        {
+            std::cout << "reference history has " << reference.size()
+                      << " steps, expected " << n_steps << std::endl;
+            test_passed = false;
+        }
+        else
+        {
+            double max_U = 0.0, max_diff = 0.0;
+            for (std::size_t step = 0; step < n_steps; ++step)
+            {
+                max_U = std::max(max_U, reference[step]);
+                max_diff = std::max(max_diff,
+                                    fabs(history[step] - reference[step]));
+            }
+
+            std::cout << "largest field energy difference: "
+                      << max_diff / max_U << " of the peak energy"
+                      << std::endl;
+            if (max_diff > TOL * max_U)
+            {
+                test_passed = false;
+            }
+        }
+    }
+
+    if (test_passed)
+    {
+        std::cout << "precision is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "precision failed its test!\n";
+    }
+
+    return !test_passed;
+}
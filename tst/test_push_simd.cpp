@@ -0,0 +1,146 @@
+#include "../src/Push.h"
+#include "../src/ThreeVec.h"
+#include <chrono>
+#include <math.h>    // for fabs, sqrt
+#include <stdlib.h>  // for rand, srand
+#include <vector>
+
+// testing the vectorized Boris push against a scalar ThreeVec push, and
+// timing both on one core
+
+// The particle-by-particle push the vectorized kernel replaced
+void scalar_push(ThreeVec& pos, ThreeVec& mom,
+                 ThreeVec local_e, ThreeVec local_b,
+                 const double Qpar, const double dt)
+{
+    mom += local_e * (Qpar * dt * 0.5);
+
+    double mom2 = mom.square();
+    double gamma = 1. / sqrt(1. + mom2);
+
+    double b2 = local_b.square();
+
+    if (b2) // test if non-zero
+    {
+        ThreeVec t = local_b * Qpar * dt * 0.5;
+        ThreeVec s = t * (2. / (1. + t.square()));
+
+        ThreeVec vperp = mom - ((mom.element_multiply(local_b)) / sqrt(b2));
+        ThreeVec vstar = vperp + (vperp^t);
+
+        mom += vstar^s;
+    }
+
+    mom += local_e * (Qpar * dt * 0.5);
+
+    pos += mom * (dt / gamma);
+}
+
+double rand_range(double lo, double hi)
+{
+    return lo + (hi - lo) * rand() / double(RAND_MAX);
+}
+
+// The reference push is always in double precision
+const double TOL = PIC_SINGLE_PRECISION ? 1e-4 : 1e-12;
+
+bool close(double a, double b)
+{
+    return fabs(a - b) <= TOL * (1.0 + fabs(a) + fabs(b));
+}
+
+int main(int argc, char **argv)
+{
+    const std::size_t Npar = 100000;
+    const int n_steps = 20;
+    const double Qpar = -1.0, dt = 0.01;
+
+    std::vector<real_t> x(Npar), y(Npar), z(Npar);
+    std::vector<real_t> px(Npar), py(Npar), pz(Npar);
+    std::vector<real_t> ex(Npar), ey(Npar), ez(Npar);
+    std::vector<real_t> bx(Npar), by(Npar), bz(Npar);
+
+    srand(2468);
+    for (std::size_t p = 0; p < Npar; ++p)
+    {
+        x[p] = rand_range(0.0, 1.0);
+        y[p] = rand_range(0.0, 1.0);
+        z[p] = 0.0;
+        px[p] = rand_range(-2.0, 2.0);
+        py[p] = rand_range(-2.0, 2.0);
+        pz[p] = rand_range(-2.0, 2.0);
+        ex[p] = rand_range(-1.0, 1.0);
+        ey[p] = rand_range(-1.0, 1.0);
+        ez[p] = rand_range(-1.0, 1.0);
+
+        // Every other particle sees no magnetic field
+        bool has_b = p % 2;
+        bx[p] = has_b ? rand_range(-1.0, 1.0) : 0.0;
+        by[p] = has_b ? rand_range(-1.0, 1.0) : 0.0;
+        bz[p] = has_b ? rand_range(-1.0, 1.0) : 0.0;
+    }
+
+    std::vector<ThreeVec> pos(Npar), mom(Npar), e_loc(Npar), b_loc(Npar);
+    for (std::size_t p = 0; p < Npar; ++p)
+    {
+        pos[p] = ThreeVec(x[p], y[p], z[p]);
+        mom[p] = ThreeVec(px[p], py[p], pz[p]);
+        e_loc[p] = ThreeVec(ex[p], ey[p], ez[p]);
+        b_loc[p] = ThreeVec(bx[p], by[p], bz[p]);
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int step = 0; step < n_steps; ++step)
+    {
+        for (std::size_t p = 0; p < Npar; ++p)
+        {
+            scalar_push(pos[p], mom[p], e_loc[p], b_loc[p], Qpar, dt);
+        }
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (int step = 0; step < n_steps; ++step)
+    {
+        Push::boris(Npar, x.data(), y.data(), z.data(),
+                    px.data(), py.data(), pz.data(),
+                    ex.data(), ey.data(), ez.data(),
+                    bx.data(), by.data(), bz.data(),
+                    Qpar, dt);
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+    bool test_passed = true;
+
+    for (std::size_t p = 0; p < Npar; ++p)
+    {
+        if (!close(pos[p].get_x(), x[p]) || !close(pos[p].get_y(), y[p]) ||
+            !close(pos[p].get_z(), z[p]) || !close(mom[p].get_x(), px[p]) ||
+            !close(mom[p].get_y(), py[p]) || !close(mom[p].get_z(), pz[p]))
+        {
+            std::cout << "vectorized push differs from scalar push for "
+                      << "particle " << p << std::endl;
+            test_passed = false;
+            break;
+        }
+    }
+
+    const double scalar_time = std::chrono::duration<double>(t1 - t0).count();
+    const double simd_time = std::chrono::duration<double>(t2 - t1).count();
+    const double n_pushes = double(Npar) * n_steps;
+
+    std::cout << "scalar push:     " << n_pushes / scalar_time / 1e6
+              << " Mparticles/s" << std::endl;
+    std::cout << "vectorized push: " << n_pushes / simd_time / 1e6
+              << " Mparticles/s (" << Push::simd_isa() << ", "
+              << scalar_time / simd_time << "x)" << std::endl;
+
+    if (test_passed)
+    {
+        std::cout << "push_simd is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "push_simd failed its test!\n";
+    }
+
+    return !test_passed;
+}
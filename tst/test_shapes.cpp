@@ -0,0 +1,189 @@
+#include "species_helpers.h"
+#include "../src/Shape.h"
+#include <math.h>    // for fabs, sin
+
+// testing the particle shape functions of every order: the weights form a
+// partition of unity, deposition conserves charge, a uniform field is
+// gathered exactly and the tiled deposit and gather agree with the untiled
+// ones
+
+const unsigned SEED = 97531;  // of the particles
+
+// Round-off allowed in the storage precision
+const double EPS = PIC_SINGLE_PRECISION ? 1e-6 : 1e-14;
+
+template <int Order>
+bool check_weights()
+{
+    typedef Shape::BSpline<Order> S;
+
+    for (int k = 0; k < 1000; ++k)
+    {
+        real_t f = 3.0 + k / 1000.0;
+        long first;
+        real_t w[S::support];
+        S::weights(f, first, w);
+
+        double sum = 0.0, mean = 0.0;
+        for (int a = 0; a < S::support; ++a)
+        {
+            if (w[a] < 0.0)
+            {
+                return false;
+            }
+            sum += w[a];
+            mean += w[a] * (first + a);
+        }
+
+        // The shape is centred on the particle for every order but NGP
+        if (fabs(sum - 1.0) > EPS || (Order > 0 && fabs(mean - f) > 100 * EPS))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+double total_charge(Species& spec, std::size_t Nx, std::size_t Ny)
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            sum += spec.density_arr.get_comp(i, j);
+        }
+    }
+
+    return sum;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t Nx = 30, Ny = 20;
+    double L_x = 3.0, L_y = 2.0;
+    double dx = L_x / Nx, dy = L_y / Ny;
+    std::size_t Npar = 20000;
+
+    bool test_passed = true;
+
+    bool weights_ok[] = {check_weights<0>(), check_weights<1>(),
+                         check_weights<2>(), check_weights<3>(),
+                         check_weights<4>()};
+
+    Field uniform(Nx, Ny, dx, dy);
+    Field e_field(Nx, Ny, dx, dy);
+    for (std::size_t i = 0; i < Nx; ++i)
+    {
+        for (std::size_t j = 0; j < Ny; ++j)
+        {
+            uniform.f1.set_comp(i, j, 0.5);
+            uniform.f2.set_comp(i, j, -0.25);
+            uniform.f3.set_comp(i, j, 0.0);
+            e_field.f1.set_comp(i, j, sin(0.3 * i + 0.2 * j));
+            e_field.f2.set_comp(i, j, sin(0.1 * i - 0.4 * j));
+            e_field.f3.set_comp(i, j, 0.0);
+        }
+    }
+
+    for (int order = 0; order <= Shape::max_order; ++order)
+    {
+        if (!weights_ok[order])
+        {
+            std::cout << "order " << order << " weights are wrong" << std::endl;
+            test_passed = false;
+        }
+
+        Species plain(Npar, Nx, Ny, 1.0);
+        fill_species(plain, Npar, L_x, L_y, SEED, 1.0, 3);
+        plain.shape_order = order;
+
+        Species tiles(Npar, Nx, Ny, 1.0);
+        fill_species(tiles, Npar, L_x, L_y, SEED, 1.0, 3);
+        tiles.shape_order = order;
+        tiles.tiled = true;
+        tiles.tile_nx = 6;
+        tiles.tile_ny = 6;
+
+        tiles.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+        plain.tiled = true;
+        plain.tile_nx = 6;
+        plain.tile_ny = 6;
+        plain.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+        plain.tiled = false;
+
+        // Every particle carries a weight of 1, 2 or 3
+        double expected = 0.0;
+        for (std::size_t i = 0; i < Npar; ++i)
+        {
+            expected += (1.0 + (i % 3)) / dx / dy;
+        }
+
+        plain.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+        tiles.deposit_charge(dx, dy, L_x, L_y, Nx, Ny);
+
+        if (fabs(total_charge(plain, Nx, Ny) - expected) > 1e5 * EPS * expected)
+        {
+            std::cout << "order " << order << " deposit does not conserve "
+                      << "charge" << std::endl;
+            test_passed = false;
+        }
+        if (!tiles.density_arr.equals(plain.density_arr, 1e4 * EPS))
+        {
+            std::cout << "order " << order << " tiled deposit differs from "
+                      << "untiled" << std::endl;
+            test_passed = false;
+        }
+
+        // A uniform electric field kicks every particle by Qpar * E * dt
+        DataStorage_1D px_old = plain.get_px_phasespace();
+        DataStorage_1D py_old = plain.get_py_phasespace();
+        plain.gather_push_particles(uniform, uniform, false,
+                                    L_x, L_y, 0.1, dx, dy);
+        tiles.gather_push_particles(uniform, uniform, false,
+                                    L_x, L_y, 0.1, dx, dy);
+        DataStorage_1D px_new = plain.get_px_phasespace();
+        DataStorage_1D py_new = plain.get_py_phasespace();
+        for (std::size_t p = 0; p < Npar; ++p)
+        {
+            if (fabs(px_new[p] - px_old[p] - 0.05) > EPS ||
+                fabs(py_new[p] - py_old[p] + 0.025) > EPS)
+            {
+                std::cout << "order " << order << " does not gather a "
+                          << "uniform field exactly" << std::endl;
+                test_passed = false;
+                break;
+            }
+        }
+
+        plain.gather_push_particles(e_field, e_field, false,
+                                    L_x, L_y, 0.1, dx, dy);
+        tiles.gather_push_particles(e_field, e_field, false,
+                                    L_x, L_y, 0.1, dx, dy);
+
+        DataStorage_1D apx = plain.get_px_phasespace();
+        DataStorage_1D bpx = tiles.get_px_phasespace();
+        for (std::size_t p = 0; p < Npar; ++p)
+        {
+            if (apx[p] != bpx[p])
+            {
+                std::cout << "order " << order << " tiled gather differs "
+                          << "from untiled" << std::endl;
+                test_passed = false;
+                break;
+            }
+        }
+    }
+
+    if (test_passed)
+    {
+        std::cout << "shapes is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "shapes failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,125 @@
+#include "../src/Species.h"
+#include <math.h>    // for fabs, floor
+#include <stdlib.h>  // for rand, srand
+
+// testing that sorting the particles by cell orders them correctly and keeps
+// every particle, for both the full and the incremental sort, and for
+// initial positions outside of the box
+
+bool check_sorted(Species& spec, double dx, double dy, double L_x, double L_y,
+                  std::size_t Ny, double expected_px_sum)
+{
+    DataStorage_1D x = spec.get_x_phasespace();
+    DataStorage_1D y = spec.get_y_phasespace();
+    DataStorage_1D px = spec.get_px_phasespace();
+
+    std::size_t last_cell = 0;
+    double px_sum = 0.0;
+    bool sorted = true;
+
+    for (std::size_t p = 0; p < x.get_size(); ++p)
+    {
+        double x_pos = x[p] - L_x * floor(x[p] / L_x);
+        double y_pos = y[p] - L_y * floor(y[p] / L_y);
+        std::size_t cell = std::size_t(x_pos / dx) * Ny +
+                           std::size_t(y_pos / dy);
+        if (cell < last_cell)
+        {
+            sorted = false;
+        }
+        last_cell = cell;
+        px_sum += px[p];
+    }
+
+    if (!sorted)
+    {
+        std::cout << "particles are not in cell order" << std::endl;
+    }
+    // The momenta tag the particles, so a lost or duplicated one shows up
+    if (fabs(px_sum - expected_px_sum) > 1e-6)
+    {
+        std::cout << "particles were lost or duplicated while sorting"
+                  << std::endl;
+        sorted = false;
+    }
+
+    return sorted;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t Nx = 16, Ny = 8;
+    double L_x = 2.0, L_y = 1.0;
+    double dx = L_x / Nx, dy = L_y / Ny;
+    std::size_t Npar = 5000;
+
+    bool test_passed = true;
+
+    Species spec(Npar, Nx, Ny, 1.0);
+    srand(1234);
+    for (std::size_t i = 0; i < Npar; ++i)
+    {
+        double x_pos = L_x * rand() / double(RAND_MAX) * 0.999;
+        double y_pos = L_y * rand() / double(RAND_MAX) * 0.999;
+        spec.add_particle(x_pos, y_pos, 0, 0.001 * i, 0, 0, 1.0);
+    }
+    double expected_px_sum = 0.001 * double(Npar) * (Npar - 1) / 2.0;
+
+    // The first sort has no previous cell boundaries to work from
+    if (spec.sort_particles(dx, dy, L_x, L_y, Nx, Ny))
+    {
+        std::cout << "first sort should not be incremental" << std::endl;
+        test_passed = false;
+    }
+    test_passed &= check_sorted(spec, dx, dy, L_x, L_y, Ny, expected_px_sum);
+
+    // Small steps only move a few particles across cells
+    Field e_field(Nx, Ny, dx, dy);
+    for (int step = 0; step < 5; ++step)
+    {
+        spec.gather_push_particles(e_field, e_field, false,
+                                   L_x, L_y, 0.002, dx, dy);
+        if (!spec.sort_particles(dx, dy, L_x, L_y, Nx, Ny))
+        {
+            std::cout << "sort after a small step should be incremental"
+                      << std::endl;
+            test_passed = false;
+        }
+        test_passed &= check_sorted(spec, dx, dy, L_x, L_y, Ny,
+                                    expected_px_sum);
+    }
+
+    // Large steps scramble the particles and force a full sort
+    spec.gather_push_particles(e_field, e_field, false,
+                               L_x, L_y, 0.5, dx, dy);
+    if (spec.sort_particles(dx, dy, L_x, L_y, Nx, Ny))
+    {
+        std::cout << "sort after a large step should not be incremental"
+                  << std::endl;
+        test_passed = false;
+    }
+    test_passed &= check_sorted(spec, dx, dy, L_x, L_y, Ny, expected_px_sum);
+
+    // Initial conditions can put particles several boxes away on either side
+    Species outside(Npar, Nx, Ny, 1.0);
+    for (std::size_t i = 0; i < Npar; ++i)
+    {
+        double x_pos = L_x * (6.0 * rand() / double(RAND_MAX) - 3.0);
+        double y_pos = L_y * (6.0 * rand() / double(RAND_MAX) - 3.0);
+        outside.add_particle(x_pos, y_pos, 0, 0.001 * i, 0, 0, 1.0);
+    }
+    outside.sort_particles(dx, dy, L_x, L_y, Nx, Ny);
+    test_passed &= check_sorted(outside, dx, dy, L_x, L_y, Ny,
+                                expected_px_sum);
+
+    if (test_passed)
+    {
+        std::cout << "sort is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "sort failed its test!\n";
+    }
+
+    return !test_passed;
+}
@@ -0,0 +1,84 @@
+#include "../src/Simulation.h"
+#include "species_helpers.h"
+
+// testing a simulation between walls: setting the field solver solves the
+// field again with it, so that the first step already pushes the particles
+// with the field of the walls, as a species pushed by hand with a field
+// solved between the same walls
+
+const unsigned SEED = 8642;  // of the particles
+
+const std::size_t Nx = 32, Ny = 24, Npar = 20000;
+const double L_x = 3.2, L_y = 2.4, dt = 0.1;
+
+const Multigrid::Boundaries walls = {{Multigrid::Dirichlet, 0.0},
+                                     {Multigrid::Dirichlet, 1.0},
+                                     {Multigrid::Neumann, 0.0},
+                                     {Multigrid::Neumann, 0.0}};
+
+const double TOL = PIC_SINGLE_PRECISION ? 1e-4 : 1e-10;
+
+void init_species(Species& spec, std::size_t npar)
+{
+    fill_species(spec, npar, L_x, L_y, SEED, 0.5);
+}
+
+void zero_field(Field& f, std::size_t N_x, std::size_t N_y)
+{
+    f.f1 = GridObject(N_x, N_y);
+    f.f2 = GridObject(N_x, N_y);
+    f.f3 = GridObject(N_x, N_y);
+}
+
+void Simulation::init_simulation()
+{
+    this->add_species(Npar, -1.0, init_species);
+
+    this->add_e_field(zero_field);
+    this->add_b_field(zero_field);
+}
+
+int main(int argc, char **argv)
+{
+    bool test_passed = true;
+
+    Simulation sim(1, 1, Nx, Ny, L_x, L_y, dt, 1.0);
+    sim.set_field_solver(Field_T::Field_Solver::Multigrid, walls);
+
+    // The field of the same charge, solved between the walls from the start
+    Field e_field(Nx, Ny, sim.dx, sim.dy), b_field(Nx, Ny, sim.dx, sim.dy);
+    e_field.set_solver(Field_T::Field_Solver::Multigrid, walls);
+    e_field.solve_field(sim.get_total_density(), sim.dx, sim.dy);
+    e_field.exchange_guards();
+
+    if (!sim.e_field.f1.equals(e_field.f1, TOL) ||
+        !sim.e_field.f2.equals(e_field.f2, TOL))
+    {
+        std::cout << "setting the field solver did not solve the field "
+                  << "between the walls" << std::endl;
+        test_passed = false;
+    }
+
+    Species spec(sim.spec[0]);
+    spec.gather_push_particles(e_field, b_field, false,
+                               L_x, L_y, dt, sim.dx, sim.dy);
+    sim.iterate();
+
+    if (!same_particles(sim.spec[0], spec, TOL))
+    {
+        std::cout << "the first step between walls did not push with their "
+                  << "field" << std::endl;
+        test_passed = false;
+    }
+
+    if (test_passed)
+    {
+        std::cout << "walls is passing its test!\n";
+    }
+    else
+    {
+        std::cout << "walls failed its test!\n";
+    }
+
+    return !test_passed;
+}